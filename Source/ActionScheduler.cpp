@@ -0,0 +1,169 @@
+/*
+  ==============================================================================
+
+    ActionScheduler.cpp
+    Created: 20 Oct 2026 7:04:33pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "ActionScheduler.h"
+
+bool ActionScheduler::scheduleSequence(const std::vector<Step>& steps, Category category)
+{
+    const juce::SpinLock::ScopedLockType lock(inboxLock);
+
+    if (steps.empty() || inboxSize + (int)steps.size() > maxPending)
+        return false;
+
+    const int start = inboxSize;
+    for (const auto& step : steps)
+    {
+        inbox[(size_t)inboxSize] = step;
+        inboxSequenceStart[(size_t)inboxSize] = start;
+        inboxCategory[(size_t)inboxSize] = category;
+        ++inboxSize;
+    }
+
+    inboxChanged.store(true);
+    return true;
+}
+
+void ActionScheduler::cancelAll()
+{
+    {
+        const juce::SpinLock::ScopedLockType lock(inboxLock);
+        inboxSize = 0;
+    }
+
+    cancelRequested.store(true);
+}
+
+//==============================================================================
+void ActionScheduler::prepare() noexcept
+{
+    numPending = 0;
+    transport = {};
+    previousEndPpq = 0.0;
+}
+
+void ActionScheduler::beginBlock(const TransportInfo& newTransport) noexcept
+{
+    if (cancelRequested.exchange(false))
+        numPending = 0;
+
+    // After a loop or locate, pending actions keep the distance they had left
+    if (newTransport.jumped)
+    {
+        for (int i = 0; i < numPending; ++i)
+        {
+            auto& entry = pending[(size_t)i];
+            entry.ppq = newTransport.ppq + juce::jmax(0.0, entry.ppq - previousEndPpq);
+        }
+    }
+
+    transport = newTransport;
+    previousEndPpq = transport.getEndPpq();
+
+    for (int i = 0; i < numPending; ++i)
+    {
+        auto& entry = pending[(size_t)i];
+        entry.sample = entry.ppq <= transport.ppq ? 0 : transport.getSampleForPpq(entry.ppq);
+    }
+
+    if (inboxChanged.load())
+    {
+        const juce::SpinLock::ScopedTryLockType lock(inboxLock);
+        if (lock.isLocked())
+        {
+            double sequenceStart = transport.ppq;
+            const double barBeats = transport.getQuarterNotesPerBar();
+
+            for (int i = 0; i < inboxSize; ++i)
+            {
+                if (inboxSequenceStart[(size_t)i] == i)
+                    sequenceStart = getQuantisedPpq(transport.ppq, (Category)inboxCategory[(size_t)i]);
+
+                const auto& step = inbox[(size_t)i];
+                add(step.action, sequenceStart + step.offsetBars * barBeats);
+            }
+
+            inboxSize = 0;
+            inboxChanged.store(false);
+        }
+    }
+}
+
+bool ActionScheduler::schedule(const Action& action, Category category, int samplePosition) noexcept
+{
+    const double arrival = transport.getPpqAtSample(juce::jlimit(0, juce::jmax(0, transport.numSamples - 1), samplePosition));
+
+    if (getQuantise(category) == immediate || !transport.isPlaying)
+    {
+        if (numPending >= maxPending)
+            return false;
+
+        pending[(size_t)numPending++] = { action, arrival, juce::jmax(0, samplePosition) };
+        return true;
+    }
+
+    return add(action, getQuantisedPpq(arrival, category));
+}
+
+bool ActionScheduler::add(const Action& action, double ppq) noexcept
+{
+    if (numPending >= maxPending)
+        return false;
+
+    pending[(size_t)numPending++] = { action, ppq, ppq <= transport.ppq ? 0 : transport.getSampleForPpq(ppq) };
+    return true;
+}
+
+double ActionScheduler::getQuantisedPpq(double ppq, Category category) const noexcept
+{
+    if (!transport.isPlaying)
+        return ppq;
+
+    // Something arriving right on a line fires on it rather than a whole grid step later
+    constexpr double tolerance = 1.0e-6;
+    const double barBeats = transport.getQuarterNotesPerBar();
+
+    switch (getQuantise(category))
+    {
+        case beat:
+            return std::ceil(ppq - tolerance);
+
+        case bar:
+        case twoBars:
+        case fourBars:
+        {
+            const int barsPerLine = getQuantise(category) == bar ? 1 : (getQuantise(category) == twoBars ? 2 : 4);
+
+            // Bars are counted from the song start, so 2 and 4 bar lines match the arrangement's phrases
+            auto barIndex = (juce::int64)std::llround(transport.barStartPpq / barBeats);
+            barIndex += (juce::int64)std::ceil((ppq - transport.barStartPpq) / barBeats - tolerance);
+
+            const auto remainder = ((barIndex % barsPerLine) + barsPerLine) % barsPerLine;
+            if (remainder != 0)
+                barIndex += barsPerLine - remainder;
+
+            return transport.barStartPpq + (double)(barIndex - std::llround(transport.barStartPpq / barBeats)) * barBeats;
+        }
+
+        case immediate:
+        default:
+            return ppq;
+    }
+}
+
+int ActionScheduler::addFireTimes(int* splitPoints, int numSplits, int maxSplits) const noexcept
+{
+    for (int i = 0; i < numPending && numSplits < maxSplits; ++i)
+    {
+        if (pending[(size_t)i].sample >= 0)
+            splitPoints[numSplits++] = pending[(size_t)i].sample;
+    }
+
+    return numSplits;
+}
@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    ActionScheduler.h
+    Created: 20 Oct 2026 7:04:33pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TransportInfo.h"
+#include "RecallMask.h"
+
+/*
+Holds actions (preset changes, Capture and Gesture presses) back until the
+next beat, bar or phrase of the host timeline, then fires them on the exact
+sample that line falls on, even when it lands in the middle of a block.
+
+Targets are kept as PPQ positions. Each block works out which of them fall
+inside it; the processor splits the block there and calls fireDue() at the
+start of each piece. After a loop or locate, pending actions keep however far
+they still had to go. With the host stopped there is no grid, so quantised
+actions fire straight away.
+
+Timed sequences (e.g. record Capture for 2 bars, then play) are queued from
+the message thread. Their first step is quantised and the rest follow at
+fixed offsets from it.
+*/
+
+class ActionScheduler
+{
+public:
+    static constexpr int maxPending = 128;
+
+    enum Quantise
+    {
+        immediate = 0,
+        beat,
+        bar,
+        twoBars,
+        fourBars
+    };
+
+    // Which quantise setting an action follows
+    enum Category
+    {
+        presetChanges = 0,
+        deviceActions,
+        numCategories
+    };
+
+    enum ActionType
+    {
+        setSlot = 0,       // Sets a slot's raw value, target is the slot
+        loadPresetNote,    // Loads the preset mapped to a MIDI note, target is the note
+        loadPresetProgram, // Loads the preset with a program number, target is bank * 128 + program
+        loadPresetTrigger, // Channel note trigger, target is the program number, value 1 if momentary
+        returnFromTrigger, // Momentary trigger released, back to the values before it
+        setlistStep,       // Target 0 steps the active setlist by value, target 1 jumps to entry value
+        latencyTestPulse   // Sets a slot on this exact sample and notes when, for the latency measurement
+    };
+
+    struct Action
+    {
+        int type = setSlot;
+        int target = 0;
+        int value = 0;
+        bool updateParameter = false; // Also move the knob, for actions that don't come from it
+        juce::uint32 recallMask = RecallMask::everything; // Slots a preset load may change
+    };
+
+    struct Step
+    {
+        double offsetBars = 0.0; // From the quantised start of the sequence
+        Action action;
+    };
+
+    static juce::StringArray getQuantiseNames() { return juce::StringArray{ "Immediate", "Beat", "Bar", "2 Bars", "4 Bars" }; }
+
+    ActionScheduler() = default;
+
+    // Safe from any thread
+    void setQuantise(Category category, Quantise quantise) noexcept { quantiseSettings[(size_t)category].store(quantise); }
+    Quantise getQuantise(Category category) const noexcept { return (Quantise)quantiseSettings[(size_t)category].load(); }
+
+    //=========================
+    // Message thread
+    bool scheduleSequence(const std::vector<Step>& steps, Category category); // False if the queue is full
+    void cancelAll();
+
+    //=========================
+    // Audio thread
+    void prepare() noexcept;
+
+    // Places pending actions in this block and picks up queued sequences
+    void beginBlock(const TransportInfo& transport) noexcept;
+
+    // Queues an action that arrived at samplePosition in the current block. False if the queue is full
+    bool schedule(const Action& action, Category category, int samplePosition) noexcept;
+
+    // Appends the sample offset of every action due in this block, returns the new count
+    int addFireTimes(int* splitPoints, int numSplits, int maxSplits) const noexcept;
+
+    // Calls fire(action) for every action due at or before sample, in the order they were queued
+    template <typename FireFunction>
+    void fireDue(int sample, FireFunction&& fire)
+    {
+        int kept = 0;
+
+        for (int i = 0; i < numPending; ++i)
+        {
+            auto& entry = pending[(size_t)i];
+
+            if (entry.sample >= 0 && entry.sample <= sample)
+                fire(entry.action);
+            else
+                pending[(size_t)kept++] = entry;
+        }
+
+        numPending = kept;
+    }
+
+private:
+    struct Pending
+    {
+        Action action;
+        double ppq = 0.0;
+        int sample = -1; // Offset in the current block, -1 if it falls in a later one
+    };
+
+    double getQuantisedPpq(double ppq, Category category) const noexcept;
+    bool add(const Action& action, double ppq) noexcept;
+
+    std::array<std::atomic<int>, numCategories> quantiseSettings{};
+
+    // Sequences queued by the message thread, picked up under a try-lock
+    juce::SpinLock inboxLock;
+    std::array<Step, maxPending> inbox;
+    std::array<int, maxPending> inboxSequenceStart{}; // Index of the first step of each step's sequence
+    std::array<int, maxPending> inboxCategory{};
+    int inboxSize = 0;
+    std::atomic<bool> inboxChanged{ false };
+    std::atomic<bool> cancelRequested{ false };
+
+    // Audio thread
+    TransportInfo transport;
+    double previousEndPpq = 0.0;
+    std::array<Pending, maxPending> pending;
+    int numPending = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ActionScheduler)
+};
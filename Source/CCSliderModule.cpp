@@ -14,7 +14,9 @@
 
 CCSliderModule::CCSliderModule(ChromaConsoleControllerAudioProcessor& processor,
     const CCControllerConfig& config)
-    : audioProcessor(processor), parameterID(config.parameterID)
+    : audioProcessor(processor), parameterID(config.parameterID),
+    slot(ChromaConsoleControllerAudioProcessor::getSlotForParameterID(config.parameterID)),
+    stepped(config.stepped)
 {
     // Configure slider
     slider.setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
@@ -35,10 +37,14 @@ CCSliderModule::CCSliderModule(ChromaConsoleControllerAudioProcessor& processor,
         config.parameterID,
         slider
     );
+
+    // Catch right clicks on the slider as well as the label area
+    slider.addMouseListener(this, false);
 }
 
 CCSliderModule::~CCSliderModule()
 {
+    slider.removeMouseListener(this);
 }
 
 void CCSliderModule::paint(juce::Graphics& g)
@@ -60,6 +66,351 @@ void CCSliderModule::resized()
     slider.setBounds(area);
 }
 
+void CCSliderModule::mouseDown(const juce::MouseEvent& e)
+{
+    if (e.mods.isPopupMenu() && isEnabled())
+        showContextMenu();
+}
+
+void CCSliderModule::showContextMenu()
+{
+    if (slot < 0)
+        return;
+
+    auto& glideEngine = audioProcessor.getGlideEngine();
+
+    juce::PopupMenu menu;
+
+    // Module selects and switches jump between settings, gliding them makes no sense
+    menu.addItem("Glide", !stepped, glideEngine.isSlotEnabled(slot), [&glideEngine, glideSlot = slot]
+        {
+            glideEngine.setSlotEnabled(glideSlot, !glideEngine.isSlotEnabled(glideSlot));
+        });
+
+    // Macro assignments, each macro can invert and bend its response
+    auto& macroEngine = audioProcessor.getMacroEngine();
+    juce::PopupMenu macroMenu;
+
+    for (int macro = 0; macro < MacroEngine::numMacros; ++macro)
+    {
+        auto target = macroEngine.findTarget(macro, slot);
+        juce::PopupMenu targetMenu;
+
+        targetMenu.addItem("Assigned", true, target.has_value(), [&macroEngine, macro, macroSlot = slot, target]
+            {
+                if (target)
+                    macroEngine.unassign(macro, macroSlot);
+                else
+                    macroEngine.assign(macro, macroSlot);
+            });
+
+        auto curve = target ? target->curve : ResponseCurve();
+        auto setCurve = [&macroEngine, macro, macroSlot = slot, curve](auto&& change)
+            {
+                auto newCurve = curve;
+                change(newCurve);
+                macroEngine.assign(macro, macroSlot, newCurve);
+            };
+
+        targetMenu.addSeparator();
+        targetMenu.addItem("Inverted", target.has_value(), curve.inverted, [setCurve] { setCurve([](ResponseCurve& c) { c.inverted = !c.inverted; }); });
+        targetMenu.addItem("Linear", target.has_value(), curve.exponent == 1.0f, [setCurve] { setCurve([](ResponseCurve& c) { c.exponent = 1.0f; }); });
+        targetMenu.addItem("Exponential", target.has_value(), curve.exponent > 1.0f, [setCurve] { setCurve([](ResponseCurve& c) { c.exponent = 2.0f; }); });
+        targetMenu.addItem("Logarithmic", target.has_value(), curve.exponent < 1.0f, [setCurve] { setCurve([](ResponseCurve& c) { c.exponent = 0.5f; }); });
+
+        macroMenu.addSubMenu("Macro " + juce::String(macro + 1), targetMenu, true, nullptr, target.has_value());
+    }
+
+    menu.addSubMenu("Macro", macroMenu);
+
+    // Tempo synced LFO around the knob value
+    {
+        auto& lfoBank = audioProcessor.getLfoBank();
+        const int lfoIndex = lfoBank.findLfoForSlot(slot);
+        auto lfo = lfoIndex >= 0 ? lfoBank.getLfo(lfoIndex) : LfoBank::Settings();
+
+        auto setLfo = [&lfoBank, lfoSlot = slot, lfo](auto&& change)
+            {
+                auto newSettings = lfo;
+                change(newSettings);
+                lfoBank.setLfoForSlot(lfoSlot, newSettings);
+            };
+
+        juce::PopupMenu lfoMenu;
+        lfoMenu.addItem("Off", true, lfoIndex < 0, [&lfoBank, lfoSlot = slot] { lfoBank.clearSlot(lfoSlot); });
+
+        const juce::StringArray shapeNames{ "Sine", "Triangle", "Square", "Sample & Hold", "Smooth Random" };
+        for (int shape = 0; shape < shapeNames.size(); ++shape)
+            lfoMenu.addItem(shapeNames[shape], true, lfoIndex >= 0 && lfo.shape == shape, [setLfo, shape] { setLfo([shape](LfoBank::Settings& l) { l.shape = shape; }); });
+
+        juce::PopupMenu rateMenu;
+        const std::array<std::pair<const char*, float>, 7> rates{ { { "1/16", 0.25f }, { "1/8", 0.5f }, { "1/4", 1.0f }, { "1/2", 2.0f },
+                                                                     { "1 Bar", 4.0f }, { "2 Bars", 8.0f }, { "4 Bars", 16.0f } } };
+        for (auto& [rateName, beats] : rates)
+            rateMenu.addItem(rateName, lfoIndex >= 0, lfo.cycleBeats == beats, [setLfo, cycle = beats] { setLfo([cycle](LfoBank::Settings& l) { l.cycleBeats = cycle; }); });
+
+        juce::PopupMenu depthMenu;
+        for (auto depth : { 0.1f, 0.25f, 0.5f, 1.0f })
+            depthMenu.addItem(juce::String(juce::roundToInt(depth * 100.0f)) + " %", lfoIndex >= 0, lfo.depth == depth, [setLfo, depth] { setLfo([depth](LfoBank::Settings& l) { l.depth = depth; }); });
+
+        lfoMenu.addSeparator();
+        lfoMenu.addSubMenu("Rate", rateMenu, lfoIndex >= 0);
+        lfoMenu.addSubMenu("Depth", depthMenu, lfoIndex >= 0);
+
+        menu.addSubMenu("LFO", lfoMenu, true, nullptr, lfoIndex >= 0);
+    }
+
+    // Step sequencer lane. Patterns are generated from here, sized to the slot's range
+    {
+        auto& sequencer = audioProcessor.getStepSequencer();
+        const int laneIndex = sequencer.findLaneForSlot(slot);
+        auto lane = laneIndex >= 0 ? sequencer.getLane(laneIndex) : StepSequencer::Lane();
+        const int maximum = ChromaConsoleControllerAudioProcessor::getSlotMaximums()[(size_t)slot];
+        const int current = juce::roundToInt(slider.getValue());
+
+        auto setLane = [&sequencer, laneSlot = slot, lane](auto&& change)
+            {
+                auto newLane = lane;
+                change(newLane);
+                sequencer.setLaneForSlot(laneSlot, newLane);
+            };
+
+        juce::PopupMenu sequencerMenu;
+        sequencerMenu.addItem("Off", true, laneIndex < 0, [&sequencer, laneSlot = slot] { sequencer.clearSlot(laneSlot); });
+
+        for (int steps : { 4, 8, 16, 32, 64 })
+        {
+            sequencerMenu.addItem(juce::String(steps) + " Steps", true, laneIndex >= 0 && lane.numSteps == steps, [setLane, steps, laneIndex, current]
+                {
+                    setLane([=](StepSequencer::Lane& l)
+                        {
+                            // A new lane starts out holding the knob's current value
+                            if (laneIndex < 0)
+                                l.values.fill((juce::uint8)current);
+                            l.numSteps = steps;
+                        });
+                });
+        }
+
+        juce::PopupMenu stepMenu;
+        const std::array<std::pair<const char*, float>, 4> stepLengths{ { { "1/32", 0.125f }, { "1/16", 0.25f }, { "1/8", 0.5f }, { "1/4", 1.0f } } };
+        for (auto& [stepName, beats] : stepLengths)
+            stepMenu.addItem(stepName, laneIndex >= 0, lane.stepBeats == beats, [setLane, length = beats] { setLane([length](StepSequencer::Lane& l) { l.stepBeats = length; }); });
+
+        juce::PopupMenu fillMenu;
+        fillMenu.addItem("Ramp Up", laneIndex >= 0, false, [setLane, maximum] { setLane([maximum](StepSequencer::Lane& l)
+            {
+                for (int i = 0; i < l.numSteps; ++i)
+                    l.values[(size_t)i] = (juce::uint8)(l.numSteps > 1 ? i * maximum / (l.numSteps - 1) : 0);
+            }); });
+        fillMenu.addItem("Ramp Down", laneIndex >= 0, false, [setLane, maximum] { setLane([maximum](StepSequencer::Lane& l)
+            {
+                for (int i = 0; i < l.numSteps; ++i)
+                    l.values[(size_t)i] = (juce::uint8)(l.numSteps > 1 ? maximum - i * maximum / (l.numSteps - 1) : maximum);
+            }); });
+        fillMenu.addItem("Alternate", laneIndex >= 0, false, [setLane, maximum] { setLane([maximum](StepSequencer::Lane& l)
+            {
+                for (int i = 0; i < l.numSteps; ++i)
+                    l.values[(size_t)i] = (juce::uint8)(i % 2 == 0 ? maximum : 0);
+            }); });
+        fillMenu.addItem("Random", laneIndex >= 0, false, [setLane, maximum] { setLane([maximum](StepSequencer::Lane& l)
+            {
+                juce::Random random;
+                for (int i = 0; i < l.numSteps; ++i)
+                    l.values[(size_t)i] = (juce::uint8)random.nextInt(maximum + 1);
+            }); });
+        fillMenu.addSeparator();
+        fillMenu.addItem("Toggle Glide On Every Step", laneIndex >= 0, false, [setLane] { setLane([](StepSequencer::Lane& l)
+            {
+                for (auto& flags : l.flags)
+                    flags = (juce::uint8)(flags ^ StepSequencer::stepGlide);
+            }); });
+
+        sequencerMenu.addSeparator();
+        sequencerMenu.addSubMenu("Step Length", stepMenu, laneIndex >= 0);
+        sequencerMenu.addSubMenu("Fill", fillMenu, laneIndex >= 0);
+
+        menu.addSubMenu("Step Sequencer", sequencerMenu, true, nullptr, laneIndex >= 0);
+    }
+
+    // Envelope follower on the plugin's audio input
+    {
+        auto& follower = audioProcessor.getEnvelopeFollower();
+        auto settings = follower.getSettings();
+        const bool following = settings.enabled && settings.slot == slot;
+
+        auto setFollower = [&follower, followSlot = slot, settings](auto&& change)
+            {
+                auto newSettings = settings;
+                newSettings.enabled = true;
+                newSettings.slot = followSlot;
+                change(newSettings);
+                follower.setSettings(newSettings);
+            };
+
+        juce::PopupMenu followerMenu;
+        followerMenu.addItem("Follow Input", true, following, [&follower, following, setFollower]
+            {
+                if (following)
+                {
+                    auto off = follower.getSettings();
+                    off.enabled = false;
+                    follower.setSettings(off);
+                }
+                else
+                {
+                    setFollower([](EnvelopeFollower::Settings&) {});
+                }
+            });
+
+        followerMenu.addSeparator();
+        followerMenu.addItem("Envelope", following, settings.mode == EnvelopeFollower::envelope, [setFollower] { setFollower([](EnvelopeFollower::Settings& f) { f.mode = EnvelopeFollower::envelope; }); });
+        followerMenu.addItem("Transient", following, settings.mode == EnvelopeFollower::transient, [setFollower] { setFollower([](EnvelopeFollower::Settings& f) { f.mode = EnvelopeFollower::transient; }); });
+
+        juce::PopupMenu responseMenu;
+        const std::array<std::tuple<const char*, float, float>, 3> responses{ { { "Fast", 1.0f, 60.0f }, { "Medium", 10.0f, 150.0f }, { "Slow", 50.0f, 600.0f } } };
+        for (auto& [responseName, attack, release] : responses)
+        {
+            responseMenu.addItem(responseName, following, settings.attackMs == attack && settings.releaseMs == release,
+                [setFollower, a = attack, r = release] { setFollower([a, r](EnvelopeFollower::Settings& f) { f.attackMs = a; f.releaseMs = r; }); });
+        }
+
+        juce::PopupMenu thresholdMenu;
+        for (auto threshold : { -60.0f, -40.0f, -24.0f, -12.0f })
+            thresholdMenu.addItem(juce::String(juce::roundToInt(threshold)) + " dB", following, settings.thresholdDb == threshold, [setFollower, threshold] { setFollower([threshold](EnvelopeFollower::Settings& f) { f.thresholdDb = threshold; }); });
+
+        juce::PopupMenu depthMenu;
+        for (auto depth : { 0.25f, 0.5f, 1.0f, -0.5f, -1.0f })
+            depthMenu.addItem(juce::String(juce::roundToInt(depth * 100.0f)) + " %", following, settings.depth == depth, [setFollower, depth] { setFollower([depth](EnvelopeFollower::Settings& f) { f.depth = depth; }); });
+
+        followerMenu.addSubMenu("Response", responseMenu, following);
+        followerMenu.addSubMenu("Threshold", thresholdMenu, following);
+        followerMenu.addSubMenu("Depth", depthMenu, following);
+
+        menu.addSubMenu("Envelope Follower", followerMenu, true, nullptr, following);
+    }
+
+    // How the knob maps to what the device receives
+    if (!stepped)
+    {
+        auto& outputCurves = audioProcessor.getOutputCurves();
+        auto current = outputCurves.getCurve(slot);
+        auto curve = current.value_or(ResponseCurve());
+
+        auto setResponse = [&outputCurves, curveSlot = slot, curve](auto&& change)
+            {
+                auto newCurve = curve;
+                change(newCurve);
+
+                if (newCurve.isIdentity())
+                    outputCurves.resetCurve(curveSlot);
+                else
+                    outputCurves.setCurve(curveSlot, newCurve);
+            };
+
+        juce::PopupMenu responseMenu;
+        responseMenu.addItem("Linear", true, curve.points.isEmpty() && curve.exponent == 1.0f, [setResponse] { setResponse([](ResponseCurve& c) { c.points.clear(); c.exponent = 1.0f; }); });
+        responseMenu.addItem("Exponential", true, curve.points.isEmpty() && curve.exponent > 1.0f, [setResponse] { setResponse([](ResponseCurve& c) { c.points.clear(); c.exponent = 2.0f; }); });
+        responseMenu.addItem("Logarithmic", true, curve.points.isEmpty() && curve.exponent < 1.0f, [setResponse] { setResponse([](ResponseCurve& c) { c.points.clear(); c.exponent = 0.5f; }); });
+        responseMenu.addItem("S-Curve", true, !curve.points.isEmpty(), [setResponse] { setResponse([](ResponseCurve& c)
+            {
+                c.points = { { 0.0f, 0.0f }, { 0.25f, 0.1f }, { 0.5f, 0.5f }, { 0.75f, 0.9f }, { 1.0f, 1.0f } };
+            }); });
+        responseMenu.addSeparator();
+        responseMenu.addItem("Inverted", true, curve.inverted, [setResponse] { setResponse([](ResponseCurve& c) { c.inverted = !c.inverted; }); });
+        responseMenu.addItem("Upper Half Only", true, curve.minimum == 0.5f, [setResponse] { setResponse([](ResponseCurve& c) { c.minimum = c.minimum == 0.5f ? 0.0f : 0.5f; }); });
+        responseMenu.addItem("Lower Half Only", true, curve.maximum == 0.5f, [setResponse] { setResponse([](ResponseCurve& c) { c.maximum = c.maximum == 0.5f ? 1.0f : 0.5f; }); });
+        responseMenu.addSeparator();
+        responseMenu.addItem("Reset", current.has_value(), false, [&outputCurves, curveSlot = slot] { outputCurves.resetCurve(curveSlot); });
+
+        menu.addSubMenu("Response", responseMenu, true, nullptr, current.has_value());
+    }
+
+    // External controller driving this knob, through its own range and curve
+    {
+        auto& midiLearn = audioProcessor.getMidiLearn();
+        auto mapping = midiLearn.findMappingForSlot(slot);
+        const bool learning = midiLearn.getLearningSlot() == slot;
+
+        auto setMapping = [&midiLearn, learnSlot = slot](auto&& change)
+            {
+                midiLearn.updateMappingForSlot(learnSlot, change);
+            };
+
+        juce::PopupMenu learnMenu;
+        learnMenu.addItem(learning ? "Waiting for CC... (Cancel)" : "Learn", true, learning, [&midiLearn, learnSlot = slot, learning]
+            {
+                if (learning)
+                    midiLearn.stopLearning();
+                else
+                    midiLearn.startLearning(learnSlot);
+            });
+
+        if (mapping)
+            learnMenu.addItem("CC " + juce::String(mapping->ccNumber) + ", Channel " + juce::String(mapping->channel), false, false, [] {});
+
+        const auto curve = mapping ? mapping->curve : ResponseCurve();
+        learnMenu.addSeparator();
+        learnMenu.addItem("Pickup", mapping.has_value(), mapping && mapping->pickup, [setMapping] { setMapping([](MidiLearnMap::Mapping& m) { m.pickup = !m.pickup; }); });
+        learnMenu.addItem("Inverted", mapping.has_value(), curve.inverted, [setMapping] { setMapping([](MidiLearnMap::Mapping& m) { m.curve.inverted = !m.curve.inverted; }); });
+        learnMenu.addItem("Exponential", mapping.has_value() && !stepped, curve.exponent > 1.0f, [setMapping] { setMapping([](MidiLearnMap::Mapping& m) { m.curve.exponent = m.curve.exponent > 1.0f ? 1.0f : 2.0f; }); });
+        learnMenu.addItem("Logarithmic", mapping.has_value() && !stepped, curve.exponent < 1.0f, [setMapping] { setMapping([](MidiLearnMap::Mapping& m) { m.curve.exponent = m.curve.exponent < 1.0f ? 1.0f : 0.5f; }); });
+        learnMenu.addItem("Upper Half Only", mapping.has_value(), curve.minimum == 0.5f, [setMapping] { setMapping([](MidiLearnMap::Mapping& m) { m.curve.minimum = m.curve.minimum == 0.5f ? 0.0f : 0.5f; }); });
+        learnMenu.addItem("Lower Half Only", mapping.has_value(), curve.maximum == 0.5f, [setMapping] { setMapping([](MidiLearnMap::Mapping& m) { m.curve.maximum = m.curve.maximum == 0.5f ? 1.0f : 0.5f; }); });
+        learnMenu.addSeparator();
+        learnMenu.addItem("Clear", mapping.has_value(), false, [&midiLearn, learnSlot = slot] { midiLearn.clearSlot(learnSlot); });
+
+        menu.addSubMenu("MIDI Learn", learnMenu, true, nullptr, mapping.has_value() || learning);
+    }
+
+    // Capture and Gesture presses wait for the grid set here
+    if (parameterID == "capture" || parameterID == "gesturePlayRec" || parameterID == "gestureStopErase")
+    {
+        juce::PopupMenu quantiseMenu;
+
+        if (auto* quantiseParameter = audioProcessor.parameters.getParameter("actionQuantise"))
+        {
+            const auto names = ActionScheduler::getQuantiseNames();
+            const int current = juce::roundToInt(quantiseParameter->convertFrom0to1(quantiseParameter->getValue()));
+
+            for (int i = 0; i < names.size(); ++i)
+            {
+                quantiseMenu.addItem(names[i], true, i == current, [quantiseParameter, i]
+                    {
+                        quantiseParameter->setValueNotifyingHost(quantiseParameter->convertTo0to1((float)i));
+                    });
+            }
+        }
+
+        menu.addSubMenu("Quantise", quantiseMenu);
+    }
+
+    // Record a loop of a set length, then play it back
+    if (parameterID == "capture")
+    {
+        auto& scheduler = audioProcessor.getActionScheduler();
+        juce::PopupMenu sequenceMenu;
+
+        for (int bars : { 1, 2, 4, 8 })
+        {
+            sequenceMenu.addItem("Record " + juce::String(bars) + (bars == 1 ? " Bar" : " Bars") + ", then Play", [&scheduler, captureSlot = slot, bars]
+                {
+                    // Capture reads 88-127 as Record and 44-87 as Play
+                    scheduler.scheduleSequence({ { 0.0, { ActionScheduler::setSlot, captureSlot, 127, true } },
+                                                 { (double)bars, { ActionScheduler::setSlot, captureSlot, 64, true } } },
+                                               ActionScheduler::deviceActions);
+                });
+        }
+
+        sequenceMenu.addSeparator();
+        sequenceMenu.addItem("Cancel Pending", [&scheduler] { scheduler.cancelAll(); });
+
+        menu.addSubMenu("Capture Sequence", sequenceMenu);
+    }
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(this));
+}
+
 void CCSliderModule::setEnabled(bool shouldBeEnabled)
 {
     Component::setEnabled(shouldBeEnabled);
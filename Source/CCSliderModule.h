@@ -26,6 +26,7 @@ public:
     // Component overrides
     void paint(juce::Graphics& g) override;
     void resized() override;
+    void mouseDown(const juce::MouseEvent& e) override;
 
     // Slider access
     juce::Slider& getSlider() { return slider; }
@@ -42,6 +43,9 @@ public:
     const juce::String& getParameterID() const { return parameterID; }
 
 private:
+    // Right click menu with per-parameter output settings
+    void showContextMenu();
+
     ChromaConsoleControllerAudioProcessor& audioProcessor;
 
     // UI Components
@@ -50,6 +54,8 @@ private:
 
     // Parameter info
     juce::String parameterID;
+    int slot = -1; // Index in ccConfigurations
+    bool stepped = false;
 
     // Attachment
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> attachment;
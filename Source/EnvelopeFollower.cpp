@@ -0,0 +1,227 @@
+/*
+  ==============================================================================
+
+    EnvelopeFollower.cpp
+    Created: 20 Oct 2026 3:55:21pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "EnvelopeFollower.h"
+
+EnvelopeFollower::EnvelopeFollower(const std::array<int, ParameterSnapshot::maxSlots>& maximums) : slotMaximums(maximums)
+{
+}
+
+EnvelopeFollower::Settings EnvelopeFollower::getSettings() const
+{
+    const juce::ScopedLock sl(settingsLock);
+    return settings;
+}
+
+void EnvelopeFollower::setSettings(const Settings& newSettings)
+{
+    auto checked = newSettings;
+    checked.enabled = checked.enabled && juce::isPositiveAndBelow(checked.slot, ParameterSnapshot::maxSlots);
+    checked.mode = juce::jlimit((int)envelope, (int)transient, checked.mode);
+    checked.attackMs = juce::jlimit(0.1f, 1000.0f, checked.attackMs);
+    checked.releaseMs = juce::jlimit(1.0f, 5000.0f, checked.releaseMs);
+    checked.rangeDb = juce::jmax(1.0f, checked.rangeDb);
+    checked.rateHz = juce::jlimit(10.0f, 2000.0f, checked.rateHz);
+
+    {
+        const juce::ScopedLock sl(settingsLock);
+        settings = checked;
+    }
+
+    const juce::SpinLock::ScopedLockType lock(pendingLock);
+    pendingSettings = checked;
+    settingsChanged.store(true);
+}
+
+void EnvelopeFollower::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    fastEnvelope = 0.0f;
+    slowEnvelope = 0.0f;
+    partialPeak = 0.0f;
+    partialLength = 0;
+    blockStartLevel = 0.0f;
+    numChunks = 0;
+}
+
+void EnvelopeFollower::update() noexcept
+{
+    if (!settingsChanged.load())
+        return;
+
+    const juce::SpinLock::ScopedTryLockType lock(pendingLock);
+    if (lock.isLocked())
+    {
+        active = pendingSettings;
+        settingsChanged.store(false);
+    }
+}
+
+float EnvelopeFollower::getCoefficient(float timeMs, int length, double rate) noexcept
+{
+    // One-pole coefficient for a smoother that only runs once every `length` samples
+    return std::exp(-(float)length / (float)(timeMs * 0.001 * rate));
+}
+
+void EnvelopeFollower::analyse(const juce::AudioBuffer<float>& buffer, int numInputChannels) noexcept
+{
+    blockStartLevel = numChunks > 0 ? levels[(size_t)numChunks - 1] : blockStartLevel;
+    numChunks = 0;
+
+    if (!active.enabled)
+    {
+        partialPeak = 0.0f;
+        partialLength = 0;
+        blockStartLevel = 0.0f;
+        return;
+    }
+
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin(numInputChannels, buffer.getNumChannels());
+
+    chunkLength = juce::jmax(1, juce::roundToInt(sampleRate / active.rateHz), (numSamples + maxChunks - 1) / maxChunks);
+
+    const float fastAttack = getCoefficient(active.attackMs, chunkLength, sampleRate);
+    const float fastRelease = getCoefficient(active.releaseMs, chunkLength, sampleRate);
+    const float slowAttack = getCoefficient(active.attackMs * 10.0f, chunkLength, sampleRate);
+    const float slowRelease = getCoefficient(active.releaseMs * 2.0f, chunkLength, sampleRate);
+
+    int start = 0;
+
+    while (start < numSamples || partialLength >= chunkLength)
+    {
+        // Rest of the chunk in this block, or all of it if the rate went up and it's already full
+        const int length = juce::jlimit(0, numSamples - start, chunkLength - partialLength);
+
+        // Vectorised peak scan, the only per-sample work
+        for (int channel = 0; channel < numChannels && length > 0; ++channel)
+        {
+            auto range = juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(channel, start), length);
+            partialPeak = juce::jmax(partialPeak, -range.getStart(), range.getEnd());
+        }
+
+        start += length;
+        partialLength += length;
+
+        if (partialLength < chunkLength)
+            break; // Finished in the next block
+
+        const float peak = partialPeak;
+        partialPeak = 0.0f;
+        partialLength = 0;
+
+        fastEnvelope = peak + (fastEnvelope - peak) * (peak > fastEnvelope ? fastAttack : fastRelease);
+        slowEnvelope = peak + (slowEnvelope - peak) * (peak > slowEnvelope ? slowAttack : slowRelease);
+
+        const float fastDb = juce::Decibels::gainToDecibels(fastEnvelope, -120.0f);
+        float level = 0.0f;
+
+        if (active.mode == transient)
+        {
+            // How far the attack pokes out above the body, gated by the threshold
+            if (fastDb > active.thresholdDb)
+                level = (fastDb - juce::Decibels::gainToDecibels(slowEnvelope, -120.0f)) / active.rangeDb;
+        }
+        else
+        {
+            level = (fastDb - active.thresholdDb) / active.rangeDb;
+        }
+
+        // The carried chunk can make one more than fit, it replaces the last one
+        const auto index = (size_t)juce::jmin(numChunks, maxChunks - 1);
+        levels[index] = juce::jlimit(0.0f, 1.0f, level);
+        chunkEnds[index] = start;
+        numChunks = (int)index + 1;
+    }
+
+    currentLevel.store(numChunks > 0 ? levels[(size_t)numChunks - 1] : blockStartLevel);
+}
+
+void EnvelopeFollower::process(int sample, float* values) const noexcept
+{
+    if (!active.enabled)
+        return;
+
+    // Last chunk finished at or before this sample
+    const auto finished = std::upper_bound(chunkEnds.begin(), chunkEnds.begin() + numChunks, sample) - chunkEnds.begin();
+    const float level = finished > 0 ? levels[(size_t)finished - 1] : blockStartLevel;
+
+    const auto slot = (size_t)active.slot;
+    const auto range = (float)slotMaximums[slot];
+
+    values[slot] = juce::jlimit(0.0f, range, values[slot] + active.depth * level * range);
+}
+
+//==============================================================================
+juce::ValueTree EnvelopeFollower::toValueTree() const
+{
+    auto current = getSettings();
+
+    juce::ValueTree tree("EnvelopeFollower");
+    tree.setProperty("enabled", current.enabled, nullptr);
+    tree.setProperty("slot", current.slot, nullptr);
+    tree.setProperty("mode", current.mode, nullptr);
+    tree.setProperty("attack", current.attackMs, nullptr);
+    tree.setProperty("release", current.releaseMs, nullptr);
+    tree.setProperty("threshold", current.thresholdDb, nullptr);
+    tree.setProperty("range", current.rangeDb, nullptr);
+    tree.setProperty("depth", current.depth, nullptr);
+    tree.setProperty("rate", current.rateHz, nullptr);
+    return tree;
+}
+
+void EnvelopeFollower::fromValueTree(const juce::ValueTree& tree)
+{
+    setSettings(readSettings(tree));
+}
+
+EnvelopeFollower::Settings EnvelopeFollower::readSettings(const juce::ValueTree& tree)
+{
+    Settings newSettings;
+    newSettings.enabled = tree.getProperty("enabled", false);
+    newSettings.slot = tree.getProperty("slot", -1);
+    newSettings.mode = tree.getProperty("mode", (int)envelope);
+    newSettings.attackMs = tree.getProperty("attack", 10.0f);
+    newSettings.releaseMs = tree.getProperty("release", 150.0f);
+    newSettings.thresholdDb = tree.getProperty("threshold", -40.0f);
+    newSettings.rangeDb = tree.getProperty("range", 30.0f);
+    newSettings.depth = tree.getProperty("depth", 0.5f);
+    newSettings.rateHz = tree.getProperty("rate", 500.0f);
+    return newSettings;
+}
+
+void EnvelopeFollower::writeBinaryState(juce::OutputStream& out) const
+{
+    auto current = getSettings();
+    out.writeBool(current.enabled);
+    out.writeByte((char)current.slot);
+    out.writeByte((char)current.mode);
+    out.writeFloat(current.attackMs);
+    out.writeFloat(current.releaseMs);
+    out.writeFloat(current.thresholdDb);
+    out.writeFloat(current.rangeDb);
+    out.writeFloat(current.depth);
+    out.writeFloat(current.rateHz);
+}
+
+void EnvelopeFollower::readBinaryState(juce::InputStream& in)
+{
+    Settings newSettings;
+    newSettings.enabled = in.readBool();
+    newSettings.slot = in.readByte();
+    newSettings.mode = in.readByte();
+    newSettings.attackMs = in.readFloat();
+    newSettings.releaseMs = in.readFloat();
+    newSettings.thresholdDb = in.readFloat();
+    newSettings.rangeDb = in.readFloat();
+    newSettings.depth = in.readFloat();
+    newSettings.rateHz = in.readFloat();
+    setSettings(newSettings);
+}
@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    EnvelopeFollower.h
+    Created: 20 Oct 2026 3:55:21pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterSnapshot.h"
+
+/*
+Follows the level of the plugin's audio input and uses it to push one CC
+slot around its current value, e.g. a drum bus opening up Mix on every hit.
+
+The block is cut into chunks at the follower's control rate. Each chunk's
+peak comes from a vectorised min/max scan, then a one-pole attack/release
+smoother runs once per chunk, so the per-sample cost is just the scan.
+The chunk grid carries on across blocks: a chunk cut off by the end of a
+block is finished in the next one, so every smoothing step covers exactly
+one chunk whatever the host's buffer size. Samples use the level of the
+last finished chunk. Transient mode follows how far a fast envelope sits above a slow one.
+*/
+
+class EnvelopeFollower
+{
+public:
+    enum Mode
+    {
+        envelope = 0,
+        transient
+    };
+
+    struct Settings
+    {
+        bool enabled = false;
+        int slot = -1;
+        int mode = envelope;
+        float attackMs = 10.0f;
+        float releaseMs = 150.0f;
+        float thresholdDb = -40.0f; // Level where the output starts to move
+        float rangeDb = 30.0f;      // dB above the threshold for full depth
+        float depth = 0.5f;         // Fraction of the slot's range at full level, negative pushes down
+        float rateHz = 500.0f;      // Control rate the level is updated at
+    };
+
+    static constexpr int maxChunks = 1024;
+
+    // slotMaximums: top of each slot's raw range (127, or 5 for the module selects)
+    explicit EnvelopeFollower(const std::array<int, ParameterSnapshot::maxSlots>& slotMaximums);
+
+    //=========================
+    // Message thread
+    Settings getSettings() const;
+    void setSettings(const Settings& settings);
+
+    juce::ValueTree toValueTree() const;
+    void fromValueTree(const juce::ValueTree& tree);
+    static Settings readSettings(const juce::ValueTree& tree); // Decodes without applying, for presets
+    void writeBinaryState(juce::OutputStream& out) const;
+    void readBinaryState(juce::InputStream& in);
+
+    //=========================
+    // Audio thread
+    void prepare(double sampleRate);
+    void update() noexcept; // Picks up edited settings, call once per block
+    bool isActive() const noexcept { return active.enabled; }
+
+    // Measures the input. Must run before the buffer is cleared
+    void analyse(const juce::AudioBuffer<float>& buffer, int numInputChannels) noexcept;
+
+    // Adds the follower's output at sample (block relative) to its slot
+    void process(int sample, float* values) const noexcept;
+
+    float getCurrentLevel() const noexcept { return currentLevel.load(); } // 0-1, for metering
+
+private:
+    static float getCoefficient(float timeMs, int chunkLength, double sampleRate) noexcept;
+
+    const std::array<int, ParameterSnapshot::maxSlots> slotMaximums;
+
+    mutable juce::CriticalSection settingsLock;
+    Settings settings;
+
+    juce::SpinLock pendingLock;
+    Settings pendingSettings;
+    std::atomic<bool> settingsChanged{ false };
+
+    // Audio thread
+    Settings active;
+    double sampleRate = 44100.0;
+    float fastEnvelope = 0.0f;
+    float slowEnvelope = 0.0f;
+    int chunkLength = 1;
+    float partialPeak = 0.0f; // Chunk carried over from the previous block
+    int partialLength = 0;
+    float blockStartLevel = 0.0f; // Level of the last chunk finished before this block
+    int numChunks = 0;
+    std::array<float, maxChunks> levels{}; // Output 0-1 for each chunk finished in the current block
+    std::array<int, maxChunks> chunkEnds{}; // Sample (block relative) each of those chunks finished at
+
+    std::atomic<float> currentLevel{ 0.0f };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EnvelopeFollower)
+};
@@ -0,0 +1,494 @@
+/*
+  ==============================================================================
+
+    GestureRecorder.cpp
+    Created: 20 Oct 2026 5:12:40pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "GestureRecorder.h"
+
+GestureRecorder::GestureRecorder(const std::array<int, ParameterSnapshot::maxSlots>& maximums)
+    : slotMaximums(maximums),
+    pendingTable(std::make_unique<Table>()),
+    activeTable(std::make_unique<Table>())
+{
+}
+
+//==============================================================================
+void GestureRecorder::startRecording()
+{
+    recordState.store(startRequested);
+}
+
+void GestureRecorder::stopRecording()
+{
+    if (recordState.exchange(idle) != recording)
+        return;
+
+    Take newTake;
+    double startPpq, barBeats;
+    {
+        // The audio thread only ever try-locks this, so waiting here can't stall it
+        const juce::SpinLock::ScopedLockType lock(ringLock);
+
+        startPpq = recordStartPpq;
+        barBeats = recordBarBeats;
+
+        const auto count = (juce::uint64)juce::jmin(ringWritten, (juce::uint64)ringSize);
+        newTake.events.reserve((size_t)count);
+
+        for (auto i = ringWritten - count; i < ringWritten; ++i)
+        {
+            const auto& recorded = ring[(size_t)(i % ringSize)];
+            newTake.events.push_back({ recorded.ppq - startPpq, recorded.slot, recorded.value });
+        }
+    }
+
+    if (newTake.events.empty())
+        return;
+
+    // Whole bars from the bar the recording started in
+    const double recordedBeats = juce::jmax(recordEndPpq.load() - startPpq, newTake.events.back().ppq);
+    newTake.lengthBeats = juce::jmax(1.0, std::ceil(recordedBeats / barBeats - 1.0e-6)) * barBeats;
+    newTake.offsetBeats = std::fmod(startPpq, newTake.lengthBeats);
+
+    for (auto& event : newTake.events)
+        event.ppq = juce::jlimit(0.0, newTake.lengthBeats, event.ppq);
+
+    sortEvents(newTake.events);
+
+    // A long, busy take is thinned until it fits
+    for (double spacing = 1.0 / 256.0; (int)newTake.events.size() > maxEvents; spacing *= 2.0)
+        thinEvents(newTake.events, spacing);
+
+    setTake(newTake);
+}
+
+void GestureRecorder::setPlaying(bool shouldPlay)
+{
+    playing.store(shouldPlay);
+}
+
+GestureRecorder::Take GestureRecorder::getTake() const
+{
+    const juce::ScopedLock sl(takeLock);
+    return take;
+}
+
+void GestureRecorder::setTake(const Take& newTake)
+{
+    {
+        const juce::ScopedLock sl(takeLock);
+        take = newTake;
+        take.lengthBeats = juce::jmax(0.0, take.lengthBeats);
+
+        take.events.erase(std::remove_if(take.events.begin(), take.events.end(), [this](const Event& event)
+            {
+                return !juce::isPositiveAndBelow(event.slot, ParameterSnapshot::maxSlots)
+                    || event.ppq < 0.0 || event.ppq > take.lengthBeats;
+            }), take.events.end());
+
+        for (auto& event : take.events)
+            event.value = juce::jlimit(0, slotMaximums[(size_t)event.slot], event.value);
+
+        sortEvents(take.events);
+
+        if ((int)take.events.size() > maxEvents)
+            take.events.resize((size_t)maxEvents);
+    }
+
+    publish();
+}
+
+void GestureRecorder::clear()
+{
+    setTake({});
+}
+
+int GestureRecorder::getNumEvents() const
+{
+    const juce::ScopedLock sl(takeLock);
+    return (int)take.events.size();
+}
+
+void GestureRecorder::quantise(double gridBeats)
+{
+    auto quantised = getTake();
+    if (quantised.events.empty() || gridBeats <= 0.0)
+        return;
+
+    for (auto& event : quantised.events)
+    {
+        event.ppq = std::round(event.ppq / gridBeats) * gridBeats;
+        if (event.ppq >= quantised.lengthBeats)
+            event.ppq = 0.0; // Rounded past the end, lands on the loop start
+    }
+
+    sortEvents(quantised.events);
+
+    // Sorting keeps recorded order within a line, so walking backwards the first event
+    // seen for a slot on each line is the one that wins
+    std::array<double, ParameterSnapshot::maxSlots> lineSeen;
+    lineSeen.fill(-1.0);
+
+    std::vector<Event> kept;
+    kept.reserve(quantised.events.size());
+
+    for (auto event = quantised.events.rbegin(); event != quantised.events.rend(); ++event)
+    {
+        if (std::exchange(lineSeen[(size_t)event->slot], event->ppq) != event->ppq)
+            kept.push_back(*event);
+    }
+
+    std::reverse(kept.begin(), kept.end());
+
+    quantised.events = std::move(kept);
+    setTake(quantised);
+}
+
+void GestureRecorder::thin(double minimumSpacingBeats)
+{
+    auto thinned = getTake();
+    if (thinned.events.empty())
+        return;
+
+    thinEvents(thinned.events, minimumSpacingBeats);
+    setTake(thinned);
+}
+
+void GestureRecorder::sortEvents(std::vector<Event>& events)
+{
+    std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.ppq < b.ppq; });
+}
+
+void GestureRecorder::thinEvents(std::vector<Event>& events, double minimumSpacingBeats)
+{
+    std::array<double, ParameterSnapshot::maxSlots> lastKeptPpq;
+    std::array<int, ParameterSnapshot::maxSlots> lastKeptValue;
+    lastKeptPpq.fill(-1.0e9);
+    lastKeptValue.fill(-1);
+
+    // Position of each event's next event on the same slot, found walking backwards
+    std::vector<double> nextOnSlot(events.size());
+    {
+        std::array<double, ParameterSnapshot::maxSlots> next;
+        next.fill(std::numeric_limits<double>::max());
+
+        for (auto i = events.size(); i-- > 0;)
+        {
+            nextOnSlot[i] = next[(size_t)events[i].slot];
+            next[(size_t)events[i].slot] = events[i].ppq;
+        }
+    }
+
+    std::vector<Event> kept;
+    kept.reserve(events.size());
+
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        const auto& event = events[i];
+        const auto slot = (size_t)event.slot;
+
+        if (event.value == lastKeptValue[slot])
+            continue;
+
+        const bool spaced = event.ppq - lastKeptPpq[slot] >= minimumSpacingBeats;
+        const bool endOfRun = nextOnSlot[i] - event.ppq >= minimumSpacingBeats;
+
+        if (spaced || endOfRun)
+        {
+            kept.push_back(event);
+            lastKeptPpq[slot] = event.ppq;
+            lastKeptValue[slot] = event.value;
+        }
+    }
+
+    events = std::move(kept);
+}
+
+void GestureRecorder::publish()
+{
+    auto table = std::make_unique<Table>();
+    {
+        const juce::ScopedLock sl(takeLock);
+        table->lengthBeats = take.lengthBeats;
+        table->offsetBeats = take.offsetBeats;
+
+        // Counting sort by slot, each slot's events stay in time order
+        std::array<int, ParameterSnapshot::maxSlots> counts{};
+        for (const auto& event : take.events)
+            ++counts[(size_t)event.slot];
+
+        for (size_t slot = 0; slot < counts.size(); ++slot)
+            table->slotStart[slot + 1] = table->slotStart[slot] + counts[slot];
+
+        auto write = table->slotStart;
+        for (const auto& event : take.events)
+        {
+            const auto index = (size_t)write[(size_t)event.slot]++;
+            table->positions[index] = (float)event.ppq;
+            table->values[index] = (juce::uint8)event.value;
+        }
+    }
+
+    {
+        const juce::SpinLock::ScopedLockType lock(tableLock);
+        std::swap(pendingTable, table);
+        tableChanged.store(true);
+    }
+
+    // table now holds whatever was pending before and is freed here, off the audio thread
+}
+
+//==============================================================================
+void GestureRecorder::update() noexcept
+{
+    if (!tableChanged.load())
+        return;
+
+    const juce::SpinLock::ScopedTryLockType lock(tableLock);
+    if (lock.isLocked())
+    {
+        std::swap(activeTable, pendingTable);
+        tableChanged.store(false);
+    }
+}
+
+void GestureRecorder::beginBlock(const TransportInfo& transport) noexcept
+{
+    if (recordState.load() == startRequested)
+    {
+        const juce::SpinLock::ScopedTryLockType lock(ringLock);
+        if (lock.isLocked())
+        {
+            ringWritten = 0;
+            recordStartPpq = transport.barStartPpq;
+            recordBarBeats = transport.getQuarterNotesPerBar();
+
+            int expected = startRequested;
+            recordState.compare_exchange_strong(expected, recording);
+        }
+    }
+
+    if (isCapturing())
+        recordEndPpq.store(transport.getEndPpq());
+}
+
+bool GestureRecorder::isActive() const noexcept
+{
+    // Playback pauses while a new take is being recorded
+    return playing.load() && !isCapturing() && activeTable->lengthBeats > 0.0 && activeTable->slotStart.back() > 0;
+}
+
+void GestureRecorder::capture(int slot, int value, double ppq) noexcept
+{
+    if (!isCapturing() || !juce::isPositiveAndBelow(slot, ParameterSnapshot::maxSlots))
+        return;
+
+    // Only contended while stopRecording reads the ring out, dropping an event then is fine
+    const juce::SpinLock::ScopedTryLockType lock(ringLock);
+    if (!lock.isLocked())
+        return;
+
+    ring[(size_t)(ringWritten % ringSize)] = { juce::jmax(recordStartPpq, ppq), (juce::uint8)slot,
+                                               (juce::uint8)juce::jlimit(0, slotMaximums[(size_t)slot], value) };
+    ++ringWritten;
+}
+
+double GestureRecorder::getLoopPosition(double ppq) const noexcept
+{
+    const auto length = activeTable->lengthBeats;
+    const auto position = std::fmod(ppq - activeTable->offsetBeats, length);
+    return position < 0.0 ? position + length : position;
+}
+
+int GestureRecorder::addEventBoundaries(const TransportInfo& transport, int* splitPoints, int numSplits, int maxSplits) const noexcept
+{
+    if (!isActive())
+        return numSplits;
+
+    const auto& table = *activeTable;
+    const double start = getLoopPosition(transport.ppq);
+    const double span = transport.getEndPpq() - transport.ppq;
+
+    // The block can run over the loop end, then the search continues from the loop start
+    for (double windowStart = start, ppqAtWindow = transport.ppq, remaining = span;
+         remaining > 0.0 && numSplits < maxSplits;
+         ppqAtWindow += table.lengthBeats - windowStart, remaining -= table.lengthBeats - windowStart, windowStart = 0.0)
+    {
+        const double windowEnd = juce::jmin(table.lengthBeats, windowStart + remaining);
+
+        for (size_t slot = 0; slot < (size_t)ParameterSnapshot::maxSlots && numSplits < maxSplits; ++slot)
+        {
+            const auto* first = table.positions.data() + table.slotStart[slot];
+            const auto* last = table.positions.data() + table.slotStart[slot + 1];
+
+            for (auto* event = std::lower_bound(first, last, (float)windowStart); event != last && *event < windowEnd && numSplits < maxSplits; ++event)
+            {
+                const int sample = transport.getSampleForPpq(ppqAtWindow + (*event - windowStart));
+                if (sample >= 0)
+                    splitPoints[numSplits++] = sample;
+            }
+        }
+    }
+
+    return numSplits;
+}
+
+void GestureRecorder::process(double ppq, float* values) const noexcept
+{
+    if (!isActive())
+        return;
+
+    const auto& table = *activeTable;
+
+    // Small offset so a boundary computed from a sample position picks up its event
+    const auto position = (float)(getLoopPosition(ppq) + 1.0e-6);
+
+    for (size_t slot = 0; slot < (size_t)ParameterSnapshot::maxSlots; ++slot)
+    {
+        const int first = table.slotStart[slot];
+        const int last = table.slotStart[slot + 1];
+        if (first == last)
+            continue;
+
+        // Last event at or before the position, or the last one of the loop before its first event
+        int index = (int)(std::upper_bound(table.positions.data() + first, table.positions.data() + last, position) - table.positions.data()) - 1;
+        if (index < first)
+            index = last - 1;
+
+        values[slot] = (float)table.values[(size_t)index];
+    }
+}
+
+//==============================================================================
+static void writeVarint(juce::MemoryOutputStream& out, juce::uint32 value)
+{
+    while (value >= 0x80)
+    {
+        out.writeByte((char)((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+
+    out.writeByte((char)value);
+}
+
+static juce::uint32 readVarint(juce::MemoryInputStream& in)
+{
+    juce::uint32 value = 0;
+
+    for (int shift = 0; shift < 35 && !in.isExhausted(); shift += 7)
+    {
+        const auto byte = (juce::uint8)in.readByte();
+        value |= (juce::uint32)(byte & 0x7f) << shift;
+
+        if ((byte & 0x80) == 0)
+            break;
+    }
+
+    return value;
+}
+
+juce::MemoryBlock GestureRecorder::encode(const Take& take)
+{
+    // lengthTicks | offsetTicks | count | (deltaTicks, slot, zigzag value delta) per event.
+    // Times are deltas from the previous event, values deltas from the slot's previous value
+    juce::MemoryOutputStream out;
+    writeVarint(out, (juce::uint32)juce::roundToInt(take.lengthBeats * ticksPerQuarter));
+    writeVarint(out, (juce::uint32)juce::roundToInt(take.offsetBeats * ticksPerQuarter));
+    writeVarint(out, (juce::uint32)take.events.size());
+
+    std::array<int, ParameterSnapshot::maxSlots> previousValues{};
+    juce::int64 previousTick = 0;
+
+    for (const auto& event : take.events)
+    {
+        const auto tick = juce::jmax(previousTick, (juce::int64)std::llround(event.ppq * ticksPerQuarter));
+        const int delta = event.value - previousValues[(size_t)event.slot];
+
+        writeVarint(out, (juce::uint32)(tick - previousTick));
+        out.writeByte((char)event.slot);
+        writeVarint(out, (juce::uint32)((delta << 1) ^ (delta >> 31)));
+
+        previousTick = tick;
+        previousValues[(size_t)event.slot] = event.value;
+    }
+
+    return out.getMemoryBlock();
+}
+
+GestureRecorder::Take GestureRecorder::decode(const juce::MemoryBlock& data, const std::array<int, ParameterSnapshot::maxSlots>& maximums)
+{
+    Take decoded;
+    juce::MemoryInputStream in(data, false);
+
+    decoded.lengthBeats = readVarint(in) / (double)ticksPerQuarter;
+    decoded.offsetBeats = readVarint(in) / (double)ticksPerQuarter;
+    const auto count = juce::jmin((int)readVarint(in), maxEvents);
+
+    std::array<int, ParameterSnapshot::maxSlots> previousValues{};
+    juce::int64 tick = 0;
+
+    for (int i = 0; i < count && !in.isExhausted(); ++i)
+    {
+        tick += readVarint(in);
+        const int slot = (juce::uint8)in.readByte();
+        const auto zigzag = readVarint(in);
+
+        if (!juce::isPositiveAndBelow(slot, ParameterSnapshot::maxSlots))
+            continue;
+
+        const int value = previousValues[(size_t)slot] + ((int)(zigzag >> 1) ^ -(int)(zigzag & 1));
+        previousValues[(size_t)slot] = value;
+        decoded.events.push_back({ tick / (double)ticksPerQuarter, slot, juce::jlimit(0, maximums[(size_t)slot], value) });
+    }
+
+    return decoded;
+}
+
+juce::ValueTree GestureRecorder::toValueTree() const
+{
+    juce::ValueTree tree("Gestures");
+    tree.setProperty("playing", isPlaying(), nullptr);
+
+    auto current = getTake();
+    if (!current.events.empty())
+        tree.setProperty("take", encode(current).toBase64Encoding(), nullptr);
+
+    return tree;
+}
+
+void GestureRecorder::fromValueTree(const juce::ValueTree& tree)
+{
+    setPlaying(tree.getProperty("playing", true));
+    setTake(readTake(tree, slotMaximums));
+}
+
+GestureRecorder::Take GestureRecorder::readTake(const juce::ValueTree& tree, const std::array<int, ParameterSnapshot::maxSlots>& maximums)
+{
+    juce::MemoryBlock data;
+    if (data.fromBase64Encoding(tree.getProperty("take").toString()))
+        return decode(data, maximums);
+
+    return {};
+}
+
+void GestureRecorder::writeBinaryState(juce::OutputStream& out) const
+{
+    const auto data = encode(getTake());
+    out.writeBool(isPlaying());
+    out.writeInt((int)data.getSize());
+    out.write(data.getData(), data.getSize());
+}
+
+void GestureRecorder::readBinaryState(juce::InputStream& in)
+{
+    setPlaying(in.readBool());
+
+    juce::MemoryBlock data;
+    in.readIntoMemoryBlock(data, juce::jmax(0, in.readInt()));
+    setTake(decode(data, slotMaximums));
+}
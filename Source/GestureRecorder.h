@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+    GestureRecorder.h
+    Created: 20 Oct 2026 5:12:40pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterSnapshot.h"
+#include "TransportInfo.h"
+
+/*
+Records knob movements (from the editor, automation or incoming CCs) and loops
+them back in time with the host, as a plugin side take of the pedal's own
+gesture feature.
+
+While recording, the audio thread writes PPQ stamped events into a fixed
+ring buffer. Stopping turns the ring into a take: a whole number of bars
+starting at the bar the recording began in. Takes can be quantised and
+thinned before they play back.
+
+Playback uses a compiled table (events grouped by slot, sorted by position),
+swapped in without allocating. The value for a slot is a binary search on
+the loop position, so playback follows loops and locates like the sequencer.
+Takes are saved as delta coded bytes, usually 2-3 bytes per event.
+*/
+
+class GestureRecorder
+{
+public:
+    static constexpr int ringSize = 16384;       // Events kept while recording, oldest dropped first
+    static constexpr int maxEvents = 8192;       // Events in a take
+    static constexpr int ticksPerQuarter = 960;  // Timing resolution of saved takes
+
+    struct Event
+    {
+        double ppq = 0.0; // Quarter notes from the start of the loop
+        int slot = 0;
+        int value = 0;    // Raw slot value
+    };
+
+    struct Take
+    {
+        double lengthBeats = 0.0; // Loop length, 0 for an empty take
+        double offsetBeats = 0.0; // Host position of the loop start, modulo the length
+        std::vector<Event> events; // Sorted by ppq
+    };
+
+    // slotMaximums: top of each slot's raw range (127, or 5 for the module selects)
+    explicit GestureRecorder(const std::array<int, ParameterSnapshot::maxSlots>& slotMaximums);
+
+    //=========================
+    // Message thread
+    void startRecording(); // Starts capturing on the next block
+    void stopRecording();  // Replaces the take with what was captured
+    bool isRecording() const noexcept { return recordState.load() != idle; }
+
+    void setPlaying(bool shouldPlay);
+    bool isPlaying() const noexcept { return playing.load(); }
+
+    Take getTake() const;
+    void setTake(const Take& take);
+    void clear();
+    int getNumEvents() const;
+
+    // Moves every event to the nearest grid line, keeping the last value per slot per line
+    void quantise(double gridBeats);
+
+    // Drops events closer than minimumSpacingBeats to the previous kept one on the
+    // same slot, except the last of each run so the settled value still lands
+    void thin(double minimumSpacingBeats);
+
+    juce::ValueTree toValueTree() const;
+    void fromValueTree(const juce::ValueTree& tree);
+    static Take readTake(const juce::ValueTree& tree, const std::array<int, ParameterSnapshot::maxSlots>& slotMaximums); // Empty if unreadable
+    void writeBinaryState(juce::OutputStream& out) const;
+    void readBinaryState(juce::InputStream& in);
+
+    //=========================
+    // Audio thread
+    void update() noexcept; // Picks up a new take, call once per block
+    void beginBlock(const TransportInfo& transport) noexcept; // Starts a requested recording
+    bool isCapturing() const noexcept { return recordState.load() == recording; }
+    bool isActive() const noexcept;
+
+    // Records a raw slot value at ppq. Only does anything while capturing
+    void capture(int slot, int value, double ppq) noexcept;
+
+    // Appends the sample offset of every event in this block, returns the new count
+    int addEventBoundaries(const TransportInfo& transport, int* splitPoints, int numSplits, int maxSplits) const noexcept;
+
+    // Overwrites the recorded slots with their values at ppq
+    void process(double ppq, float* values) const noexcept;
+
+private:
+    enum RecordState
+    {
+        idle = 0,
+        startRequested,
+        recording
+    };
+
+    struct Table
+    {
+        double lengthBeats = 0.0;
+        double offsetBeats = 0.0;
+        std::array<int, ParameterSnapshot::maxSlots + 1> slotStart{}; // Events for slot s are [slotStart[s], slotStart[s + 1])
+        std::array<float, maxEvents> positions{};
+        std::array<juce::uint8, maxEvents> values{};
+    };
+
+    struct RingEvent
+    {
+        double ppq;
+        juce::uint8 slot;
+        juce::uint8 value;
+    };
+
+    void publish();
+    double getLoopPosition(double ppq) const noexcept;
+    static void sortEvents(std::vector<Event>& events);
+    static void thinEvents(std::vector<Event>& events, double minimumSpacingBeats);
+
+    static juce::MemoryBlock encode(const Take& take);
+    static Take decode(const juce::MemoryBlock& data, const std::array<int, ParameterSnapshot::maxSlots>& slotMaximums);
+
+    const std::array<int, ParameterSnapshot::maxSlots> slotMaximums;
+
+    mutable juce::CriticalSection takeLock;
+    Take take;
+
+    std::atomic<int> recordState{ idle };
+    std::atomic<bool> playing{ true };
+
+    // Capture ring, written by the audio thread under a try-lock and read out once on stop
+    juce::SpinLock ringLock;
+    std::array<RingEvent, ringSize> ring;
+    juce::uint64 ringWritten = 0;
+    double recordStartPpq = 0.0;
+    double recordBarBeats = 4.0;
+    std::atomic<double> recordEndPpq{ 0.0 };
+
+    // Same swap as MacroEngine, tables are only allocated and freed on the message thread
+    juce::SpinLock tableLock;
+    std::unique_ptr<Table> pendingTable;
+    std::atomic<bool> tableChanged{ false };
+
+    std::unique_ptr<Table> activeTable; // Audio thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GestureRecorder)
+};
@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+    GlideEngine.cpp
+    Created: 19 Oct 2026 8:02:16pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "GlideEngine.h"
+
+GlideEngine::GlideEngine(juce::uint32 defaultSlots) : enabledSlots(defaultSlots)
+{
+}
+
+void GlideEngine::setSlotEnabled(int slot, bool shouldGlide)
+{
+    if (slot < 0 || slot >= ParameterSnapshot::maxSlots)
+        return;
+
+    if (shouldGlide)
+        enabledSlots.fetch_or(1u << slot);
+    else
+        enabledSlots.fetch_and(~(1u << slot));
+}
+
+void GlideEngine::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    minimumIntervalSamples = (float)(sampleRate * minimumIntervalMs / 1000.0);
+    reset();
+}
+
+void GlideEngine::reset() noexcept
+{
+    numActive = 0;
+}
+
+int GlideEngine::findActive(int slot) const noexcept
+{
+    for (int i = 0; i < numActive; ++i)
+    {
+        if (slots[(size_t)i] == slot)
+            return i;
+    }
+
+    return -1;
+}
+
+void GlideEngine::removeActive(int index) noexcept
+{
+    // Move the last glide into the gap, order doesn't matter
+    const auto last = (size_t)--numActive;
+    const auto i = (size_t)index;
+
+    slots[i] = slots[last];
+    targets[i] = targets[last];
+    position[i] = position[last];
+    increment[i] = increment[last];
+    lower[i] = lower[last];
+    upper[i] = upper[last];
+    nextEvent[i] = nextEvent[last];
+}
+
+void GlideEngine::cancel(int slot) noexcept
+{
+    auto index = findActive(slot);
+    if (index >= 0)
+        removeActive(index);
+}
+
+bool GlideEngine::setTarget(int slot, int targetValue, int currentValue, float glideMs, Mode mode) noexcept
+{
+    auto index = findActive(slot);
+    float start = 0.0f;
+
+    if (index >= 0)
+    {
+        if (targets[(size_t)index] == targetValue)
+            return true; // Already on its way
+
+        start = position[(size_t)index]; // Retarget from wherever it has got to
+    }
+    else
+    {
+        // Nothing sent yet (or a resend was requested): jump straight there
+        if (currentValue < 0 || currentValue == targetValue || glideMs <= 0.0f || numActive >= maxGlides)
+            return false;
+
+        index = numActive++;
+        slots[(size_t)index] = (juce::uint8)slot;
+        start = (float)currentValue;
+    }
+
+    const float distance = (float)targetValue - start;
+    const float glideSamples = juce::jmax(1.0f, (float)(glideMs * sampleRate / 1000.0));
+
+    if (std::abs(distance) < 1.0e-3f)
+    {
+        removeActive(index);
+        return false;
+    }
+
+    const float inc = mode == constantTime ? distance / glideSamples
+                                           : (distance > 0.0f ? 127.0f : -127.0f) / glideSamples;
+
+    const auto i = (size_t)index;
+    targets[i] = targetValue;
+    position[i] = start;
+    increment[i] = inc;
+    lower[i] = juce::jmin(start, (float)targetValue);
+    upper[i] = juce::jmax(start, (float)targetValue);
+
+    // First whole value past the start, in the direction of travel
+    const float firstValue = inc > 0.0f ? std::floor(start) + 1.0f : std::ceil(start) - 1.0f;
+    nextEvent[i] = juce::jmax(0.0f, (firstValue - start) / inc);
+
+    return true;
+}
+
+void GlideEngine::advance(int numSamples) noexcept
+{
+    // One pass over the packed arrays for every active glide
+    juce::FloatVectorOperations::addWithMultiply(position.data(), increment.data(), (float)numSamples, numActive);
+
+    for (int i = 0; i < numActive; ++i)
+        position[(size_t)i] = juce::jlimit(lower[(size_t)i], upper[(size_t)i], position[(size_t)i]);
+
+    // Glides that sent their target were marked with an infinite next event
+    for (int i = numActive; --i >= 0;)
+    {
+        if (nextEvent[(size_t)i] > 1.0e30f)
+            removeActive(i);
+    }
+}
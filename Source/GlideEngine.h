@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+    GlideEngine.h
+    Created: 19 Oct 2026 8:02:16pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterSnapshot.h"
+
+/*
+Smooths CC output so jumps (preset loads, automation steps, clicks) are sent
+as a run of intermediate values instead of a single step.
+
+Only slots that are currently gliding are stored, packed at the front of a
+set of parallel arrays, so a block costs one pass over the active glides no
+matter how many parameters exist. Each intermediate value is placed at the
+sample where the glide crosses it, spaced at least minimumIntervalMs apart
+so fast glides don't flood the MIDI port.
+
+Everything except the slot mask is audio thread only.
+*/
+
+class GlideEngine
+{
+public:
+    enum Mode
+    {
+        constantTime = 0, // Every glide takes the glide time
+        constantRate      // Glide time is for a full 0-127 sweep, short jumps are quicker
+    };
+
+    static constexpr float minimumIntervalMs = 1.0f; // About one 3-byte message on a DIN port
+
+    explicit GlideEngine(juce::uint32 defaultSlots);
+
+    // Slots that glide, one bit per ccConfigurations slot. Safe from any thread
+    void setSlotEnabled(int slot, bool shouldGlide);
+    bool isSlotEnabled(int slot) const noexcept { return (enabledSlots.load() >> slot) & 1u; }
+    juce::uint32 getEnabledSlots() const noexcept { return enabledSlots.load(); }
+    void setEnabledSlots(juce::uint32 mask) { enabledSlots.store(mask); }
+
+    //=========================
+    // Audio thread
+    void prepare(double sampleRate);
+    void reset() noexcept;
+
+    // Sets where the slot should end up. currentValue is the CC value the device
+    // last received. Returns false if the slot isn't gliding, the caller should
+    // then send targetValue directly
+    bool setTarget(int slot, int targetValue, int currentValue, float glideMs, Mode mode) noexcept;
+    void cancel(int slot) noexcept;
+
+    // Calls emit(slot, ccValue, samplePosition) for every value crossed in
+    // [startSample, startSample + numSamples) of the block
+    template <typename EmitFunction>
+    void render(int startSample, int numSamples, EmitFunction&& emit) noexcept
+    {
+        for (int i = 0; i < numActive; ++i)
+        {
+            const float inc = increment[(size_t)i];
+            float t = nextEvent[(size_t)i];
+
+            while (t < (float)numSamples)
+            {
+                const float p = juce::jlimit(lower[(size_t)i], upper[(size_t)i], position[(size_t)i] + inc * t);
+                const int value = inc > 0.0f ? (int)std::floor(p + 1.0e-3f) : (int)std::ceil(p - 1.0e-3f);
+
+                emit((int)slots[(size_t)i], value, startSample + juce::jlimit(0, numSamples - 1, (int)t));
+
+                if (value == targets[(size_t)i])
+                {
+                    t = std::numeric_limits<float>::max(); // Done, removed below
+                    break;
+                }
+
+                // Next integer crossing, but never closer than the minimum interval
+                const float crossing = ((float)(inc > 0.0f ? value + 1 : value - 1) - position[(size_t)i]) / inc;
+                t = juce::jmax(crossing, t + minimumIntervalSamples);
+            }
+
+            nextEvent[(size_t)i] = t - (float)numSamples;
+        }
+
+        advance(numSamples);
+    }
+
+private:
+    int findActive(int slot) const noexcept;
+    void removeActive(int index) noexcept;
+    void advance(int numSamples) noexcept;
+
+    std::atomic<juce::uint32> enabledSlots;
+
+    double sampleRate = 44100.0;
+    float minimumIntervalSamples = 44.1f;
+
+    // Active glides, indices [0, numActive)
+    static constexpr int maxGlides = ParameterSnapshot::maxSlots;
+    int numActive = 0;
+    std::array<juce::uint8, maxGlides> slots{};
+    std::array<int, maxGlides> targets{};
+    std::array<float, maxGlides> position{};   // Value at the start of the next render
+    std::array<float, maxGlides> increment{};  // Per sample
+    std::array<float, maxGlides> lower{};      // Clamp range, start and target in order
+    std::array<float, maxGlides> upper{};
+    std::array<float, maxGlides> nextEvent{};  // Samples from the start of the next render
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GlideEngine)
+};
@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    LatencyCompensation.cpp
+    Created: 22 Oct 2026 6:41:27pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "LatencyCompensation.h"
+
+double LatencyCompensation::getLookaheadSeconds() const noexcept
+{
+    return getMode() == predictTransport ? getOffsetMs() / 1000.0 : 0.0;
+}
+
+int LatencyCompensation::getLatencySamples(double sampleRate) const noexcept
+{
+    return getMode() == reportToHost ? juce::roundToInt(getOffsetMs() * sampleRate / 1000.0) : 0;
+}
+
+//==============================================================================
+std::optional<float> LatencyCompensation::measureFromRecording(const juce::File& file) const
+{
+    const double pulseSeconds = testPulseSeconds.load();
+    if (pulseSeconds < 0.0)
+        return std::nullopt;
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+    if (reader == nullptr || reader->sampleRate <= 0.0)
+        return std::nullopt;
+
+    // Only the stretch around the pulse, up to the longest offset after it
+    const double sampleRate = reader->sampleRate;
+    const auto endSample = juce::jmin(reader->lengthInSamples, (juce::int64)((pulseSeconds + maxOffsetMs / 1000.0 + 0.1) * sampleRate));
+    const auto startSample = juce::jmax((juce::int64)0, (juce::int64)((pulseSeconds - 0.25) * sampleRate));
+    if (endSample <= startSample)
+        return std::nullopt;
+
+    juce::AudioBuffer<float> buffer((int)reader->numChannels, (int)(endSample - startSample));
+    if (!reader->read(&buffer, 0, buffer.getNumSamples(), startSample, true, true))
+        return std::nullopt;
+
+    const double bufferStartSeconds = (double)startSample / sampleRate;
+    auto onset = findOnsetSeconds(buffer, sampleRate, pulseSeconds - bufferStartSeconds);
+    if (!onset)
+        return std::nullopt;
+
+    const auto ms = (float)((bufferStartSeconds + *onset - pulseSeconds) * 1000.0);
+    if (ms < 0.0f || ms > maxOffsetMs)
+        return std::nullopt;
+
+    return ms;
+}
+
+std::optional<double> LatencyCompensation::findOnsetSeconds(const juce::AudioBuffer<float>& buffer, double sampleRate, double fromSeconds)
+{
+    const int numSamples = buffer.getNumSamples();
+    const int from = juce::jlimit(0, numSamples, (int)(fromSeconds * sampleRate));
+    const int baselineStart = juce::jmax(0, from - (int)(0.2 * sampleRate));
+
+    auto peakAt = [&buffer](int sample)
+        {
+            float peak = 0.0f;
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                peak = juce::jmax(peak, std::abs(buffer.getSample(channel, sample)));
+            return peak;
+        };
+
+    // The level has been at 0 for a bar, so this is the noise floor
+    float baseline = 0.0f;
+    for (int sample = baselineStart; sample < from; ++sample)
+        baseline = juce::jmax(baseline, peakAt(sample));
+
+    // -40 dB, or well clear of the noise
+    const float threshold = juce::jmax(0.01f, baseline * 4.0f);
+
+    for (int sample = from; sample < numSamples; ++sample)
+    {
+        if (peakAt(sample) > threshold)
+            return sample / sampleRate;
+    }
+
+    return std::nullopt;
+}
+
+//==============================================================================
+void LatencyCompensation::writeBinaryState(juce::OutputStream& out) const
+{
+    out.writeByte((char)getMode());
+    out.writeFloat(getOffsetMs());
+    out.writeDouble(testPulseSeconds.load());
+}
+
+void LatencyCompensation::readBinaryState(juce::InputStream& in)
+{
+    setMode((Mode)juce::jlimit((int)off, (int)reportToHost, (int)in.readByte()));
+    setOffsetMs(in.readFloat());
+    testPulseSeconds.store(in.readDouble());
+}
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    LatencyCompensation.h
+    Created: 22 Oct 2026 6:41:27pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+Output latency compensation. The pedal reacts some time after a CC leaves:
+the MIDI interface, the host's MIDI output and the pedal's own processing.
+Each instance has an offset in ms and one of two ways to send early by it:
+
+  predictTransport  Reads the transport that much ahead, so everything synced
+                    to it (scheduled actions, sequencer, recorded gestures,
+                    LFOs, clock) is sent early. Host automation still
+                    arrives on time.
+  reportToHost      Reports the offset as plugin latency. Hosts that
+                    compensate MIDI output then run the whole track early,
+                    automation included.
+
+The offset can be measured from a loopback. The test pulse drops Output
+Level to 0 for a bar and then sets it to 127, noting where on the host
+timeline the CC left. With a steady signal going through the pedal, the
+pedal's return is recorded or rendered from the start of the project, and
+measureFromRecording() finds where the level jumps in that file.
+*/
+
+class LatencyCompensation
+{
+public:
+    enum Mode
+    {
+        off = 0,
+        predictTransport,
+        reportToHost
+    };
+
+    static constexpr float maxOffsetMs = 500.0f;
+
+    //=========================
+    // Any thread
+    void setMode(Mode newMode) noexcept { mode.store(newMode); }
+    Mode getMode() const noexcept { return (Mode)mode.load(); }
+    void setOffsetMs(float ms) noexcept { offsetMs.store(juce::jlimit(0.0f, maxOffsetMs, ms)); }
+    float getOffsetMs() const noexcept { return offsetMs.load(); }
+
+    double getLookaheadSeconds() const noexcept;
+    int getLatencySamples(double sampleRate) const noexcept;
+
+    //=========================
+    // Loopback measurement
+    // Audio thread, when the pulse's CC goes out
+    void markTestPulse(double timelineSeconds) noexcept { testPulseSeconds.store(timelineSeconds); }
+    bool hasTestPulse() const noexcept { return testPulseSeconds.load() >= 0.0; }
+
+    // Offset in ms from a recording that starts at the project start, or nothing
+    // if no pulse was sent or no jump in level was found after it
+    std::optional<float> measureFromRecording(const juce::File& file) const;
+
+    // First sample after fromSeconds clearly louder than the 200 ms before it
+    static std::optional<double> findOnsetSeconds(const juce::AudioBuffer<float>& buffer, double sampleRate, double fromSeconds);
+
+    void writeBinaryState(juce::OutputStream& out) const;
+    void readBinaryState(juce::InputStream& in);
+
+private:
+    std::atomic<int> mode{ off };
+    std::atomic<float> offsetMs{ 0.0f };
+    std::atomic<double> testPulseSeconds{ -1.0 };
+};
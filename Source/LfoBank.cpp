@@ -0,0 +1,279 @@
+/*
+  ==============================================================================
+
+    LfoBank.cpp
+    Created: 20 Oct 2026 9:48:15am
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "LfoBank.h"
+
+LfoBank::LfoBank(const std::array<int, ParameterSnapshot::maxSlots>& maximums) : slotMaximums(maximums)
+{
+}
+
+LfoBank::Settings LfoBank::getLfo(int index) const
+{
+    if (!juce::isPositiveAndBelow(index, numLfos))
+        return {};
+
+    const juce::ScopedLock sl(settingsLock);
+    return settings[(size_t)index];
+}
+
+void LfoBank::setLfo(int index, const Settings& newSettings)
+{
+    if (!juce::isPositiveAndBelow(index, numLfos))
+        return;
+
+    {
+        const juce::ScopedLock sl(settingsLock);
+        auto& lfo = settings[(size_t)index];
+        lfo = newSettings;
+        lfo.shape = juce::jlimit(0, numShapes - 1, lfo.shape);
+        lfo.cycleBeats = juce::jmax(1.0f / 64.0f, lfo.cycleBeats);
+        lfo.enabled = lfo.enabled && juce::isPositiveAndBelow(lfo.slot, ParameterSnapshot::maxSlots);
+    }
+
+    publish();
+}
+
+int LfoBank::findLfoForSlot(int slot) const
+{
+    const juce::ScopedLock sl(settingsLock);
+
+    for (int i = 0; i < numLfos; ++i)
+    {
+        if (settings[(size_t)i].enabled && settings[(size_t)i].slot == slot)
+            return i;
+    }
+
+    return -1;
+}
+
+int LfoBank::setLfoForSlot(int slot, const Settings& newSettings)
+{
+    int index = findLfoForSlot(slot);
+
+    if (index < 0)
+    {
+        const juce::ScopedLock sl(settingsLock);
+
+        for (int i = 0; i < numLfos && index < 0; ++i)
+        {
+            if (!settings[(size_t)i].enabled)
+                index = i;
+        }
+    }
+
+    if (index >= 0)
+    {
+        auto lfo = newSettings;
+        lfo.slot = slot;
+        lfo.enabled = true;
+        setLfo(index, lfo);
+    }
+
+    return index;
+}
+
+void LfoBank::clearSlot(int slot)
+{
+    {
+        const juce::ScopedLock sl(settingsLock);
+
+        for (auto& lfo : settings)
+        {
+            if (lfo.slot == slot)
+                lfo = {};
+        }
+    }
+
+    publish();
+}
+
+void LfoBank::publish()
+{
+    const juce::ScopedLock sl(settingsLock);
+    const juce::SpinLock::ScopedLockType lock(pendingLock);
+    pendingSettings = settings;
+    settingsChanged.store(true);
+}
+
+void LfoBank::update() noexcept
+{
+    if (!settingsChanged.load())
+        return;
+
+    const juce::SpinLock::ScopedTryLockType lock(pendingLock);
+    if (!lock.isLocked())
+        return;
+
+    activeSettings = pendingSettings;
+    settingsChanged.store(false);
+
+    activeCount = 0;
+    for (auto& lfo : activeSettings)
+        activeCount += lfo.enabled ? 1 : 0;
+}
+
+//==============================================================================
+float LfoBank::randomForCycle(juce::int64 cycle, int lfoIndex) noexcept
+{
+    // splitmix64 of (cycle, lfo), the same cycle always gives the same value
+    auto x = (juce::uint64)cycle * 0x9e3779b97f4a7c15ull + (juce::uint64)lfoIndex * 0xd1b54a32d192ed03ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    x ^= x >> 31;
+
+    return (float)((double)(x >> 11) * (1.0 / 9007199254740992.0)) * 2.0f - 1.0f;
+}
+
+float LfoBank::getValue(int shape, double ppq, double cycleBeats, double phase, int lfoIndex) noexcept
+{
+    const double position = ppq / cycleBeats + phase;
+    const double cycleStart = std::floor(position);
+    const auto cycle = (juce::int64)cycleStart;
+    const auto t = (float)(position - cycleStart); // 0-1 within the cycle
+
+    switch (shape)
+    {
+        case sine:          return std::sin(juce::MathConstants<float>::twoPi * t);
+        case triangle:      return t < 0.5f ? 4.0f * t - 1.0f : 3.0f - 4.0f * t;
+        case square:        return t < 0.5f ? 1.0f : -1.0f;
+        case sampleAndHold: return randomForCycle(cycle, lfoIndex);
+        case smoothRandom:
+        {
+            // Cosine blend from this cycle's random value to the next one
+            const float blend = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::pi * t);
+            const float from = randomForCycle(cycle, lfoIndex);
+            return from + (randomForCycle(cycle + 1, lfoIndex) - from) * blend;
+        }
+        default:            return 0.0f;
+    }
+}
+
+void LfoBank::process(double ppq, float* values) const noexcept
+{
+    for (int i = 0; i < numLfos; ++i)
+    {
+        const auto& lfo = activeSettings[(size_t)i];
+        if (!lfo.enabled)
+            continue;
+
+        const auto slot = (size_t)lfo.slot;
+        const auto range = (float)slotMaximums[slot];
+        const float wave = getValue(lfo.shape, ppq, lfo.cycleBeats, lfo.phase, i);
+
+        values[slot] = juce::jlimit(0.0f, range, values[slot] + (lfo.offset + lfo.depth * wave) * range);
+    }
+}
+
+//==============================================================================
+juce::ValueTree LfoBank::toValueTree() const
+{
+    juce::ValueTree tree("Lfos");
+    const juce::ScopedLock sl(settingsLock);
+
+    for (int i = 0; i < numLfos; ++i)
+    {
+        const auto& lfo = settings[(size_t)i];
+        if (!lfo.enabled)
+            continue;
+
+        juce::ValueTree child("Lfo");
+        child.setProperty("index", i, nullptr);
+        child.setProperty("slot", lfo.slot, nullptr);
+        child.setProperty("shape", lfo.shape, nullptr);
+        child.setProperty("cycleBeats", lfo.cycleBeats, nullptr);
+        child.setProperty("phase", lfo.phase, nullptr);
+        child.setProperty("depth", lfo.depth, nullptr);
+        child.setProperty("offset", lfo.offset, nullptr);
+        tree.appendChild(child, nullptr);
+    }
+
+    return tree;
+}
+
+void LfoBank::setLfos(const Lfos& newSettings)
+{
+    {
+        const juce::ScopedLock sl(settingsLock);
+        settings = newSettings;
+    }
+
+    publish();
+}
+
+void LfoBank::fromValueTree(const juce::ValueTree& tree)
+{
+    setLfos(readLfos(tree));
+}
+
+LfoBank::Lfos LfoBank::readLfos(const juce::ValueTree& tree)
+{
+    Lfos newSettings;
+
+    for (const auto& child : tree)
+    {
+        const int index = child.getProperty("index", -1);
+        if (!juce::isPositiveAndBelow(index, numLfos))
+            continue;
+
+        auto& lfo = newSettings[(size_t)index];
+        lfo.slot = child.getProperty("slot", -1);
+        lfo.enabled = juce::isPositiveAndBelow(lfo.slot, ParameterSnapshot::maxSlots);
+        lfo.shape = juce::jlimit(0, numShapes - 1, (int)child.getProperty("shape", 0));
+        lfo.cycleBeats = juce::jmax(1.0f / 64.0f, (float)child.getProperty("cycleBeats", 1.0f));
+        lfo.phase = child.getProperty("phase", 0.0f);
+        lfo.depth = child.getProperty("depth", 0.25f);
+        lfo.offset = child.getProperty("offset", 0.0f);
+    }
+
+    return newSettings;
+}
+
+void LfoBank::writeBinaryState(juce::OutputStream& out) const
+{
+    const juce::ScopedLock sl(settingsLock);
+
+    for (const auto& lfo : settings)
+    {
+        out.writeBool(lfo.enabled);
+        out.writeByte((char)lfo.slot);
+        out.writeByte((char)lfo.shape);
+        out.writeFloat(lfo.cycleBeats);
+        out.writeFloat(lfo.phase);
+        out.writeFloat(lfo.depth);
+        out.writeFloat(lfo.offset);
+    }
+}
+
+void LfoBank::readBinaryState(juce::InputStream& in)
+{
+    std::array<Settings, numLfos> newSettings;
+
+    for (auto& lfo : newSettings)
+    {
+        if (in.isExhausted())
+            break;
+
+        lfo.enabled = in.readBool();
+        lfo.slot = in.readByte();
+        lfo.shape = juce::jlimit(0, numShapes - 1, (int)in.readByte());
+        lfo.cycleBeats = juce::jmax(1.0f / 64.0f, in.readFloat());
+        lfo.phase = in.readFloat();
+        lfo.depth = in.readFloat();
+        lfo.offset = in.readFloat();
+        lfo.enabled = lfo.enabled && juce::isPositiveAndBelow(lfo.slot, ParameterSnapshot::maxSlots);
+    }
+
+    {
+        const juce::ScopedLock sl(settingsLock);
+        settings = newSettings;
+    }
+
+    publish();
+}
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    LfoBank.h
+    Created: 20 Oct 2026 9:48:15am
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterSnapshot.h"
+
+/*
+Tempo synced LFOs, each modulating one CC slot around its current value.
+
+Phase comes straight from the host's PPQ position, so the LFOs stay locked
+to the grid through loops and jumps, and the random shapes are seeded from
+the cycle number so a looped section repeats exactly.
+*/
+
+class LfoBank
+{
+public:
+    static constexpr int numLfos = 8;
+
+    enum Shape
+    {
+        sine = 0,
+        triangle,
+        square,
+        sampleAndHold,
+        smoothRandom,
+        numShapes
+    };
+
+    struct Settings
+    {
+        bool enabled = false;
+        int slot = -1;
+        int shape = sine;
+        float cycleBeats = 1.0f; // Length of one cycle in quarter notes
+        float phase = 0.0f;      // 0-1
+        float depth = 0.25f;     // Peak swing as a fraction of the slot's range, negative flips it
+        float offset = 0.0f;     // Shift as a fraction of the slot's range
+    };
+
+    // slotMaximums: top of each slot's raw range (127, or 5 for the module selects)
+    explicit LfoBank(const std::array<int, ParameterSnapshot::maxSlots>& slotMaximums);
+
+    //=========================
+    // Message thread
+    Settings getLfo(int index) const;
+    void setLfo(int index, const Settings& settings);
+
+    int findLfoForSlot(int slot) const;        // -1 if no LFO targets the slot
+    int setLfoForSlot(int slot, const Settings& settings); // Reuses or claims an LFO, -1 if all are taken
+    void clearSlot(int slot);
+
+    // Whole bank at once, e.g. from a preset
+    using Lfos = std::array<Settings, numLfos>;
+    void setLfos(const Lfos& newSettings);
+
+    juce::ValueTree toValueTree() const;
+    void fromValueTree(const juce::ValueTree& tree);
+    static Lfos readLfos(const juce::ValueTree& tree); // Decodes without applying, for presets
+    void writeBinaryState(juce::OutputStream& out) const;
+    void readBinaryState(juce::InputStream& in);
+
+    //=========================
+    // Audio thread
+    void update() noexcept; // Picks up edited settings, call once per block
+    bool isActive() const noexcept { return activeCount > 0; }
+
+    // Adds every enabled LFO at ppq to values (raw slot values), clamped to each slot's range
+    void process(double ppq, float* values) const noexcept;
+
+    static float getValue(int shape, double ppq, double cycleBeats, double phase, int lfoIndex) noexcept; // -1 to 1
+
+private:
+    static float randomForCycle(juce::int64 cycle, int lfoIndex) noexcept;
+    void publish();
+
+    const std::array<int, ParameterSnapshot::maxSlots> slotMaximums;
+
+    mutable juce::CriticalSection settingsLock;
+    std::array<Settings, numLfos> settings;
+
+    juce::SpinLock pendingLock;
+    std::array<Settings, numLfos> pendingSettings;
+    std::atomic<bool> settingsChanged{ false };
+
+    // Audio thread copy
+    std::array<Settings, numLfos> activeSettings;
+    int activeCount = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LfoBank)
+};
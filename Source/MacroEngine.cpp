@@ -0,0 +1,202 @@
+/*
+  ==============================================================================
+
+    MacroEngine.cpp
+    Created: 19 Oct 2026 9:20:48pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "MacroEngine.h"
+
+MacroEngine::MacroEngine(const std::array<int, ParameterSnapshot::maxSlots>& maximums)
+    : slotMaximums(maximums),
+    pendingTable(std::make_unique<Table>()),
+    activeTable(std::make_unique<Table>())
+{
+}
+
+std::vector<MacroEngine::Target> MacroEngine::getTargets() const
+{
+    const juce::ScopedLock sl(targetLock);
+    return targets;
+}
+
+void MacroEngine::setTargets(const std::vector<Target>& newTargets)
+{
+    {
+        const juce::ScopedLock sl(targetLock);
+        targets.clear();
+
+        for (auto& target : newTargets)
+        {
+            if (juce::isPositiveAndBelow(target.macro, numMacros)
+                && juce::isPositiveAndBelow(target.slot, ParameterSnapshot::maxSlots)
+                && (int)targets.size() < maxTargets)
+                targets.push_back(target);
+        }
+    }
+
+    compileTable();
+}
+
+std::optional<MacroEngine::Target> MacroEngine::findTarget(int macro, int slot) const
+{
+    const juce::ScopedLock sl(targetLock);
+
+    for (auto& target : targets)
+    {
+        if (target.macro == macro && target.slot == slot)
+            return target;
+    }
+
+    return std::nullopt;
+}
+
+void MacroEngine::assign(int macro, int slot, const ResponseCurve& curve)
+{
+    auto newTargets = getTargets();
+
+    auto existing = std::find_if(newTargets.begin(), newTargets.end(),
+        [=](const Target& t) { return t.macro == macro && t.slot == slot; });
+
+    if (existing != newTargets.end())
+        existing->curve = curve;
+    else
+        newTargets.push_back({ macro, slot, curve });
+
+    setTargets(newTargets);
+}
+
+void MacroEngine::unassign(int macro, int slot)
+{
+    auto newTargets = getTargets();
+
+    newTargets.erase(std::remove_if(newTargets.begin(), newTargets.end(),
+        [=](const Target& t) { return t.macro == macro && t.slot == slot; }), newTargets.end());
+
+    setTargets(newTargets);
+}
+
+void MacroEngine::compileTable()
+{
+    auto table = std::make_unique<Table>();
+    {
+        const juce::ScopedLock sl(targetLock);
+
+        for (auto& target : targets)
+        {
+            const int t = table->numTargets++;
+            table->slots[(size_t)t] = (juce::uint8)target.slot;
+            table->macros[(size_t)t] = (juce::uint8)target.macro;
+            target.curve.compile(table->luts.data() + t * lutSize, lutSize, lutSize - 1, slotMaximums[(size_t)target.slot]);
+        }
+    }
+
+    {
+        const juce::SpinLock::ScopedLockType lock(tableLock);
+        std::swap(pendingTable, table);
+        tableChanged.store(true);
+    }
+
+    // table now holds whatever was pending before and is freed here, off the audio thread
+}
+
+void MacroEngine::process(const float* macroValues, float* values, int numSlots) noexcept
+{
+    if (tableChanged.load())
+    {
+        const juce::SpinLock::ScopedTryLockType lock(tableLock);
+        if (lock.isLocked())
+        {
+            std::swap(activeTable, pendingTable);
+            tableChanged.store(false);
+        }
+    }
+
+    const auto& table = *activeTable;
+    if (table.numTargets == 0)
+        return;
+
+    std::array<int, numMacros> lutIndex;
+    for (int macro = 0; macro < numMacros; ++macro)
+        lutIndex[(size_t)macro] = juce::roundToInt(juce::jlimit(0.0f, 1.0f, macroValues[macro]) * (float)(lutSize - 1));
+
+    // One load per target, no branches
+    for (int t = 0; t < table.numTargets; ++t)
+    {
+        const auto slot = table.slots[(size_t)t];
+        values[slot] = (float)table.luts[(size_t)(t * lutSize + lutIndex[table.macros[(size_t)t]])];
+    }
+
+    juce::ignoreUnused(numSlots);
+}
+
+//==============================================================================
+juce::ValueTree MacroEngine::toValueTree() const
+{
+    juce::ValueTree tree("Macros");
+
+    for (auto& target : getTargets())
+    {
+        juce::ValueTree child("Target");
+        child.setProperty("macro", target.macro, nullptr);
+        child.setProperty("slot", target.slot, nullptr);
+        target.curve.writeToValueTree(child);
+        tree.appendChild(child, nullptr);
+    }
+
+    return tree;
+}
+
+void MacroEngine::fromValueTree(const juce::ValueTree& tree)
+{
+    setTargets(readTargets(tree));
+}
+
+std::vector<MacroEngine::Target> MacroEngine::readTargets(const juce::ValueTree& tree)
+{
+    std::vector<Target> newTargets;
+
+    for (const auto& child : tree)
+    {
+        Target target;
+        target.macro = child.getProperty("macro", -1);
+        target.slot = child.getProperty("slot", -1);
+        target.curve = ResponseCurve::fromValueTree(child);
+        newTargets.push_back(target);
+    }
+
+    return newTargets;
+}
+
+void MacroEngine::writeBinaryState(juce::OutputStream& out) const
+{
+    auto currentTargets = getTargets();
+    out.writeCompressedInt((int)currentTargets.size());
+
+    for (auto& target : currentTargets)
+    {
+        out.writeByte((char)target.macro);
+        out.writeByte((char)target.slot);
+        target.curve.write(out);
+    }
+}
+
+void MacroEngine::readBinaryState(juce::InputStream& in)
+{
+    std::vector<Target> newTargets;
+    const int numTargets = juce::jlimit(0, maxTargets, in.readCompressedInt());
+
+    for (int i = 0; i < numTargets && !in.isExhausted(); ++i)
+    {
+        Target target;
+        target.macro = (juce::uint8)in.readByte();
+        target.slot = (juce::uint8)in.readByte();
+        target.curve = ResponseCurve::read(in);
+        newTargets.push_back(target);
+    }
+
+    setTargets(newTargets);
+}
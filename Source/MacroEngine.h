@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    MacroEngine.h
+    Created: 19 Oct 2026 9:20:48pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterSnapshot.h"
+#include "ResponseCurve.h"
+
+/*
+Eight macro knobs, each driving any number of CC slots through its own
+range and curve. An assigned slot follows its macro instead of its knob.
+
+Assignments are edited on the message thread. Every edit compiles them into
+a flat table (slot, macro, 128-entry lookup) which the audio thread swaps in
+without allocating; evaluating it is one table load per target.
+*/
+
+class MacroEngine
+{
+public:
+    static constexpr int numMacros = 8;
+    static constexpr int lutSize = 128;
+    static constexpr int maxTargets = numMacros * ParameterSnapshot::maxSlots;
+
+    struct Target
+    {
+        int macro = 0;
+        int slot = 0;
+        ResponseCurve curve;
+    };
+
+    // slotMaximums: top of each slot's raw range (127, or 5 for the module selects)
+    explicit MacroEngine(const std::array<int, ParameterSnapshot::maxSlots>& slotMaximums);
+
+    //=========================
+    // Message thread
+    std::vector<Target> getTargets() const;
+    void setTargets(const std::vector<Target>& newTargets);
+
+    std::optional<Target> findTarget(int macro, int slot) const;
+    void assign(int macro, int slot, const ResponseCurve& curve = {}); // Replaces an existing assignment
+    void unassign(int macro, int slot);
+
+    // Presets keep assignments as a "Macros" child, the plugin state as bytes
+    juce::ValueTree toValueTree() const;
+    void fromValueTree(const juce::ValueTree& tree);
+    static std::vector<Target> readTargets(const juce::ValueTree& tree); // Decodes without applying, for presets
+    void writeBinaryState(juce::OutputStream& out) const; // Targets and curves, macro positions are plugin parameters
+    void readBinaryState(juce::InputStream& in);
+
+    //=========================
+    // Audio thread. macroValues are 0-1, values are raw slot values
+    void process(const float* macroValues, float* values, int numSlots) noexcept;
+
+private:
+    struct Table
+    {
+        int numTargets = 0;
+        std::array<juce::uint8, maxTargets> slots{};
+        std::array<juce::uint8, maxTargets> macros{};
+        std::array<juce::uint8, maxTargets * lutSize> luts{}; // lutSize entries per target
+    };
+
+    void compileTable();
+
+    const std::array<int, ParameterSnapshot::maxSlots> slotMaximums;
+
+    mutable juce::CriticalSection targetLock;
+    std::vector<Target> targets;
+
+    // The audio thread swaps pending and active under a try-lock, so tables are
+    // only ever allocated and freed on the message thread
+    juce::SpinLock tableLock;
+    std::unique_ptr<Table> pendingTable;
+    std::atomic<bool> tableChanged{ false };
+
+    std::unique_ptr<Table> activeTable; // Audio thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MacroEngine)
+};
@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    MidiBandwidthBudget.h
+    Created: 20 Oct 2026 9:12:37am
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+Token bucket that keeps generated CC traffic under what a 5-pin DIN port can
+carry (31250 baud, 3 byte messages, roughly 1000 per second). Tokens refill
+with time; a burst like a preset load can spend the whole bucket at once.
+
+Audio thread only.
+*/
+
+class MidiBandwidthBudget
+{
+public:
+    static constexpr double messagesPerSecond = 1000.0;
+    static constexpr double burstSize = 64.0;
+
+    void prepare(double newSampleRate)
+    {
+        tokensPerSample = messagesPerSecond / newSampleRate;
+        tokens = burstSize;
+        lastSample = 0;
+    }
+
+    // Refill up to samplePosition (block relative) in the current block
+    void advanceTo(int samplePosition) noexcept
+    {
+        if (samplePosition > lastSample)
+        {
+            tokens = juce::jmin(burstSize, tokens + (samplePosition - lastSample) * tokensPerSample);
+            lastSample = samplePosition;
+        }
+    }
+
+    // Call at the end of a block with its length
+    void endBlock(int numSamples) noexcept
+    {
+        advanceTo(numSamples);
+        lastSample = 0;
+    }
+
+    // Takes one token if there is one
+    bool trySpend() noexcept
+    {
+        if (tokens < 1.0)
+            return false;
+
+        tokens -= 1.0;
+        return true;
+    }
+
+private:
+    double tokensPerSample = messagesPerSecond / 44100.0;
+    double tokens = burstSize;
+    int lastSample = 0;
+};
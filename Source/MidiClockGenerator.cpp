@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+    MidiClockGenerator.cpp
+    Created: 20 Oct 2026 8:37:02pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "MidiClockGenerator.h"
+
+MidiClockGenerator::JitterStats MidiClockGenerator::getJitterStats() const noexcept
+{
+    JitterStats stats;
+    stats.numTicks = statTicks.load();
+    stats.maxMicroseconds = statMaxMicroseconds.load();
+    stats.meanMicroseconds = stats.numTicks > 0 ? (float)(statSumMicroseconds.load() / stats.numTicks) : 0.0f;
+    return stats;
+}
+
+//==============================================================================
+void MidiClockGenerator::prepare(double newSampleRate) noexcept
+{
+    sampleRate = newSampleRate;
+    samplesPerByte = sampleRate * 10.0 / 31250.0;
+    running = false;
+    tapsRemaining = 0;
+    wireFreeSample = 0.0;
+    numBlockTicks = 0;
+}
+
+void MidiClockGenerator::stop(juce::MidiBuffer& midiMessages, int samplePosition) noexcept
+{
+    midiMessages.addEvent(juce::MidiMessage::midiStop(), samplePosition);
+    running = false;
+}
+
+void MidiClockGenerator::process(juce::MidiBuffer& midiMessages, const TransportInfo& transport, bool enabled, int midiChannel) noexcept
+{
+    numBlockTicks = 0;
+
+    if (!enabled || !transport.isPlaying || !transport.hostPosition)
+    {
+        if (running)
+            stop(midiMessages, 0);
+
+        // Taps still work without the clock, placed on the free running beat
+        addTaps(midiMessages, transport, midiChannel);
+        return;
+    }
+
+    if (running && transport.jumped)
+        stop(midiMessages, 0);
+
+    constexpr double tolerance = 1.0e-6;
+
+    if (!running)
+    {
+        // Song Position counts 16ths. The pedal moves on the first clock after Continue,
+        // so point it at the next 16th and hold the clock back until then
+        const auto sixteenth = (juce::int64)std::ceil(transport.ppq * 4.0 - tolerance);
+
+        if (sixteenth <= 0)
+        {
+            midiMessages.addEvent(juce::MidiMessage::midiStart(), 0);
+            nextTick = 0;
+        }
+        else
+        {
+            const int position = (int)juce::jmin((juce::int64)16383, sixteenth);
+            midiMessages.addEvent(juce::MidiMessage::songPositionPointer(position), 0);
+            midiMessages.addEvent(juce::MidiMessage::midiContinue(), 0);
+            nextTick = (juce::int64)position * 6;
+        }
+
+        running = true;
+    }
+
+    // 24 ticks per quarter note, each on the sample nearest its position. One that rounds
+    // past the end of the block goes out first thing in the next
+    for (;; ++nextTick)
+    {
+        const double ideal = (nextTick / 24.0 - transport.ppq) / transport.ppqPerSample;
+        const int sample = juce::roundToInt(ideal);
+        if (sample >= transport.numSamples)
+            break;
+
+        midiMessages.addEvent(juce::MidiMessage::midiClock(), juce::jmax(0, sample));
+
+        if (numBlockTicks < maxTicksPerBlock)
+            idealTickSamples[(size_t)numBlockTicks++] = ideal;
+    }
+
+    addTaps(midiMessages, transport, midiChannel);
+}
+
+void MidiClockGenerator::addTaps(juce::MidiBuffer& midiMessages, const TransportInfo& transport, int midiChannel) noexcept
+{
+    if (const int requested = tapRequest.exchange(0); requested > 0)
+    {
+        tapsRemaining = requested;
+        nextTapPpq = std::ceil(transport.ppq - 1.0e-6);
+    }
+
+    const double tapBytes = 3.0 * samplesPerByte;
+
+    while (tapsRemaining > 0)
+    {
+        const int beatSample = transport.getSampleForPpq(nextTapPpq);
+        if (beatSample < 0)
+        {
+            if (nextTapPpq < transport.ppq)
+                nextTapPpq = std::ceil(transport.ppq - 1.0e-6); // Missed after a locate, tap the next beat
+            break;
+        }
+
+        // A tap still on the wire when a tick is due would delay it, so it follows the tick instead.
+        // Added after the tick on the same sample, it goes out second
+        int sample = beatSample;
+        for (int i = 0; i < numBlockTicks; ++i)
+        {
+            const int tickSample = juce::roundToInt(idealTickSamples[(size_t)i]);
+            if (tickSample >= sample && tickSample < sample + tapBytes)
+            {
+                sample = tickSample;
+                break;
+            }
+        }
+
+        midiMessages.addEvent(juce::MidiMessage::controllerEvent(midiChannel, tapTempoCC, 127), sample);
+        --tapsRemaining;
+        nextTapPpq += 1.0;
+    }
+}
+
+void MidiClockGenerator::measureJitter(const juce::MidiBuffer& midiMessages, int numSamples) noexcept
+{
+    if (resetRequested.exchange(false))
+    {
+        statTicks.store(0);
+        statSumMicroseconds.store(0.0);
+        statMaxMicroseconds.store(0.0f);
+    }
+
+    int tick = 0;
+    int ticks = statTicks.load();
+    double sum = statSumMicroseconds.load();
+    float worst = statMaxMicroseconds.load();
+
+    // Every message waits for the one before it to finish, clock bytes included
+    for (const auto metadata : midiMessages)
+    {
+        const double start = juce::jmax((double)metadata.samplePosition, wireFreeSample);
+        wireFreeSample = start + metadata.numBytes * samplesPerByte;
+
+        if (metadata.numBytes == 1 && metadata.data[0] == 0xf8 && tick < numBlockTicks)
+        {
+            const auto error = (float)(std::abs(start - idealTickSamples[(size_t)tick++]) * 1.0e6 / sampleRate);
+            ++ticks;
+            sum += error;
+            worst = juce::jmax(worst, error);
+        }
+    }
+
+    wireFreeSample = juce::jmax(0.0, wireFreeSample - numSamples);
+
+    statTicks.store(ticks);
+    statSumMicroseconds.store(sum);
+    statMaxMicroseconds.store(worst);
+}
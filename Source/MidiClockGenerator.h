@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    MidiClockGenerator.h
+    Created: 20 Oct 2026 8:37:02pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TransportInfo.h"
+
+/*
+Generates MIDI clock for the pedal from the host transport, so it can replace
+the DAW's own clock output and share the port with tap tempo.
+
+Clock ticks (24 per quarter note) are placed on the sample nearest their PPQ
+position. Start, Stop, Continue and Song Position follow the transport;
+after a loop or locate the clock stops, points at the next 16th and
+continues, so the pedal stays on the grid.
+
+Tap tempo bursts send CC 93 on the next beats. A tap that would still be on
+the wire when a clock tick is due is moved to just after that tick, so taps
+never push the clock late.
+
+Jitter is measured by replaying each finished block through a model of a
+31250 baud DIN port: the time each clock byte would actually go out, behind
+whatever else is queued, against its ideal time.
+*/
+
+class MidiClockGenerator
+{
+public:
+    static constexpr int tapTempoCC = 93;
+    static constexpr int maxTaps = 8;
+    static constexpr int maxTicksPerBlock = 512;
+
+    struct JitterStats
+    {
+        int numTicks = 0;
+        float meanMicroseconds = 0.0f; // Mean absolute error
+        float maxMicroseconds = 0.0f;  // Worst absolute error
+    };
+
+    //=========================
+    // Message thread
+    void requestTapBurst(int numTaps) noexcept { tapRequest.store(juce::jlimit(1, maxTaps, numTaps)); }
+
+    JitterStats getJitterStats() const noexcept;
+    void resetJitterStats() noexcept { resetRequested.store(true); }
+
+    //=========================
+    // Audio thread
+    void prepare(double sampleRate) noexcept;
+
+    // Adds this block's clock, transport and tap messages. Call on an empty buffer,
+    // so clock bytes come before anything else on the same sample
+    void process(juce::MidiBuffer& midiMessages, const TransportInfo& transport, bool enabled, int midiChannel) noexcept;
+
+    // Replays the finished block through the port model and updates the jitter stats
+    void measureJitter(const juce::MidiBuffer& midiMessages, int numSamples) noexcept;
+
+private:
+    void stop(juce::MidiBuffer& midiMessages, int samplePosition) noexcept;
+    void addTaps(juce::MidiBuffer& midiMessages, const TransportInfo& transport, int midiChannel) noexcept;
+
+    double sampleRate = 44100.0;
+    double samplesPerByte = 44100.0 * 10.0 / 31250.0; // Start, 8 data and stop bit per byte
+
+    bool running = false;
+    juce::int64 nextTick = 0; // Index of the next clock tick, 24 per quarter note
+
+    // Ideal (fractional) sample of each tick sent in the current block, in send order
+    std::array<double, maxTicksPerBlock> idealTickSamples{};
+    int numBlockTicks = 0;
+
+    // Tap burst, as beats still to tap
+    std::atomic<int> tapRequest{ 0 };
+    int tapsRemaining = 0;
+    double nextTapPpq = 0.0;
+
+    // Port model, carried across blocks
+    double wireFreeSample = 0.0;
+
+    std::atomic<bool> resetRequested{ false };
+    std::atomic<int> statTicks{ 0 };
+    std::atomic<double> statSumMicroseconds{ 0.0 };
+    std::atomic<float> statMaxMicroseconds{ 0.0f };
+};
@@ -34,6 +34,44 @@ public:
         noteEditor.setInputRestrictions(3, "0123456789");
         addAndMakeVisible(noteEditor);
 
+        // Any channel uses the plain note mapping, a single channel adds a trigger with its own options
+        channelBox.addItem("Any Channel", 1);
+        for (int channel = 1; channel <= 16; ++channel)
+            channelBox.addItem("Channel " + juce::String(channel), channel + 1);
+        channelBox.setSelectedId(1, juce::dontSendNotification);
+        channelBox.onChange = [this] { updateTriggerOptions(); };
+        addAndMakeVisible(channelBox);
+
+        velocityBox.addItem("All Velocities", 1);
+        velocityBox.addItem("Soft (1-63)", 2);
+        velocityBox.addItem("Hard (64-127)", 3);
+        velocityBox.setSelectedId(1, juce::dontSendNotification);
+        addAndMakeVisible(velocityBox);
+
+        modeBox.addItem("Latch", 1);
+        modeBox.addItem("Momentary", 2);
+        modeBox.setSelectedId(1, juce::dontSendNotification);
+        addAndMakeVisible(modeBox);
+
+        // A trigger can recall part of the preset, on top of the global recall mask
+        recallButton.onClick = [this]()
+            {
+                auto menu = RecallMask::createMenu(recallMask, [safeThis = juce::Component::SafePointer<MidiLearnDialog>(this)](juce::uint32 mask)
+                    {
+                        if (safeThis == nullptr)
+                            return;
+
+                        safeThis->recallMask = mask;
+                        safeThis->updateRecallButton();
+                    });
+
+                menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&recallButton));
+            };
+        updateRecallButton();
+        addAndMakeVisible(recallButton);
+
+        updateTriggerOptions();
+
         // Learn Button
         learnButton.setButtonText("Learn");
         learnButton.onClick = [this]() { startLearning(); };
@@ -55,7 +93,7 @@ public:
         statusLabel.setFont(juce::Font(14.0f, juce::Font::bold));
         addAndMakeVisible(statusLabel);
 
-        setSize(400, 170);
+        setSize(400, 265);
     }
 
     ~MidiLearnDialog() override
@@ -96,7 +134,19 @@ public:
         area.removeFromTop(10);
 
         noteEditor.setBounds(area.removeFromTop(30).reduced(80, 0));
-        area.removeFromTop(20);
+        area.removeFromTop(10);
+
+        auto optionArea = area.removeFromTop(25);
+        const int optionWidth = (optionArea.getWidth() - 20) / 3;
+        channelBox.setBounds(optionArea.removeFromLeft(optionWidth));
+        optionArea.removeFromLeft(10);
+        velocityBox.setBounds(optionArea.removeFromLeft(optionWidth));
+        optionArea.removeFromLeft(10);
+        modeBox.setBounds(optionArea);
+        area.removeFromTop(10);
+
+        recallButton.setBounds(area.removeFromTop(25).reduced(60, 0));
+        area.removeFromTop(15);
 
         // Buttons
 
@@ -155,14 +205,17 @@ public:
         repaint();
     }
 
-    void midiNoteReceived(int noteNumber)
+    void midiNoteReceived(int noteNumber, int channel)
     {
         if (!isLearning)
             return;
 
-        // Update text editor
+        // Update text editor. A learned channel is only used if one was picked already
         noteEditor.setText(juce::String(noteNumber), false);
 
+        if (channelBox.getSelectedId() > 1)
+            channelBox.setSelectedId(channel + 1, juce::dontSendNotification);
+
         // Show Success
         statusLabel.setText("Learned Note: " + juce::String(noteNumber), juce::dontSendNotification);
         statusLabel.setColour(juce::Label::textColourId, juce::Colours::green);
@@ -191,10 +244,10 @@ private:
     void startListeningForMidi()
     {
         // This will be called from the audio thread via a callback
-        midiCallback = [this](int note) {
-            juce::MessageManager::callAsync([this, note]() {
+        midiCallback = [this](int note, int channel) {
+            juce::MessageManager::callAsync([this, note, channel]() {
                 if (isShowing())
-                    midiNoteReceived(note);
+                    midiNoteReceived(note, channel);
                 });
             };
     }
@@ -204,6 +257,19 @@ private:
         midiCallback = nullptr;
     }
 
+    void updateTriggerOptions()
+    {
+        const bool channelTrigger = channelBox.getSelectedId() > 1;
+        velocityBox.setEnabled(channelTrigger);
+        modeBox.setEnabled(channelTrigger);
+        recallButton.setEnabled(channelTrigger);
+    }
+
+    void updateRecallButton()
+    {
+        recallButton.setButtonText("Recall: " + RecallMask::describe(recallMask));
+    }
+
     void updateCancelButtonText()
     {
         if (originalNote >= 0)
@@ -231,13 +297,28 @@ private:
         {
             if (originalNote >= 0)
                 presetManager.clearMidiMapping(originalNote);
+            presetManager.clearNoteTriggers(presetFileToMap);
             closeDialog();
             return;
         }
 
         int note = noteText.getIntValue();
+        const int channel = channelBox.getSelectedId() - 1;
+
         if (note >= 0 && note <= 127)
-            presetManager.setMidiNoteForPreset(presetFileToMap, note);
+        {
+            if (channel == 0)
+            {
+                presetManager.setMidiNoteForPreset(presetFileToMap, note);
+            }
+            else
+            {
+                const int velocity = velocityBox.getSelectedId();
+                presetManager.setNoteTrigger(presetFileToMap, channel, note,
+                                             velocity == 3 ? 64 : 1, velocity == 2 ? 63 : 127,
+                                             modeBox.getSelectedId() == 2, recallMask);
+            }
+        }
      
         closeDialog();
     
@@ -259,6 +340,11 @@ private:
     juce::Label instructionsLabel;
     juce::Label statusLabel;
     juce::TextEditor noteEditor;
+    juce::ComboBox channelBox;
+    juce::ComboBox velocityBox;
+    juce::ComboBox modeBox;
+    juce::TextButton recallButton;
+    juce::uint32 recallMask = RecallMask::everything;
     juce::TextButton learnButton;
     juce::TextButton okButton;
     juce::TextButton cancelButton;
@@ -266,5 +352,5 @@ private:
     bool isLearning = false;
     float pulsePhase = 0.0f;
 
-    std::function<void(int)> midiCallback;
+    std::function<void(int, int)> midiCallback;
 };
@@ -0,0 +1,290 @@
+/*
+  ==============================================================================
+
+    MidiLearnMap.cpp
+    Created: 21 Oct 2026 9:02:27am
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "MidiLearnMap.h"
+
+MidiLearnMap::MidiLearnMap(const std::array<int, ParameterSnapshot::maxSlots>& maximums)
+    : slotMaximums(maximums),
+    pendingTable(std::make_unique<Table>()),
+    activeTable(std::make_unique<Table>())
+{
+    for (auto& value : pendingValues)
+        value.store(-1);
+
+    lastIncoming.fill(-1);
+    lastApplied.fill(-1);
+
+    startTimerHz(30);
+}
+
+MidiLearnMap::~MidiLearnMap()
+{
+    stopTimer();
+}
+
+void MidiLearnMap::setParameters(const std::array<juce::RangedAudioParameter*, ParameterSnapshot::maxSlots>& slotParameters)
+{
+    parameters = slotParameters;
+}
+
+std::vector<MidiLearnMap::Mapping> MidiLearnMap::getMappings() const
+{
+    const juce::ScopedLock sl(mappingLock);
+    return mappings;
+}
+
+std::optional<MidiLearnMap::Mapping> MidiLearnMap::findMappingForSlot(int slot) const
+{
+    const juce::ScopedLock sl(mappingLock);
+
+    for (const auto& mapping : mappings)
+    {
+        if (mapping.slot == slot)
+            return mapping;
+    }
+
+    return std::nullopt;
+}
+
+bool MidiLearnMap::isValid(const Mapping& mapping)
+{
+    return juce::isPositiveAndBelow(mapping.slot, ParameterSnapshot::maxSlots)
+        && juce::isPositiveAndBelow(mapping.channel - 1, 16) && juce::isPositiveAndBelow(mapping.ccNumber, 128);
+}
+
+void MidiLearnMap::assign(const Mapping& mapping)
+{
+    if (!isValid(mapping))
+        return;
+
+    {
+        const juce::ScopedLock sl(mappingLock);
+
+        mappings.erase(std::remove_if(mappings.begin(), mappings.end(), [&mapping](const Mapping& existing)
+            {
+                return existing.channel == mapping.channel && existing.ccNumber == mapping.ccNumber;
+            }), mappings.end());
+
+        if ((int)mappings.size() >= maxMappings)
+            return;
+
+        mappings.push_back(mapping);
+    }
+
+    compileTable();
+}
+
+void MidiLearnMap::updateMappingForSlot(int slot, const std::function<void(Mapping&)>& change)
+{
+    {
+        const juce::ScopedLock sl(mappingLock);
+
+        for (auto& mapping : mappings)
+        {
+            if (mapping.slot == slot)
+                change(mapping);
+        }
+    }
+
+    compileTable();
+}
+
+void MidiLearnMap::clearSlot(int slot)
+{
+    {
+        const juce::ScopedLock sl(mappingLock);
+        mappings.erase(std::remove_if(mappings.begin(), mappings.end(), [slot](const Mapping& mapping) { return mapping.slot == slot; }),
+                       mappings.end());
+    }
+
+    compileTable();
+}
+
+void MidiLearnMap::compileTable()
+{
+    auto table = std::make_unique<Table>();
+    {
+        const juce::ScopedLock sl(mappingLock);
+
+        for (size_t i = 0; i < mappings.size(); ++i)
+        {
+            const auto& mapping = mappings[i];
+            table->mappingFor[(size_t)((mapping.channel - 1) * 128 + mapping.ccNumber)] = (juce::int8)i;
+            table->slots[i] = (juce::uint8)mapping.slot;
+            table->pickup[i] = mapping.pickup;
+            mapping.curve.compile(table->luts[i].data(), lutSize, 127, slotMaximums[(size_t)mapping.slot]);
+        }
+    }
+
+    {
+        const juce::SpinLock::ScopedLockType lock(tableLock);
+        std::swap(pendingTable, table);
+        tableChanged.store(true);
+    }
+
+    // table now holds whatever was pending before and is freed here, off the audio thread
+}
+
+void MidiLearnMap::timerCallback()
+{
+    // Finish a learn the audio thread spotted
+    const int pair = learnedPair.exchange(-1);
+    const int slot = learningSlot.load();
+
+    if (pair >= 0 && slot >= 0)
+    {
+        learningSlot.store(-1);
+
+        Mapping mapping;
+        mapping.channel = pair / 128 + 1;
+        mapping.ccNumber = pair % 128;
+        mapping.slot = slot;
+
+        if (auto existing = findMappingForSlot(slot))
+        {
+            mapping.pickup = existing->pickup;
+            mapping.curve = existing->curve;
+        }
+
+        clearSlot(slot);
+        assign(mapping);
+    }
+
+    // Bring the knobs (and host automation) up to date with what the controllers sent
+    for (size_t i = 0; i < pendingValues.size(); ++i)
+    {
+        int value = pendingValues[i].load();
+        if (value < 0 || parameters[i] == nullptr)
+            continue;
+
+        parameters[i]->setValueNotifyingHost(parameters[i]->convertTo0to1((float)value));
+
+        // Only clear it if the audio thread hasn't sent something newer meanwhile
+        pendingValues[i].compare_exchange_strong(value, -1);
+    }
+}
+
+void MidiLearnMap::supersedePendingValue(int slot, int value) noexcept
+{
+    // Replacing rather than clearing it covers the timer being halfway through setting
+    // the old value: its compare_exchange then fails and the next tick sets this one
+    auto& pending = pendingValues[(size_t)slot];
+    int current = pending.load();
+
+    while (current >= 0 && !pending.compare_exchange_weak(current, value))
+    {
+    }
+}
+
+//==============================================================================
+void MidiLearnMap::process(const juce::MidiBuffer& midiMessages, float* knobValues, int numSlots) noexcept
+{
+    if (tableChanged.load())
+    {
+        const juce::SpinLock::ScopedTryLockType lock(tableLock);
+        if (lock.isLocked())
+        {
+            std::swap(activeTable, pendingTable);
+            tableChanged.store(false);
+            lastIncoming.fill(-1);
+            lastApplied.fill(-1);
+        }
+    }
+
+    const auto& table = *activeTable;
+    const bool learning = learningSlot.load() >= 0;
+
+    for (const auto metadata : midiMessages)
+    {
+        if (metadata.numBytes != 3 || (metadata.data[0] & 0xf0) != 0xb0)
+            continue;
+
+        const int pair = (metadata.data[0] & 0x0f) * 128 + (metadata.data[1] & 0x7f);
+        const int incoming = metadata.data[2] & 0x7f;
+
+        if (learning)
+        {
+            learnedPair.store(pair);
+            continue;
+        }
+
+        const int index = table.mappingFor[(size_t)pair];
+        if (index < 0)
+            continue;
+
+        const auto slot = (size_t)table.slots[(size_t)index];
+        if ((int)slot >= numSlots)
+            continue;
+
+        const int value = table.luts[(size_t)index][(size_t)incoming];
+        const int current = juce::roundToInt(knobValues[slot]);
+
+        if (table.pickup[(size_t)index] && current != lastApplied[(size_t)index])
+        {
+            // Something else moved the knob. Take over once the controller reaches or crosses it
+            const int previous = lastIncoming[(size_t)index] >= 0 ? table.luts[(size_t)index][(size_t)lastIncoming[(size_t)index]] : value;
+            lastIncoming[(size_t)index] = incoming;
+
+            const bool crossed = (previous - current) * (value - current) <= 0;
+            if (!crossed && std::abs(value - current) > 1)
+                continue;
+        }
+
+        lastIncoming[(size_t)index] = incoming;
+        lastApplied[(size_t)index] = value;
+        knobValues[slot] = (float)value;
+        pendingValues[slot].store(value);
+    }
+}
+
+//==============================================================================
+void MidiLearnMap::writeBinaryState(juce::OutputStream& out) const
+{
+    const auto current = getMappings();
+    out.writeCompressedInt((int)current.size());
+
+    for (const auto& mapping : current)
+    {
+        out.writeByte((char)mapping.channel);
+        out.writeByte((char)mapping.ccNumber);
+        out.writeByte((char)mapping.slot);
+        out.writeBool(mapping.pickup);
+        mapping.curve.write(out);
+    }
+}
+
+void MidiLearnMap::readBinaryState(juce::InputStream& in)
+{
+    {
+        const juce::ScopedLock sl(mappingLock);
+        mappings.clear();
+    }
+
+    const int count = juce::jlimit(0, maxMappings, in.readCompressedInt());
+
+    for (int i = 0; i < count && !in.isExhausted(); ++i)
+    {
+        Mapping mapping;
+        mapping.channel = in.readByte();
+        mapping.ccNumber = in.readByte();
+        mapping.slot = in.readByte();
+        mapping.pickup = in.readBool();
+        mapping.curve = ResponseCurve::read(in);
+
+        // A damaged state would index past the table, same checks as assign()
+        if (!isValid(mapping))
+            continue;
+
+        const juce::ScopedLock sl(mappingLock);
+        mappings.push_back(mapping);
+    }
+
+    compileTable();
+}
@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    MidiLearnMap.h
+    Created: 21 Oct 2026 9:02:27am
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterSnapshot.h"
+#include "ResponseCurve.h"
+
+/*
+Incoming CC learn: lets foot controllers and expression pedals drive the
+plugin's knobs, each channel/CC pair through its own range and curve.
+
+Mappings are compiled into a flat 16 x 128 table of mapping indices plus a
+128-entry lookup per mapping, swapped in like the macro tables, so handling
+an incoming CC is two array reads. With pickup on, a mapping only takes
+over once the controller passes the knob's current value.
+
+The audio thread never touches the parameters. It publishes each new value
+through an atomic per slot, which the processor uses straight away, and a
+timer on the message thread moves the knob (and host automation) to match.
+*/
+
+class MidiLearnMap : private juce::Timer
+{
+public:
+    static constexpr int maxMappings = 64;
+    static constexpr int lutSize = 128;
+
+    struct Mapping
+    {
+        int channel = 1; // 1-16
+        int ccNumber = 0;
+        int slot = 0;
+        bool pickup = false;
+        ResponseCurve curve;
+    };
+
+    // slotMaximums: top of each slot's raw range (127, or 5 for the module selects)
+    explicit MidiLearnMap(const std::array<int, ParameterSnapshot::maxSlots>& slotMaximums);
+    ~MidiLearnMap() override;
+
+    //=========================
+    // Message thread
+    void setParameters(const std::array<juce::RangedAudioParameter*, ParameterSnapshot::maxSlots>& slotParameters);
+
+    std::vector<Mapping> getMappings() const;
+    std::optional<Mapping> findMappingForSlot(int slot) const;
+    void assign(const Mapping& mapping); // Replaces whatever the channel/CC pair drove before
+    void updateMappingForSlot(int slot, const std::function<void(Mapping&)>& change);
+    void clearSlot(int slot);
+
+    // The next CC that arrives is assigned to slot
+    void startLearning(int slot) noexcept { learnedPair.store(-1); learningSlot.store(slot); }
+    void stopLearning() noexcept { learningSlot.store(-1); }
+    int getLearningSlot() const noexcept { return learningSlot.load(); }
+
+    void writeBinaryState(juce::OutputStream& out) const;
+    void readBinaryState(juce::InputStream& in);
+
+    //=========================
+    // Audio thread
+    // Reads the CCs in the block. knobValues are the slots' current raw values,
+    // used for pickup, and get the learned values written into them
+    void process(const juce::MidiBuffer& midiMessages, float* knobValues, int numSlots) noexcept;
+
+    // Learned value waiting to reach the slot's parameter, or -1
+    int getPendingValue(int slot) const noexcept { return pendingValues[(size_t)slot].load(); }
+
+    // The slot is being set to value by something else (e.g. a preset load), so a learned
+    // value still waiting must not land on top of it. Call before setting the parameter
+    void supersedePendingValue(int slot, int value) noexcept;
+
+private:
+    struct Table
+    {
+        std::array<juce::int8, 16 * 128> mappingFor; // channel * 128 + cc -> mapping index, -1 for none
+        std::array<juce::uint8, maxMappings> slots{};
+        std::array<bool, maxMappings> pickup{};
+        std::array<std::array<juce::uint8, lutSize>, maxMappings> luts{};
+
+        Table() { mappingFor.fill(-1); }
+    };
+
+    static bool isValid(const Mapping& mapping);
+    void compileTable();
+    void timerCallback() override;
+
+    const std::array<int, ParameterSnapshot::maxSlots> slotMaximums;
+    std::array<juce::RangedAudioParameter*, ParameterSnapshot::maxSlots> parameters{};
+
+    mutable juce::CriticalSection mappingLock;
+    std::vector<Mapping> mappings;
+
+    juce::SpinLock tableLock;
+    std::unique_ptr<Table> pendingTable;
+    std::atomic<bool> tableChanged{ false };
+
+    std::unique_ptr<Table> activeTable; // Audio thread only
+
+    // Pickup state per mapping, audio thread only. Reset whenever a new table comes in
+    std::array<int, maxMappings> lastIncoming{};
+    std::array<int, maxMappings> lastApplied{};
+
+    std::array<std::atomic<int>, ParameterSnapshot::maxSlots> pendingValues;
+
+    std::atomic<int> learningSlot{ -1 };
+    std::atomic<int> learnedPair{ -1 }; // (channel - 1) * 128 + cc, found by the audio thread
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiLearnMap)
+};
@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    MidiThruFilter.cpp
+    Created: 20 Oct 2026 10:15:48pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "MidiThruFilter.h"
+
+bool MidiThruFilter::passes(const juce::uint8* data, int numBytes) const noexcept
+{
+    if (numBytes <= 0)
+        return false;
+
+    const auto status = data[0];
+    int type = otherSystem;
+
+    if (status < 0xf0)
+    {
+        if ((channelMask.load() & (1 << (status & 0x0f))) == 0)
+            return false;
+
+        switch (status & 0xf0)
+        {
+            case 0x80:
+            case 0x90: type = notes; break;
+            case 0xb0: type = controllers; break;
+            case 0xc0: type = programChanges; break;
+            case 0xe0: type = pitchBend; break;
+            default:   type = pressure; break; // 0xa0, 0xd0
+        }
+    }
+    else if (status == 0xf0)
+    {
+        type = sysEx;
+    }
+    else if (status == 0xf2 || status == 0xf8 || status == 0xfa || status == 0xfb || status == 0xfc)
+    {
+        type = clock;
+    }
+
+    return (typeMask.load() & type) != 0;
+}
+
+//==============================================================================
+void MidiThruFilter::writeBinaryState(juce::OutputStream& out) const
+{
+    out.writeBool(isEnabled());
+    out.writeShort((short)getChannelMask());
+    out.writeByte((char)getTypeMask());
+}
+
+void MidiThruFilter::readBinaryState(juce::InputStream& in)
+{
+    setEnabled(in.readBool());
+    setChannelMask((juce::uint16)in.readShort());
+    setTypeMask((juce::uint8)in.readByte());
+}
+
+//==============================================================================
+void MidiThruFilter::prepare()
+{
+    thruEvents.ensureSize(reservedBytes);
+    mergedEvents.ensureSize(reservedBytes);
+}
+
+void MidiThruFilter::append(juce::MidiBuffer& buffer, const juce::MidiMessageMetadata& event) noexcept
+{
+    // Events arrive in sample order, so each one lands at the end. Going past the
+    // reserved storage grows it, which is rare and better than dropping input
+    buffer.addEvent(event.data, event.numBytes, event.samplePosition);
+}
+
+void MidiThruFilter::collect(const juce::MidiBuffer& input) noexcept
+{
+    thruEvents.clear();
+
+    if (!isEnabled())
+        return;
+
+    for (const auto event : input)
+    {
+        if (passes(event.data, event.numBytes))
+            append(thruEvents, event);
+    }
+}
+
+void MidiThruFilter::merge(juce::MidiBuffer& generated) noexcept
+{
+    if (thruEvents.isEmpty())
+        return;
+
+    mergedEvents.clear();
+
+    auto thru = thruEvents.cbegin();
+    const auto thruEnd = thruEvents.cend();
+
+    for (const auto event : generated)
+    {
+        for (; thru != thruEnd && (*thru).samplePosition < event.samplePosition; ++thru)
+            append(mergedEvents, *thru);
+
+        append(mergedEvents, event);
+    }
+
+    for (; thru != thruEnd; ++thru)
+        append(mergedEvents, *thru);
+
+    // Swapping hands the host the merged storage and keeps its old storage for the next block
+    generated.swapWith(mergedEvents);
+    mergedEvents.ensureSize(reservedBytes);
+    thruEvents.clear();
+}
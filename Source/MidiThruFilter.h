@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    MidiThruFilter.h
+    Created: 20 Oct 2026 10:15:48pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+Passes chosen parts of the plugin's MIDI input through to its output, so
+clock, notes for other gear or a foot controller can share the track with
+the generated CCs.
+
+collect() copies the allowed input events aside in one pass, before the
+processor clears the buffer. merge() then interleaves them with everything
+the processor generated, in sample order, into a second buffer that is
+swapped with the host's. Both buffers keep their storage between blocks,
+so after the first few blocks nothing is allocated.
+*/
+
+class MidiThruFilter
+{
+public:
+    enum TypeFlags
+    {
+        notes = 1 << 0,
+        controllers = 1 << 1,
+        programChanges = 1 << 2,
+        pitchBend = 1 << 3,
+        pressure = 1 << 4,    // Channel and poly aftertouch
+        clock = 1 << 5,       // Clock, start, stop, continue, song position
+        sysEx = 1 << 6,
+        otherSystem = 1 << 7, // Active sensing, reset, MTC and the rest
+        allTypes = 0xff
+    };
+
+    static constexpr int allChannels = 0xffff;
+    static constexpr int reservedBytes = 32768; // Storage kept per buffer, roughly 3000 short messages
+
+    // Safe from any thread
+    void setEnabled(bool shouldBeEnabled) noexcept { enabled.store(shouldBeEnabled); }
+    bool isEnabled() const noexcept { return enabled.load(); }
+    void setChannelMask(int mask) noexcept { channelMask.store(mask & allChannels); } // Bit n is channel n + 1
+    int getChannelMask() const noexcept { return channelMask.load(); }
+    void setTypeMask(int mask) noexcept { typeMask.store(mask & allTypes); }
+    int getTypeMask() const noexcept { return typeMask.load(); }
+
+    bool passes(const juce::uint8* data, int numBytes) const noexcept;
+
+    //=========================
+    // Message thread
+    void writeBinaryState(juce::OutputStream& out) const;
+    void readBinaryState(juce::InputStream& in);
+
+    //=========================
+    // Audio thread
+    void prepare();
+
+    // Copies the events that pass the filter. Call before the input is cleared
+    void collect(const juce::MidiBuffer& input) noexcept;
+
+    // Interleaves the collected events with generated, in sample order. Generated
+    // events go first on a shared sample. generated ends up holding the result
+    void merge(juce::MidiBuffer& generated) noexcept;
+
+private:
+    static void append(juce::MidiBuffer& buffer, const juce::MidiMessageMetadata& event) noexcept;
+
+    std::atomic<bool> enabled{ false };
+    std::atomic<int> channelMask{ allChannels };
+    std::atomic<int> typeMask{ allTypes };
+
+    juce::MidiBuffer thruEvents;
+    juce::MidiBuffer mergedEvents;
+};
@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+    MorphEngine.cpp
+    Created: 19 Oct 2026 6:14:27pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "MorphEngine.h"
+
+MorphEngine::MorphEngine(juce::uint32 steppedSlotMask) : steppedSlots(steppedSlotMask)
+{
+}
+
+void MorphEngine::setSource(Source source, const ParameterSnapshot& snapshot, const juce::String& name)
+{
+    {
+        const juce::ScopedLock sl(sourceLock);
+        snapshots[(size_t)source] = snapshot;
+        names[(size_t)source] = name;
+        hasSnapshot[(size_t)source] = true;
+    }
+
+    compileTable();
+}
+
+void MorphEngine::clearSource(Source source)
+{
+    {
+        const juce::ScopedLock sl(sourceLock);
+        snapshots[(size_t)source] = {};
+        names[(size_t)source] = {};
+        hasSnapshot[(size_t)source] = false;
+    }
+
+    compileTable();
+}
+
+bool MorphEngine::hasSource(Source source) const
+{
+    const juce::ScopedLock sl(sourceLock);
+    return hasSnapshot[(size_t)source];
+}
+
+juce::String MorphEngine::getSourceName(Source source) const
+{
+    const juce::ScopedLock sl(sourceLock);
+    return names[(size_t)source];
+}
+
+bool MorphEngine::isReady() const
+{
+    const juce::ScopedLock sl(sourceLock);
+    return hasSnapshot[sourceA] && hasSnapshot[sourceB];
+}
+
+void MorphEngine::compileTable()
+{
+    Table table;
+    {
+        const juce::ScopedLock sl(sourceLock);
+        table.valid = hasSnapshot[sourceA] && hasSnapshot[sourceB];
+
+        for (size_t slot = 0; slot < table.start.size(); ++slot)
+        {
+            table.start[slot] = (float)snapshots[sourceA].values[slot];
+            table.target[slot] = (float)snapshots[sourceB].values[slot];
+            table.delta[slot] = table.target[slot] - table.start[slot];
+        }
+    }
+
+    const juce::SpinLock::ScopedLockType lock(tableLock);
+    pendingTable = table;
+    tableChanged.store(true);
+}
+
+bool MorphEngine::process(float morph, float threshold, float* values, int numSlots) noexcept
+{
+    // Take the new table if the message thread isn't writing it right now,
+    // otherwise keep going with the old one and try again next block
+    if (tableChanged.load())
+    {
+        const juce::SpinLock::ScopedTryLockType lock(tableLock);
+        if (lock.isLocked())
+        {
+            activeTable = pendingTable;
+            tableChanged.store(false);
+        }
+    }
+
+    if (!activeTable.valid)
+        return false;
+
+    numSlots = juce::jmin(numSlots, ParameterSnapshot::maxSlots);
+    const float amount = juce::jlimit(0.0f, 1.0f, morph);
+
+    // Continuous slots: start + delta * amount
+    juce::FloatVectorOperations::copy(values, activeTable.start.data(), numSlots);
+    juce::FloatVectorOperations::addWithMultiply(values, activeTable.delta.data(), amount, numSlots);
+
+    // Stepped slots switch over in one go
+    const auto& stepped = amount >= threshold ? activeTable.target : activeTable.start;
+    for (int slot = 0; slot < numSlots; ++slot)
+    {
+        if ((steppedSlots >> slot) & 1u)
+            values[slot] = stepped[(size_t)slot];
+    }
+
+    return true;
+}
+
+void MorphEngine::writeBinaryState(juce::OutputStream& out) const
+{
+    const juce::ScopedLock sl(sourceLock);
+
+    for (size_t source = 0; source < numSources; ++source)
+    {
+        out.writeBool(hasSnapshot[source]);
+        out.writeString(names[source]);
+        out.write(snapshots[source].values.data(), snapshots[source].values.size());
+    }
+}
+
+void MorphEngine::readBinaryState(juce::InputStream& in)
+{
+    {
+        const juce::ScopedLock sl(sourceLock);
+
+        for (size_t source = 0; source < numSources; ++source)
+        {
+            hasSnapshot[source] = in.readBool();
+            names[source] = in.readString();
+
+            if (in.read(snapshots[source].values.data(), (int)snapshots[source].values.size()) != (int)snapshots[source].values.size())
+                hasSnapshot[source] = false;
+        }
+    }
+
+    compileTable();
+}
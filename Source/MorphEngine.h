@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    MorphEngine.h
+    Created: 19 Oct 2026 6:14:27pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterSnapshot.h"
+
+/*
+Morphs every CC between two parameter snapshots, A and B.
+Continuous slots are interpolated, stepped slots (module selects, bypass,
+modes) switch from A to B once the morph amount reaches the threshold.
+
+A and B are set on the message thread, which compiles them into a table of
+start values and deltas. The audio thread picks up the new table when it can
+and never allocates or blocks.
+*/
+
+class MorphEngine
+{
+public:
+    enum Source
+    {
+        sourceA = 0,
+        sourceB,
+        numSources
+    };
+
+    explicit MorphEngine(juce::uint32 steppedSlotMask);
+
+    //=========================
+    // Message thread
+    void setSource(Source source, const ParameterSnapshot& snapshot, const juce::String& name);
+    void clearSource(Source source);
+    bool hasSource(Source source) const;
+    juce::String getSourceName(Source source) const;
+
+    // Both sources are set, so process() will produce values
+    bool isReady() const;
+
+    void writeBinaryState(juce::OutputStream& out) const;
+    void readBinaryState(juce::InputStream& in);
+
+    //=========================
+    // Audio thread. Overwrites values[0..numSlots) with the morphed raw values.
+    // Returns false (values untouched) until both sources are set
+    bool process(float morph, float threshold, float* values, int numSlots) noexcept;
+
+private:
+    struct Table
+    {
+        std::array<float, ParameterSnapshot::maxSlots> start{};
+        std::array<float, ParameterSnapshot::maxSlots> delta{};
+        std::array<float, ParameterSnapshot::maxSlots> target{};
+        bool valid = false;
+    };
+
+    void compileTable();
+
+    const juce::uint32 steppedSlots;
+
+    // Message thread copies
+    mutable juce::CriticalSection sourceLock;
+    std::array<ParameterSnapshot, numSources> snapshots;
+    std::array<juce::String, numSources> names;
+    std::array<bool, numSources> hasSnapshot{};
+
+    // Handed over to the audio thread under a try-lock
+    juce::SpinLock tableLock;
+    Table pendingTable;
+    std::atomic<bool> tableChanged{ false };
+
+    Table activeTable; // Audio thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MorphEngine)
+};
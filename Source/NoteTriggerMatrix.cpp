@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    NoteTriggerMatrix.cpp
+    Created: 21 Oct 2026 2:44:09pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "NoteTriggerMatrix.h"
+
+bool NoteTriggerMatrix::isValidCell(int channel, int note) noexcept
+{
+    return juce::isPositiveAndBelow(channel - 1, numChannels) && juce::isPositiveAndBelow(note, numNotes);
+}
+
+const NoteTriggerMatrix::Layer* NoteTriggerMatrix::find(int channel, int note, int velocity) const noexcept
+{
+    if (!isValidCell(channel, note))
+        return nullptr;
+
+    const auto* cell = layers.data() + cellIndex(channel, note);
+
+    for (int i = 0; i < layersPerCell; ++i)
+    {
+        if (cell[i].isUsed() && cell[i].contains(velocity))
+            return cell + i;
+    }
+
+    return nullptr;
+}
+
+bool NoteTriggerMatrix::hasTriggers(int channel, int note) const noexcept
+{
+    if (!isValidCell(channel, note))
+        return false;
+
+    const auto* cell = layers.data() + cellIndex(channel, note);
+    return std::any_of(cell, cell + layersPerCell, [](const Layer& layer) { return layer.isUsed(); });
+}
+
+bool NoteTriggerMatrix::setLayer(int channel, int note, const Layer& layer) noexcept
+{
+    if (!isValidCell(channel, note) || !layer.isUsed() || layer.velocityLow > layer.velocityHigh)
+        return false;
+
+    auto* cell = layers.data() + cellIndex(channel, note);
+    Layer* target = nullptr;
+
+    for (int i = 0; i < layersPerCell; ++i)
+    {
+        if (cell[i].isUsed() && cell[i].velocityLow == layer.velocityLow && cell[i].velocityHigh == layer.velocityHigh)
+        {
+            target = cell + i;
+            break;
+        }
+
+        if (!cell[i].isUsed() && target == nullptr)
+            target = cell + i;
+    }
+
+    if (target == nullptr)
+        return false;
+
+    *target = layer;
+    return true;
+}
+
+void NoteTriggerMatrix::clearCell(int channel, int note) noexcept
+{
+    if (!isValidCell(channel, note))
+        return;
+
+    auto* cell = layers.data() + cellIndex(channel, note);
+    std::fill(cell, cell + layersPerCell, Layer());
+}
+
+void NoteTriggerMatrix::clearPreset(int presetId) noexcept
+{
+    for (auto& layer : layers)
+    {
+        if (layer.presetId == presetId)
+            layer = Layer();
+    }
+}
+
+void NoteTriggerMatrix::clearAll() noexcept
+{
+    layers.fill(Layer());
+}
+
+bool NoteTriggerMatrix::removeUnless(const std::function<bool(int presetId)>& presetExists)
+{
+    bool removed = false;
+
+    for (auto& layer : layers)
+    {
+        if (layer.isUsed() && !presetExists(layer.presetId))
+        {
+            layer = Layer();
+            removed = true;
+        }
+    }
+
+    return removed;
+}
+
+int NoteTriggerMatrix::getNumLayersForPreset(int presetId) const noexcept
+{
+    return (int)std::count_if(layers.begin(), layers.end(), [presetId](const Layer& layer) { return layer.isUsed() && layer.presetId == presetId; });
+}
+
+//==============================================================================
+void NoteTriggerMatrix::write(juce::OutputStream& out) const
+{
+    const int numUsed = (int)std::count_if(layers.begin(), layers.end(), [](const Layer& layer) { return layer.isUsed(); });
+    out.writeCompressedInt(numUsed);
+
+    // Channel/note cell, preset, velocity range and mode: 6 bytes per layer in use,
+    // plus 4 for a recall mask when it isn't everything (flagged in the low velocity's top bit)
+    for (size_t i = 0; i < layers.size(); ++i)
+    {
+        const auto& layer = layers[i];
+        if (!layer.isUsed())
+            continue;
+
+        const bool hasMask = layer.recallMask != RecallMask::everything;
+
+        out.writeShort((short)(i / layersPerCell));
+        out.writeShort(layer.presetId);
+        out.writeByte((char)((layer.velocityLow & 0x7f) | (hasMask ? 0x80 : 0)));
+        out.writeByte((char)((layer.velocityHigh & 0x7f) | (layer.momentary ? 0x80 : 0)));
+
+        if (hasMask)
+            out.writeInt((int)layer.recallMask);
+    }
+}
+
+void NoteTriggerMatrix::read(juce::InputStream& in)
+{
+    clearAll();
+
+    const int numUsed = in.readCompressedInt();
+
+    for (int i = 0; i < numUsed && !in.isExhausted(); ++i)
+    {
+        const int cell = (juce::uint16)in.readShort();
+
+        Layer layer;
+        layer.presetId = (juce::int16)in.readShort();
+
+        const auto low = (juce::uint8)in.readByte();
+        layer.velocityLow = (juce::uint8)(low & 0x7f);
+
+        const auto high = (juce::uint8)in.readByte();
+        layer.velocityHigh = (juce::uint8)(high & 0x7f);
+        layer.momentary = (high & 0x80) != 0;
+
+        if ((low & 0x80) != 0)
+            layer.recallMask = (juce::uint32)in.readInt();
+
+        if (cell < numChannels * numNotes)
+            setLayer(cell / numNotes + 1, cell % numNotes, layer);
+    }
+}
@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    NoteTriggerMatrix.h
+    Created: 21 Oct 2026 2:44:09pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "RecallMask.h"
+
+/*
+Channel x note -> preset triggers, for controllers that send the same notes
+on several channels.
+
+Every channel/note cell holds up to four velocity layers, each pointing at a
+preset by its program number (see PresetCatalog). A latched layer just loads
+its preset; a momentary one loads it while the note is held and returns to
+the previous sound on release. Each layer can also carry a recall mask, so a
+pad can recall just one column of a preset.
+
+Layers sit in one flat array, so a lookup is an indexed load plus a scan of
+at most four entries. Only the layers in use are written out.
+*/
+
+class NoteTriggerMatrix
+{
+public:
+    static constexpr int numChannels = 16;
+    static constexpr int numNotes = 128;
+    static constexpr int layersPerCell = 4;
+
+    struct Layer
+    {
+        juce::int16 presetId = -1; // Program number, -1 for an unused layer
+        juce::uint8 velocityLow = 1;
+        juce::uint8 velocityHigh = 127;
+        bool momentary = false;
+        juce::uint32 recallMask = RecallMask::everything;
+
+        bool isUsed() const noexcept { return presetId >= 0; }
+        bool contains(int velocity) const noexcept { return velocity >= velocityLow && velocity <= velocityHigh; }
+    };
+
+    NoteTriggerMatrix() = default;
+
+    // channel is 1-16. Returns nullptr if no layer covers the velocity
+    const Layer* find(int channel, int note, int velocity) const noexcept;
+    bool hasTriggers(int channel, int note) const noexcept;
+
+    // Replaces a layer with the same velocity range, else takes a free one.
+    // Returns false if all four are in use
+    bool setLayer(int channel, int note, const Layer& layer) noexcept;
+    void clearCell(int channel, int note) noexcept;
+    void clearPreset(int presetId) noexcept;
+    void clearAll() noexcept;
+
+    // Removes layers whose preset no longer exists. Returns true if any were removed
+    bool removeUnless(const std::function<bool(int presetId)>& presetExists);
+
+    int getNumLayersForPreset(int presetId) const noexcept;
+
+    void write(juce::OutputStream& out) const;
+    void read(juce::InputStream& in);
+
+private:
+    static int cellIndex(int channel, int note) noexcept { return ((channel - 1) * numNotes + note) * layersPerCell; }
+    static bool isValidCell(int channel, int note) noexcept;
+
+    std::array<Layer, numChannels * numNotes * layersPerCell> layers{};
+};
@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+    OutputCurves.cpp
+    Created: 19 Oct 2026 10:41:03pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "OutputCurves.h"
+
+OutputCurves::OutputCurves(juce::uint32 modules)
+    : moduleSlots(modules),
+    pendingTable(std::make_unique<Table>()),
+    activeTable(std::make_unique<Table>())
+{
+    // Start with the built-in tables so the audio thread never sees an empty one
+    compileTable();
+    std::swap(activeTable, pendingTable);
+    tableChanged.store(false);
+}
+
+void OutputCurves::setCurve(int slot, const ResponseCurve& curve)
+{
+    if (!juce::isPositiveAndBelow(slot, ParameterSnapshot::maxSlots))
+        return;
+
+    {
+        const juce::ScopedLock sl(curveLock);
+        curves[(size_t)slot] = curve;
+    }
+
+    compileTable();
+}
+
+void OutputCurves::resetCurve(int slot)
+{
+    if (!juce::isPositiveAndBelow(slot, ParameterSnapshot::maxSlots))
+        return;
+
+    {
+        const juce::ScopedLock sl(curveLock);
+        curves[(size_t)slot].reset();
+    }
+
+    compileTable();
+}
+
+std::optional<ResponseCurve> OutputCurves::getCurve(int slot) const
+{
+    if (!juce::isPositiveAndBelow(slot, ParameterSnapshot::maxSlots))
+        return std::nullopt;
+
+    const juce::ScopedLock sl(curveLock);
+    return curves[(size_t)slot];
+}
+
+void OutputCurves::compileTable()
+{
+    auto table = std::make_unique<Table>();
+    {
+        const juce::ScopedLock sl(curveLock);
+
+        for (size_t slot = 0; slot < curves.size(); ++slot)
+        {
+            auto& lut = table->luts[slot];
+            const bool isModule = (moduleSlots >> slot) & 1u;
+            const int inputMax = isModule ? 5 : 127;
+
+            if (curves[slot])
+            {
+                curves[slot]->compile(lut.data(), lutSize, inputMax, 127);
+            }
+            else
+            {
+                // Built-in: modules step through the device's 0, 22, 44 ... 110 positions,
+                // everything else is sent as it is
+                for (int i = 0; i < lutSize; ++i)
+                    lut[(size_t)i] = (juce::uint8)(isModule ? juce::jmin(i, inputMax) * 22 : i);
+            }
+        }
+    }
+
+    const juce::SpinLock::ScopedLockType lock(tableLock);
+    std::swap(pendingTable, table);
+    tableChanged.store(true);
+}
+
+void OutputCurves::update() noexcept
+{
+    if (!tableChanged.load())
+        return;
+
+    const juce::SpinLock::ScopedTryLockType lock(tableLock);
+    if (lock.isLocked())
+    {
+        std::swap(activeTable, pendingTable);
+        tableChanged.store(false);
+    }
+}
+
+//==============================================================================
+juce::ValueTree OutputCurves::toValueTree() const
+{
+    juce::ValueTree tree("Curves");
+    const juce::ScopedLock sl(curveLock);
+
+    for (size_t slot = 0; slot < curves.size(); ++slot)
+    {
+        if (!curves[slot])
+            continue;
+
+        juce::ValueTree child("Curve");
+        child.setProperty("slot", (int)slot, nullptr);
+        curves[slot]->writeToValueTree(child);
+        tree.appendChild(child, nullptr);
+    }
+
+    return tree;
+}
+
+void OutputCurves::fromValueTree(const juce::ValueTree& tree)
+{
+    {
+        const juce::ScopedLock sl(curveLock);
+
+        for (auto& curve : curves)
+            curve.reset();
+
+        for (const auto& child : tree)
+        {
+            const int slot = child.getProperty("slot", -1);
+            if (juce::isPositiveAndBelow(slot, ParameterSnapshot::maxSlots))
+                curves[(size_t)slot] = ResponseCurve::fromValueTree(child);
+        }
+    }
+
+    compileTable();
+}
+
+void OutputCurves::writeBinaryState(juce::OutputStream& out) const
+{
+    const juce::ScopedLock sl(curveLock);
+
+    juce::uint32 mask = 0;
+    for (size_t slot = 0; slot < curves.size(); ++slot)
+    {
+        if (curves[slot])
+            mask |= 1u << slot;
+    }
+
+    // Mask of slots with a curve, then those curves in slot order
+    out.writeInt((int)mask);
+
+    for (auto& curve : curves)
+    {
+        if (curve)
+            curve->write(out);
+    }
+}
+
+void OutputCurves::readBinaryState(juce::InputStream& in)
+{
+    {
+        const juce::ScopedLock sl(curveLock);
+        const auto mask = (juce::uint32)in.readInt();
+
+        for (size_t slot = 0; slot < curves.size(); ++slot)
+        {
+            curves[slot].reset();
+
+            if (((mask >> slot) & 1u) && !in.isExhausted())
+                curves[slot] = ResponseCurve::read(in);
+        }
+    }
+
+    compileTable();
+}
@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    OutputCurves.h
+    Created: 19 Oct 2026 10:41:03pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterSnapshot.h"
+#include "ResponseCurve.h"
+
+/*
+Turns a slot's raw value into the CC value sent to the device, through one
+128-entry lookup table per slot. Slots without a user curve send their raw
+value unchanged, module selects use the built-in rawValue * 22 table.
+
+Curves are edited on the message thread; the compiled tables are swapped in
+by the audio thread at the start of each block without allocating.
+*/
+
+class OutputCurves
+{
+public:
+    static constexpr int lutSize = 128;
+
+    // moduleSlots: bit per slot that is a 0-5 module select
+    explicit OutputCurves(juce::uint32 moduleSlots);
+
+    //=========================
+    // Message thread
+    void setCurve(int slot, const ResponseCurve& curve);
+    void resetCurve(int slot);
+    std::optional<ResponseCurve> getCurve(int slot) const;
+
+    juce::ValueTree toValueTree() const;
+    void fromValueTree(const juce::ValueTree& tree);
+    void writeBinaryState(juce::OutputStream& out) const;
+    void readBinaryState(juce::InputStream& in);
+
+    //=========================
+    // Audio thread
+    void update() noexcept; // Picks up edited tables, call once per block
+
+    int getCCValue(int slot, int rawValue) const noexcept
+    {
+        return activeTable->luts[(size_t)slot][(size_t)juce::jlimit(0, lutSize - 1, rawValue)];
+    }
+
+private:
+    struct Table
+    {
+        std::array<std::array<juce::uint8, lutSize>, ParameterSnapshot::maxSlots> luts{};
+    };
+
+    void compileTable();
+
+    const juce::uint32 moduleSlots;
+
+    mutable juce::CriticalSection curveLock;
+    std::array<std::optional<ResponseCurve>, ParameterSnapshot::maxSlots> curves;
+
+    juce::SpinLock tableLock;
+    std::unique_ptr<Table> pendingTable;
+    std::atomic<bool> tableChanged{ false };
+
+    std::unique_ptr<Table> activeTable; // Audio thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OutputCurves)
+};
@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    ParameterHistory.cpp
+    Created: 22 Oct 2026 3:18:52pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "ParameterHistory.h"
+#include "PluginProcessor.h"
+
+ParameterHistory::ParameterHistory(ChromaConsoleControllerAudioProcessor& p) : processor(p)
+{
+    // The first step is taken once the message loop runs
+    triggerAsyncUpdate();
+}
+
+ParameterHistory::~ParameterHistory()
+{
+    cancelPendingUpdate();
+    stopTimer();
+}
+
+void ParameterHistory::gestureChanged(bool gestureIsStarting) noexcept
+{
+    if (gestureIsStarting)
+    {
+        activeGestures.fetch_add(1);
+        return;
+    }
+
+    // A drag's values are one step, taken once every knob has been let go
+    if (activeGestures.fetch_sub(1) <= 1)
+    {
+        activeGestures.store(0);
+        requestCheckpoint();
+    }
+}
+
+void ParameterHistory::requestCheckpoint() noexcept
+{
+    checkpointTicks.store(0);
+    checkpointRequested.store(true);
+    triggerAsyncUpdate();
+}
+
+void ParameterHistory::requestReset() noexcept
+{
+    resetRequested.store(true);
+    triggerAsyncUpdate();
+}
+
+//==============================================================================
+bool ParameterHistory::undo()
+{
+    if (!canUndo())
+        return false;
+
+    --position;
+    restore();
+    return true;
+}
+
+bool ParameterHistory::redo()
+{
+    if (!canRedo())
+        return false;
+
+    ++position;
+    restore();
+    return true;
+}
+
+void ParameterHistory::restore()
+{
+    // Anything still waiting to be recorded belonged to the step being left
+    checkpointRequested.store(false);
+
+    const auto& values = stepAt(position);
+    processor.applySnapshot(values);
+    lastSeenHash = values.getHash();
+}
+
+void ParameterHistory::push(const ParameterSnapshot& values)
+{
+    // A new step drops anything that could have been redone
+    numSteps = position + 1;
+
+    if (numSteps == capacity)
+        oldest = (oldest + 1) % capacity;
+    else
+        ++numSteps;
+
+    position = numSteps - 1;
+    stepAt(position) = values;
+}
+
+void ParameterHistory::handleAsyncUpdate()
+{
+    // Changes are picked up at the timer's rate, not once per parameter
+    if (!isTimerRunning())
+        startTimerHz(20);
+}
+
+void ParameterHistory::timerCallback()
+{
+    if (resetRequested.exchange(false))
+    {
+        numSteps = 0;
+        position = -1;
+    }
+
+    // Nothing is recorded mid-drag, the whole gesture lands as one step when it ends
+    if (activeGestures.load() > 0)
+    {
+        stopTimer();
+        return;
+    }
+
+    // O(1) check before anything is copied
+    const auto hash = processor.getStateHash();
+    if (numSteps > 0 && hash == lastSeenHash && !checkpointRequested.load())
+    {
+        stopTimer();
+        return;
+    }
+
+    lastSeenHash = hash;
+    const auto values = processor.captureSnapshot();
+
+    if (numSteps == 0)
+    {
+        push(values);
+        return;
+    }
+
+    // A checkpoint waits for the change it was asked for, a load on the audio thread may not have
+    // landed yet. If nothing has changed after a few ticks there is nothing to wait for, and a
+    // later change by automation mustn't become a step of its own
+    auto& current = stepAt(position);
+    if (values == current)
+    {
+        if (checkpointRequested.load() && checkpointTicks.fetch_add(1) + 1 >= maxCheckpointTicks)
+            checkpointRequested.store(false);
+
+        return;
+    }
+
+    if (checkpointRequested.exchange(false))
+        push(values);
+    else
+        current = values;
+}
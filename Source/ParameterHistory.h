@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    ParameterHistory.h
+    Created: 22 Oct 2026 3:18:52pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterSnapshot.h"
+
+class ChromaConsoleControllerAudioProcessor;
+
+/*
+Undo/redo for the CC parameters, in place of an UndoManager on the
+parameter tree.
+
+Steps are 32-byte ParameterSnapshots in a fixed ring, so memory stays the
+same however long the session runs; once full, the oldest step is dropped.
+Undo and redo move an index and apply the step, which only changes (and
+sends CCs for) the parameters that differ.
+
+A knob drag becomes one step when its gesture ends, and a preset load
+becomes one step. Changes nobody made by hand (host automation, MIDI learn
+controllers, A/B and audition) don't add steps; they update the newest one,
+so undoing a drag goes back to the values it actually started from.
+
+The ring is only touched on the message thread. Other threads just set
+flags and post an update, which starts a timer that picks them up. The
+timer stops again once there is nothing left to record, so an idle
+instance (with or without an editor) doesn't wake up at all.
+*/
+
+class ParameterHistory : private juce::Timer,
+    private juce::AsyncUpdater
+{
+public:
+    static constexpr int capacity = 256;
+
+    explicit ParameterHistory(ChromaConsoleControllerAudioProcessor& processor);
+    ~ParameterHistory() override;
+
+    //=========================
+    // Any thread
+    void gestureChanged(bool gestureIsStarting) noexcept;
+    void valuesChanged() noexcept { triggerAsyncUpdate(); } // A CC parameter moved
+    void requestCheckpoint() noexcept; // The next change is a step of its own
+    void requestReset() noexcept; // State restored, start over
+
+    //=========================
+    // Message thread
+    bool undo();
+    bool redo();
+    bool canUndo() const { return position > 0; }
+    bool canRedo() const { return position < numSteps - 1; }
+
+private:
+    void handleAsyncUpdate() override;
+    void timerCallback() override;
+    void push(const ParameterSnapshot& values);
+    ParameterSnapshot& stepAt(int index) { return steps[(size_t)((oldest + index) % capacity)]; }
+    void restore();
+
+    ChromaConsoleControllerAudioProcessor& processor;
+
+    std::array<ParameterSnapshot, capacity> steps;
+    int oldest = 0;    // Ring index of the oldest step
+    int numSteps = 0;
+    int position = -1; // Current step, counted from the oldest
+    juce::uint64 lastSeenHash = 0;
+
+    std::atomic<int> activeGestures{ 0 };
+    std::atomic<bool> checkpointRequested{ false };
+    std::atomic<int> checkpointTicks{ 0 }; // Ticks the checkpoint has waited for its change
+
+    // A load of the values already there never lands, so its checkpoint runs out after this
+    static constexpr int maxCheckpointTicks = 10;
+    std::atomic<bool> resetRequested{ true };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterHistory)
+};
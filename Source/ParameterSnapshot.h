@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    ParameterSnapshot.h
+    Created: 19 Oct 2026 2:31:05pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+Compact copy of every CC parameter value.
+One byte per slot, slots follow the order of ccConfigurations.
+Values are the raw parameter values (0-127, or 0-5 for the module selects),
+not the CC values sent to the device.
+*/
+
+struct ParameterSnapshot
+{
+    static constexpr int maxSlots = 32;
+
+    std::array<juce::uint8, maxSlots> values{};
+
+    // Fingerprint is the XOR of one key per (slot, value) pair, so a single
+    // parameter change can update a running hash in O(1):
+    //     hash ^= getKey(slot, oldValue) ^ getKey(slot, newValue)
+    static juce::uint64 getKey(int slot, int value) noexcept
+    {
+        // splitmix64 finaliser, good enough spread for 32 x 256 inputs
+        auto x = ((juce::uint64)(slot & 0xff) << 8 | (juce::uint64)(value & 0xff)) + 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    juce::uint64 getHash() const noexcept
+    {
+        juce::uint64 hash = 0;
+        for (int slot = 0; slot < maxSlots; ++slot)
+            hash ^= getKey(slot, values[(size_t)slot]);
+        return hash;
+    }
+
+    bool operator==(const ParameterSnapshot& other) const noexcept { return values == other.values; }
+    bool operator!=(const ParameterSnapshot& other) const noexcept { return values != other.values; }
+};
@@ -35,7 +35,7 @@ ChromaConsoleControllerAudioProcessorEditor::ChromaConsoleControllerAudioProcess
     audioProcessor(p),
     channelAttachment(p.parameters, "midiChannel", channelSelector),
     updateAttachment(p.parameters, "updateValues", updateButton),
-    presetBrowser(p.getPresetManager(), p.getPresetMidiHandler()),
+    presetBrowser(p.getPresetManager(), p.getPresetMidiHandler(), p.getSetlistPlayer(), p.getPresetCompare()),
     updateChecker(this)
 {    
     setLookAndFeel(&lnf);
@@ -84,6 +84,26 @@ ChromaConsoleControllerAudioProcessorEditor::ChromaConsoleControllerAudioProcess
         autoUpdateButton.setButtonText(newState ? "Auto-Update: On" : "Auto-Update: Off");
         };
 
+    // Setup gesture recorder button
+    addAndMakeVisible(gestureButton);
+    gestureButton.onClick = [this]() { showGestureMenu(); };
+    updateGestureButton();
+
+    // Setup MIDI clock and thru button
+    addAndMakeVisible(midiButton);
+    midiButton.setButtonText("MIDI");
+    midiButton.onClick = [this]() { showMidiMenu(); };
+
+    // Parameter undo/redo, also on Ctrl/Cmd+Z and Ctrl/Cmd+Shift+Z
+    addAndMakeVisible(undoButton);
+    undoButton.setButtonText("Undo");
+    undoButton.onClick = [this]() { audioProcessor.getParameterHistory().undo(); };
+
+    addAndMakeVisible(redoButton);
+    redoButton.setButtonText("Redo");
+    redoButton.onClick = [this]() { audioProcessor.getParameterHistory().redo(); };
+    setWantsKeyboardFocus(true);
+
 	// Check for updates on startup if enabled
     if (getAutoCheckForUpdates() && !audioProcessor.hasCheckedForUpdates)
     {
@@ -268,6 +288,26 @@ void ChromaConsoleControllerAudioProcessorEditor::paint(juce::Graphics& g)
     //setLAF();
 }
 
+bool ChromaConsoleControllerAudioProcessorEditor::keyPressed(const juce::KeyPress& key)
+{
+    auto& history = audioProcessor.getParameterHistory();
+
+    if (key == juce::KeyPress('z', juce::ModifierKeys::commandModifier, 0))
+    {
+        history.undo();
+        return true;
+    }
+
+    if (key == juce::KeyPress('z', juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier, 0)
+        || key == juce::KeyPress('y', juce::ModifierKeys::commandModifier, 0))
+    {
+        history.redo();
+        return true;
+    }
+
+    return false;
+}
+
 void ChromaConsoleControllerAudioProcessorEditor::resized()
 {
     auto area = getLocalBounds().reduced(padding);
@@ -283,6 +323,11 @@ void ChromaConsoleControllerAudioProcessorEditor::resized()
     // Header area
     auto headerArea = area.removeFromTop(headerHeight);
     channelSelector.setBounds(headerArea.removeFromRight(150));
+    headerArea.removeFromRight(5);
+    redoButton.setBounds(headerArea.removeFromRight(50));
+    headerArea.removeFromRight(5);
+    undoButton.setBounds(headerArea.removeFromRight(50));
+    headerArea.removeFromRight(5);
     updateButton.setBounds(headerArea.removeFromLeft(150));
     headerArea.removeFromLeft(5);
     presetButton.setBounds(headerArea.removeFromLeft(100));
@@ -292,6 +337,8 @@ void ChromaConsoleControllerAudioProcessorEditor::resized()
     auto footerArea = area.removeFromBottom(footerHeight);
 	area.removeFromBottom(padding); // add small padding at bottom
     autoUpdateButton.setBounds(footerArea.removeFromLeft(130).withSizeKeepingCentre(130, 25));
+    gestureButton.setBounds(footerArea.removeFromRight(130).withSizeKeepingCentre(130, 25));
+    midiButton.setBounds(footerArea.removeFromRight(80).withSizeKeepingCentre(80, 25));
     advancedButton.setBounds(footerArea.withSizeKeepingCentre(150, 25));
 
     // Calculate grid layout
@@ -513,6 +560,221 @@ void ChromaConsoleControllerAudioProcessorEditor::setShowAdvancedSettings(bool s
     audioProcessor.parameters.state.setProperty("showAdvancedSettings", show, nullptr);
 }
 
+void ChromaConsoleControllerAudioProcessorEditor::showGestureMenu()
+{
+    auto& recorder = audioProcessor.getGestureRecorder();
+    const bool recording = recorder.isRecording();
+    const bool hasTake = recorder.getNumEvents() > 0;
+
+    juce::PopupMenu menu;
+    menu.addItem(recording ? "Stop Recording" : "Record", [this, &recorder, recording]
+        {
+            if (recording)
+                recorder.stopRecording();
+            else
+                recorder.startRecording();
+
+            updateGestureButton();
+        });
+
+    menu.addItem("Loop Playback", hasTake && !recording, recorder.isPlaying(), [this, &recorder]
+        {
+            recorder.setPlaying(!recorder.isPlaying());
+            updateGestureButton();
+        });
+
+    menu.addSeparator();
+
+    // Both reduce how many events the take sends
+    juce::PopupMenu quantiseMenu;
+    const std::array<std::pair<const char*, double>, 4> grids{ { { "1/4", 1.0 }, { "1/8", 0.5 }, { "1/16", 0.25 }, { "1/32", 0.125 } } };
+    for (auto& [gridName, beats] : grids)
+        quantiseMenu.addItem(gridName, [this, &recorder, grid = beats] { recorder.quantise(grid); updateGestureButton(); });
+
+    juce::PopupMenu thinMenu;
+    const std::array<std::pair<const char*, double>, 3> spacings{ { { "Light", 1.0 / 64.0 }, { "Medium", 1.0 / 16.0 }, { "Heavy", 0.25 } } };
+    for (auto& [spacingName, beats] : spacings)
+        thinMenu.addItem(spacingName, [this, &recorder, spacing = beats] { recorder.thin(spacing); updateGestureButton(); });
+
+    menu.addSubMenu("Quantise", quantiseMenu, hasTake && !recording);
+    menu.addSubMenu("Thin", thinMenu, hasTake && !recording);
+    menu.addItem("Clear", hasTake && !recording, false, [this, &recorder] { recorder.clear(); updateGestureButton(); });
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&gestureButton));
+}
+
+void ChromaConsoleControllerAudioProcessorEditor::updateGestureButton()
+{
+    auto& recorder = audioProcessor.getGestureRecorder();
+
+    if (recorder.isRecording())
+        gestureButton.setButtonText("Gestures: Rec");
+    else if (recorder.getNumEvents() > 0)
+        gestureButton.setButtonText("Gestures: " + juce::String(recorder.getNumEvents()));
+    else
+        gestureButton.setButtonText("Gestures");
+}
+
+void ChromaConsoleControllerAudioProcessorEditor::showMidiMenu()
+{
+    auto& clock = audioProcessor.getMidiClock();
+    auto* clockParameter = audioProcessor.parameters.getParameter("midiClock");
+
+    juce::PopupMenu menu;
+    menu.addItem("Send MIDI Clock", clockParameter != nullptr, clockParameter != nullptr && clockParameter->getValue() >= 0.5f, [clockParameter]
+        {
+            clockParameter->setValueNotifyingHost(clockParameter->getValue() >= 0.5f ? 0.0f : 1.0f);
+        });
+
+    menu.addSeparator();
+
+    for (int taps : { 2, 4, 8 })
+        menu.addItem("Tap Tempo x" + juce::String(taps), [&clock, taps] { clock.requestTapBurst(taps); });
+
+    menu.addSeparator();
+
+    // Measured against a model of the DIN port, so CC traffic crowding the clock shows up here
+    const auto stats = clock.getJitterStats();
+    menu.addSectionHeader("Clock Jitter");
+    menu.addItem(stats.numTicks > 0 ? "Mean " + juce::String(stats.meanMicroseconds, 1) + " us, max " + juce::String(stats.maxMicroseconds, 1)
+                                          + " us (" + juce::String(stats.numTicks) + " ticks)"
+                                    : juce::String("No ticks sent yet"), false, false, [] {});
+    menu.addItem("Reset Jitter Stats", stats.numTicks > 0, false, [&clock] { clock.resetJitterStats(); });
+
+    // Bank Select and Program Change on the preset trigger channel
+    auto& presetMidiHandler = audioProcessor.getPresetMidiHandler();
+    menu.addSeparator();
+    menu.addItem("Program Change Recall", true, presetMidiHandler.isProgramChangeEnabled(), [&presetMidiHandler]
+        {
+            presetMidiHandler.setProgramChangeEnabled(!presetMidiHandler.isProgramChangeEnabled());
+        });
+
+    // What the host's own program list shows
+    auto& presetManager = audioProcessor.getPresetManager();
+    juce::PopupMenu hostProgramMenu;
+    const int hostBank = presetManager.getHostProgramBank();
+    hostProgramMenu.addItem("Whole Library", true, hostBank < 0, [&presetManager] { presetManager.setHostProgramBank(-1); });
+    hostProgramMenu.addSeparator();
+
+    for (int bank = 0; bank < juce::jmax(presetManager.getNumProgramBanks(), hostBank + 1); ++bank)
+        hostProgramMenu.addItem("Bank " + juce::String(bank), true, hostBank == bank, [&presetManager, bank] { presetManager.setHostProgramBank(bank); });
+
+    menu.addSubMenu("Host Programs", hostProgramMenu);
+
+    // Input that is passed on alongside the generated CCs
+    auto& thru = audioProcessor.getMidiThru();
+    menu.addSeparator();
+    menu.addItem("MIDI Thru", true, thru.isEnabled(), [&thru] { thru.setEnabled(!thru.isEnabled()); });
+
+    juce::PopupMenu channelMenu;
+    const int channels = thru.getChannelMask();
+    channelMenu.addItem("All", true, channels == MidiThruFilter::allChannels, [&thru] { thru.setChannelMask(MidiThruFilter::allChannels); });
+    channelMenu.addItem("None", true, channels == 0, [&thru] { thru.setChannelMask(0); });
+    channelMenu.addSeparator();
+
+    for (int channel = 0; channel < 16; ++channel)
+        channelMenu.addItem("Ch " + juce::String(channel + 1), true, ((channels >> channel) & 1) != 0, [&thru, bit = 1 << channel] { thru.setChannelMask(thru.getChannelMask() ^ bit); });
+
+    juce::PopupMenu typeMenu;
+    const std::array<std::pair<const char*, int>, 8> types{ {
+        { "Notes", MidiThruFilter::notes }, { "Controllers", MidiThruFilter::controllers },
+        { "Program Changes", MidiThruFilter::programChanges }, { "Pitch Bend", MidiThruFilter::pitchBend },
+        { "Aftertouch", MidiThruFilter::pressure }, { "Clock and Transport", MidiThruFilter::clock },
+        { "SysEx", MidiThruFilter::sysEx }, { "Other System", MidiThruFilter::otherSystem } } };
+
+    for (auto& [typeName, flag] : types)
+        typeMenu.addItem(typeName, true, (thru.getTypeMask() & flag) != 0, [&thru, bit = flag] { thru.setTypeMask(thru.getTypeMask() ^ bit); });
+
+    menu.addSubMenu("Thru Channels", channelMenu, thru.isEnabled());
+    menu.addSubMenu("Thru Types", typeMenu, thru.isEnabled());
+
+    // How early CCs go out to cover the interface and pedal delay
+    auto& latency = audioProcessor.getLatencyCompensation();
+    juce::PopupMenu latencyMenu;
+    const std::array<std::pair<const char*, LatencyCompensation::Mode>, 3> modes{ {
+        { "Off", LatencyCompensation::off }, { "Predict Transport", LatencyCompensation::predictTransport },
+        { "Report to Host", LatencyCompensation::reportToHost } } };
+
+    for (auto& [modeName, mode] : modes)
+    {
+        latencyMenu.addItem(modeName, true, latency.getMode() == mode, [this, &latency, newMode = mode]
+            {
+                latency.setMode(newMode);
+                audioProcessor.updateLatencyReporting();
+            });
+    }
+
+    latencyMenu.addSeparator();
+    latencyMenu.addItem("Offset: " + juce::String(latency.getOffsetMs(), 1) + " ms...", [this] { showLatencyOffsetDialog(); });
+    latencyMenu.addItem("Send Test Pulse", [this] { audioProcessor.startLatencyTest(); });
+    latencyMenu.addItem("Measure from Recording...", latency.hasTestPulse(), false, [this] { measureLatencyFromRecording(); });
+
+    menu.addSeparator();
+    menu.addSubMenu("Output Latency", latencyMenu);
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&midiButton));
+}
+
+void ChromaConsoleControllerAudioProcessorEditor::showLatencyOffsetDialog()
+{
+    auto& latency = audioProcessor.getLatencyCompensation();
+    auto* window = new juce::AlertWindow("Output Latency", "Offset in ms (0 - " + juce::String((int)LatencyCompensation::maxOffsetMs) + "):", juce::AlertWindow::NoIcon);
+
+    window->addTextEditor("offset", juce::String(latency.getOffsetMs(), 1), "Offset:");
+    window->addButton("Set", 1, juce::KeyPress(juce::KeyPress::returnKey));
+    window->addButton("Cancel", 0, juce::KeyPress(juce::KeyPress::escapeKey));
+
+    window->enterModalState(true, juce::ModalCallbackFunction::create([this, &latency, window](int result)
+        {
+            if (result == 1)
+            {
+                latency.setOffsetMs(window->getTextEditorContents("offset").getFloatValue());
+                audioProcessor.updateLatencyReporting();
+            }
+        }), true);
+}
+
+void ChromaConsoleControllerAudioProcessorEditor::measureLatencyFromRecording()
+{
+    latencyFileChooser = std::make_unique<juce::FileChooser>("Recording of the pedal's return, from the project start",
+        juce::File::getSpecialLocation(juce::File::userHomeDirectory), "*.wav;*.aif;*.aiff");
+
+    latencyFileChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles, [this](const juce::FileChooser& chooser)
+        {
+            const auto file = chooser.getResult();
+            if (file == juce::File())
+                return;
+
+            auto& latency = audioProcessor.getLatencyCompensation();
+            const auto measured = latency.measureFromRecording(file);
+
+            if (!measured)
+            {
+                juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Output Latency",
+                    "No jump in level was found after the test pulse in " + file.getFileName()
+                    + ".\n\nThe recording has to start at the project start, with a steady signal through the pedal.");
+                return;
+            }
+
+            auto options = juce::MessageBoxOptions()
+                .withIconType(juce::MessageBoxIconType::InfoIcon)
+                .withTitle("Output Latency")
+                .withMessage("The pedal reacted " + juce::String(*measured, 1) + " ms after the test pulse was sent.")
+                .withButton("Use as Offset")
+                .withButton("Cancel")
+                .withAssociatedComponent(this);
+
+            juce::AlertWindow::showAsync(options, [this, &latency, ms = *measured](int result)
+                {
+                    if (result == 1)
+                    {
+                        latency.setOffsetMs(ms);
+                        audioProcessor.updateLatencyReporting();
+                    }
+                });
+        });
+}
+
 void ChromaConsoleControllerAudioProcessorEditor::togglePresetBrowser()
 {
     showPresetBrowser = !showPresetBrowser;
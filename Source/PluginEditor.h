@@ -27,6 +27,7 @@ public:
 
     void paint(juce::Graphics&) override;
     void resized() override;
+    bool keyPressed(const juce::KeyPress& key) override;
 
 private:
     ChromaConsoleControllerAudioProcessor& audioProcessor;
@@ -43,6 +44,11 @@ private:
     juce::TextButton updateButton;
     juce::TextButton advancedButton;
     juce::TextButton autoUpdateButton;
+    juce::TextButton gestureButton;
+    juce::TextButton midiButton;
+    juce::TextButton undoButton;
+    juce::TextButton redoButton;
+    std::unique_ptr<juce::FileChooser> latencyFileChooser;
     juce::Label versionNumber;
     juce::ComponentBoundsConstrainer constrainer;
     
@@ -96,6 +102,11 @@ private:
     void createCCModules(); // Create sliders programatically from the amount of parameters defined in the audio processor
     void setupColumnInteractions(); // Setup value change callbacks for the first 4 modules (column headers)
     void toggleAdvancedSettings(); // Toggle visibility of the advanced settings
+    void showGestureMenu(); // Record, play and edit the gesture take
+    void updateGestureButton();
+    void showMidiMenu(); // MIDI clock output, tap tempo, clock jitter and thru
+    void showLatencyOffsetDialog();
+    void measureLatencyFromRecording(); // Asks for the loopback recording of the test pulse
 
     // Column control methods
     void setColumnProperties(int column, int value, bool first, bool second, bool third, bool fourth); // Setter for managing enabled state and color of columns
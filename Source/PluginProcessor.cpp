@@ -8,6 +8,7 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "StateChunks.h"
 
 const std::vector<CCControllerConfig> ChromaConsoleControllerAudioProcessor::ccConfigurations = {
     // ccConfigurations order is
@@ -15,12 +16,13 @@ const std::vector<CCControllerConfig> ChromaConsoleControllerAudioProcessor::ccC
     // Config ID
     // Config Name
     // Default Value
+    // Stepped (optional, switches instead of morphing)
    
      // Modules
-    { 16, "cModule", "Character Module", 5}, // Character Module
-    { 17, "mModule", "Movement Module", 5}, // Movement Module
-    { 18, "dModule", "Diffusion Module", 5}, // Diffusion Module
-    { 19, "tModule", "Texture Module", 5}, // Texture Module
+    { 16, "cModule", "Character Module", 5, true}, // Character Module
+    { 17, "mModule", "Movement Module", 5, true}, // Movement Module
+    { 18, "dModule", "Diffusion Module", 5, true}, // Diffusion Module
+    { 19, "tModule", "Texture Module", 5, true}, // Texture Module
     
     // Primary Controls
     { 64,  "tilt",  "Tilt", 63},  // Tilt
@@ -51,17 +53,17 @@ const std::vector<CCControllerConfig> ChromaConsoleControllerAudioProcessor::ccC
     
 
     // Bypass Controls
-    { 91, "bypass1", "Standard Bypass", 127}, // Standard Bypass
-    { 92, "bypass2", "Dual Bypass", 127}, // Dual Bypass
+    { 91, "bypass1", "Standard Bypass", 127, true}, // Standard Bypass
+    { 92, "bypass2", "Dual Bypass", 127, true}, // Dual Bypass
 
     // Other Functions
-    { 82, "capture", "Capture", 0}, // Capture
-    { 84, "filterMode", "Filter Mode", 63}, // Filter Mode
-    { 80, "gesturePlayRec", "Gesture Play/Record", 0}, // Gesture Play/Record
-    { 81, "gestureStopErase", "Gesture Stop/Erase", 127}, // Gesture Stop/Erase
-    { 83, "captureRouting", "Capture Routing", 0}, // Capture Routing
-    //{ 93, "taptempo", "Tap Tempo", 0}, // Tap Tempo (This tends to interrupt the midi clock being sent from my daw. I've disabled this for now)
-    { 94, "calibrationLevel", "Calibration Level", 63}, // Calibration Level
+    { 82, "capture", "Capture", 0, true}, // Capture
+    { 84, "filterMode", "Filter Mode", 63, true}, // Filter Mode
+    { 80, "gesturePlayRec", "Gesture Play/Record", 0, true}, // Gesture Play/Record
+    { 81, "gestureStopErase", "Gesture Stop/Erase", 127, true}, // Gesture Stop/Erase
+    { 83, "captureRouting", "Capture Routing", 0, true}, // Capture Routing
+    //{ 93, "taptempo", "Tap Tempo", 0}, // Tap Tempo (This tends to interrupt the midi clock being sent from my daw. Taps are now sent by MidiClockGenerator, between its clock ticks)
+    { 94, "calibrationLevel", "Calibration Level", 63, true}, // Calibration Level
     //{ 95, "calibrationMenu", "Calibration Menu (Enter)", 0} // Filter Mode // I also disabled this for UI cleanup's sake. 
 
 };
@@ -73,16 +75,91 @@ ChromaConsoleControllerAudioProcessor::ChromaConsoleControllerAudioProcessor()
         .withInput("Input", juce::AudioChannelSet::stereo(), true)),
     parameters(*this, nullptr, "PARAMETERS", createParameterLayout()),
     presetManager(*this),
-    presetMidiHandler(presetManager)
+    setlistPlayer(presetManager),
+    presetMidiHandler(presetManager, actionScheduler, setlistPlayer),
+    presetCompare(*this),
+    parameterHistory(*this),
+    morphEngine(getSlotMask(true)),
+    glideEngine(getSlotMask(false)),
+    macroEngine(getSlotMaximums()),
+    outputCurves(getModuleSlotMask()),
+    lfoBank(getSlotMaximums()),
+    stepSequencer(getSlotMaximums()),
+    envelopeFollower(getSlotMaximums()),
+    gestureRecorder(getSlotMaximums()),
+    midiLearn(getSlotMaximums()),
+    quantisedSlots(getQuantisedSlotMask())
 {
-    // Initialize previous values (?)
-    for (const auto& config : ccConfigurations) {
-        previousCCValues[config.ccNumber] = -1;
+    lastSentValues.fill(-1);
+
+    jassert(ccConfigurations.size() <= ParameterSnapshot::maxSlots);
+
+    parameterIndexToSlot.assign((size_t)getParameters().size(), -1);
+
+    for (size_t slot = 0; slot < ccConfigurations.size(); ++slot)
+    {
+        ccParameters[slot] = parameters.getParameter(ccConfigurations[slot].parameterID);
+        ccRawValues[slot] = parameters.getRawParameterValue(ccConfigurations[slot].parameterID);
+        parameterIndexToSlot[(size_t)ccParameters[slot]->getParameterIndex()] = (int)slot;
+
     }
+
+    morphAmount = parameters.getRawParameterValue("morph");
+    morphEnabled = parameters.getRawParameterValue("morphEnabled");
+    morphThreshold = parameters.getRawParameterValue("morphThreshold");
+    glideTime = parameters.getRawParameterValue("glideTime");
+    glideMode = parameters.getRawParameterValue("glideMode");
+    presetQuantise = parameters.getRawParameterValue("presetQuantise");
+    actionQuantise = parameters.getRawParameterValue("actionQuantise");
+    midiClockEnabled = parameters.getRawParameterValue("midiClock");
+
+    midiLearn.setParameters(ccParameters);
+
+    for (int macro = 0; macro < MacroEngine::numMacros; ++macro)
+        macroParameters[(size_t)macro] = parameters.getRawParameterValue("macro" + juce::String(macro + 1));
+
+    // Seed the running hash, then let parameter callbacks update it incrementally
+    auto snapshot = captureSnapshot();
+    for (size_t slot = 0; slot < hashedValues.size(); ++slot)
+        hashedValues[slot].store(snapshot.values[slot]);
+    stateHash.store(snapshot.getHash());
+
+    for (size_t slot = 0; slot < ccConfigurations.size(); ++slot)
+        ccParameters[slot]->addListener(this);
 }
 
 ChromaConsoleControllerAudioProcessor::~ChromaConsoleControllerAudioProcessor()
 {
+    for (size_t slot = 0; slot < ccConfigurations.size(); ++slot)
+        ccParameters[slot]->removeListener(this);
+}
+
+void ChromaConsoleControllerAudioProcessor::parameterValueChanged(int parameterIndex, float newValue)
+{
+    if (parameterIndex < 0 || parameterIndex >= (int)parameterIndexToSlot.size())
+        return;
+
+    const int slot = parameterIndexToSlot[(size_t)parameterIndex];
+    if (slot < 0)
+        return;
+
+    // Can be called from any thread. XOR is order independent, and the exchange
+    // makes sure each old value is removed exactly once
+    auto value = (juce::uint8)juce::jlimit(0, 127, juce::roundToInt(ccParameters[(size_t)slot]->convertFrom0to1(newValue)));
+    auto previous = hashedValues[(size_t)slot].exchange(value);
+
+    if (previous != value)
+    {
+        stateHash.fetch_xor(ParameterSnapshot::getKey(slot, previous) ^ ParameterSnapshot::getKey(slot, value));
+        parameterHistory.valuesChanged();
+    }
+}
+
+void ChromaConsoleControllerAudioProcessor::parameterGestureChanged(int parameterIndex, bool gestureIsStarting)
+{
+    // Knob drags are undo steps
+    if (juce::isPositiveAndBelow(parameterIndex, (int)parameterIndexToSlot.size()) && parameterIndexToSlot[(size_t)parameterIndex] >= 0)
+        parameterHistory.gestureChanged(gestureIsStarting);
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout ChromaConsoleControllerAudioProcessor::createParameterLayout()
@@ -280,6 +357,49 @@ juce::AudioProcessorValueTreeState::ParameterLayout ChromaConsoleControllerAudio
         }
     }
 
+    // Morph between the two presets set as A and B in the preset browser.
+    // Added after the CC parameters so existing parameter indices don't move
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "morph", "Morph", juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f));
+
+    auto morphEnabledAttribute = juce::AudioParameterBoolAttributes().withStringFromValueFunction([](auto x, auto) { return x ? "On" : "Off"; });
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        "morphEnabled", "Morph Enabled", false, morphEnabledAttribute));
+
+    // Stepped parameters (modules, bypass, modes) jump from A to B at this point
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "morphThreshold", "Morph Switch Point", juce::NormalisableRange<float>(0.0f, 1.0f), 0.5f));
+
+    // Glide smooths jumps on continuous CCs. 0 ms sends every change as a single step
+    auto glideTimeRange = juce::NormalisableRange<float>(0.0f, 5000.0f);
+    glideTimeRange.setSkewForCentre(250.0f);
+    auto glideTimeAttribute = juce::AudioParameterFloatAttributes().withLabel("ms")
+        .withStringFromValueFunction([](float x, int) { return x < 0.5f ? juce::String("Off") : juce::String(juce::roundToInt(x)) + " ms"; });
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "glideTime", "Glide Time", glideTimeRange, 0.0f, glideTimeAttribute));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "glideMode", "Glide Mode", juce::StringArray{ "Constant Time", "Constant Rate" }, 0));
+
+    // MIDI preset changes and Capture/Gesture presses can wait for the next beat or bar.
+    // Both grids are saved with the project in the PVAL chunk
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "presetQuantise", "Preset Change Quantise", ActionScheduler::getQuantiseNames(), 0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        "actionQuantise", "Capture/Gesture Quantise", ActionScheduler::getQuantiseNames(), 0));
+
+    // The plugin can clock the pedal itself, in place of the DAW's clock output.
+    // Saved with the project in the PVAL chunk, so the clock stays on after a reload
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        "midiClock", "Send MIDI Clock", false));
+
+    // Macros drive whichever CCs are assigned to them (slider right click > Macro)
+    for (int macro = 1; macro <= MacroEngine::numMacros; ++macro)
+    {
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            "macro" + juce::String(macro), "Macro " + juce::String(macro), juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f));
+    }
 
     return layout;
 }
@@ -333,22 +453,23 @@ double ChromaConsoleControllerAudioProcessor::getTailLengthSeconds() const
 
 int ChromaConsoleControllerAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    // The preset library, or one bank of it. Never 0, some hosts don't cope with that
+    return presetManager.getNumHostPrograms();
 }
 
 int ChromaConsoleControllerAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return juce::jmax(0, presetManager.getCurrentHostProgram());
 }
 
 void ChromaConsoleControllerAudioProcessor::setCurrentProgram (int index)
 {
+    presetManager.loadHostProgram(index);
 }
 
 const juce::String ChromaConsoleControllerAudioProcessor::getProgramName (int index)
 {
-    return {};
+    return presetManager.getHostProgramName(index);
 }
 
 void ChromaConsoleControllerAudioProcessor::changeProgramName (int index, const juce::String& newName)
@@ -358,26 +479,62 @@ void ChromaConsoleControllerAudioProcessor::changeProgramName (int index, const
 //==============================================================================
 void ChromaConsoleControllerAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
+    glideEngine.prepare(sampleRate);
+    midiBudget.prepare(sampleRate);
+    envelopeFollower.prepare(sampleRate);
+    actionScheduler.prepare();
+    midiClock.prepare(sampleRate);
+    midiThru.prepare();
+    resetLatchedSlots();
+    // Keep the ticks of even a large block well inside the split point array
+    controlInterval = juce::jmax(1, juce::roundToInt(sampleRate / controlRateHz), samplesPerBlock / (maxSplitPoints / 2));
+    transport = {};
+    latencyPulseSlot = -1;
+    updateLatencyReporting();
     sendCurrentSliderValues();
 }
 
+void ChromaConsoleControllerAudioProcessor::updateLatencyReporting()
+{
+    const int latency = latencyCompensation.getLatencySamples(getSampleRate());
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+}
+
+bool ChromaConsoleControllerAudioProcessor::startLatencyTest()
+{
+    const int levelSlot = getSlotForParameterID("level");
+    if (levelSlot < 0)
+        return false;
+
+    const int restoreValue = juce::roundToInt(ccRawValues[(size_t)levelSlot]->load());
+
+    return actionScheduler.scheduleSequence({ { 0.0, { ActionScheduler::setSlot, levelSlot, 0, true } },
+                                              { 1.0, { ActionScheduler::latencyTestPulse, levelSlot, 127 } },
+                                              { 2.0, { ActionScheduler::setSlot, levelSlot, restoreValue, true } } },
+                                            ActionScheduler::deviceActions);
+}
+
 void ChromaConsoleControllerAudioProcessor::sendCurrentSliderValues()
 {
-    for (const auto& config : ccConfigurations) {
-        {
-            // Get the current value of the slider
-            const int rawValue = *parameters.getRawParameterValue(config.parameterID);
-            int currentValue = rawValue;
+    // processBlock forgets what it last sent, so every slot goes out with its current
+    // output value (including morph) on the next block
+    resendRequested.store(true);
+}
 
+void ChromaConsoleControllerAudioProcessor::addCCIfChanged(juce::MidiBuffer& midiMessages, int midiChannel, int slot, int currentValue, int samplePosition)
+{
+    int& prevValue = lastSentValues[(size_t)slot];
 
-            // Map stepped CC sliders to proper output value for module effects
-            if (config.parameterID == "cModule" || config.parameterID == "mModule" || config.parameterID == "dModule" || config.parameterID == "tModule") {
-                currentValue = rawValue * 22;
-            }
-            // Create a MIDI CC message
-            juce::MidiMessage midiMessage = juce::MidiMessage::controllerEvent(getMidiChannel(), config.ccNumber, currentValue);
-            sendMidiMessage(midiMessage); // Add the message to the queue
-        }
+    if (currentValue != prevValue) {
+        // Over budget: leave it pending, the next tick tries again with the newest value
+        midiBudget.advanceTo(samplePosition);
+        if (!midiBudget.trySpend())
+            return;
+
+        midiMessages.addEvent(juce::MidiMessage::controllerEvent(
+            midiChannel, ccConfigurations[(size_t)slot].ccNumber, currentValue), samplePosition);
+        prevValue = currentValue;
     }
 }
 
@@ -437,15 +594,51 @@ bool ChromaConsoleControllerAudioProcessor::isBusesLayoutSupported(const BusesLa
 void ChromaConsoleControllerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+
+    // The audio input only feeds the envelope follower, nothing is passed through
+    envelopeFollower.update();
+    envelopeFollower.analyse(buffer, getTotalNumInputChannels());
     buffer.clear();
-    // Process preset MIDI changes
+
+    const int numSamples = buffer.getNumSamples();
+    const int midiChannel = getMidiChannel();
+    transport = TransportInfo::fromPlayHead(getPlayHead(), getSampleRate(), numSamples, transport, latencyCompensation.getLookaheadSeconds());
+
+    actionScheduler.setQuantise(ActionScheduler::presetChanges, (ActionScheduler::Quantise)juce::roundToInt(presetQuantise->load()));
+    actionScheduler.setQuantise(ActionScheduler::deviceActions, (ActionScheduler::Quantise)juce::roundToInt(actionQuantise->load()));
+    actionScheduler.beginBlock(transport);
+
+    // Process preset MIDI changes, queued on the scheduler
     presetMidiHandler.processMidiMessages(midiMessages, buffer.getNumSamples());
 
+    int setlistTarget = 0, setlistValue = 0;
+    if (setlistPlayer.takeRequest(setlistTarget, setlistValue))
+        actionScheduler.schedule({ ActionScheduler::setlistStep, setlistTarget, setlistValue }, ActionScheduler::presetChanges, 0);
+
+    // A/B switches and auditions land whole at the start of the block, only the differing CCs go out
+    if (auto* compareValues = presetCompare.takePendingValues())
+    {
+        applySnapshot(*compareValues);
+        resetLatchedSlots();
+    }
+
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
+    // Learned controllers move the knobs before anything reads them
+    readKnobValues(midiMessages);
+
+    // Record knob moves and incoming CCs before the input is dropped
+    gestureRecorder.update();
+    gestureRecorder.beginBlock(transport);
+    captureGestures(midiMessages, midiChannel);
+
+    // Whatever the thru filter allows is set aside and merged back in at the end
+    midiThru.collect(midiMessages);
     midiMessages.clear();
-    const int midiChannel = getMidiChannel();
+
+    // Clock goes in first so its bytes lead anything else on the same sample
+    midiClock.process(midiMessages, transport, midiClockEnabled->load() >= 0.5f, midiChannel);
 
     // Check for pending MIDI messages
     {
@@ -457,22 +650,274 @@ void ChromaConsoleControllerAudioProcessor::processBlock (juce::AudioBuffer<floa
 
     }
 
-    for (const auto& config : ccConfigurations) {
-        const int rawValue = *parameters.getRawParameterValue(config.parameterID);
-        int currentValue = rawValue;
-        int& prevValue = previousCCValues[config.ccNumber];
+    if (resendRequested.exchange(false))
+        lastSentValues.fill(-1);
+
+    scheduleLatchedSlots();
+    updateBaseValues();
+
+    outputCurves.update();
+    lfoBank.update();
+    stepSequencer.update();
+
+    // The output stage runs at the start of the block, at control rate while something
+    // moves continuously, and on every sequencer step, recorded gesture event and
+    // scheduled action. Without any of these, one pass covers the whole block
+    int numSplits = 0;
+    splitPoints[(size_t)numSplits++] = 0;
+
+    if (lfoBank.isActive() || envelopeFollower.isActive() || stepSequencer.needsControlRate())
+    {
+        for (int tick = controlInterval; tick < numSamples && numSplits < maxSplitPoints; tick += controlInterval)
+            splitPoints[(size_t)numSplits++] = tick;
+    }
+
+    numSplits = stepSequencer.addStepBoundaries(transport, splitPoints.data(), numSplits, maxSplitPoints);
+    numSplits = gestureRecorder.addEventBoundaries(transport, splitPoints.data(), numSplits, maxSplitPoints);
+    numSplits = actionScheduler.addFireTimes(splitPoints.data(), numSplits, maxSplitPoints);
+
+    auto* splitsEnd = splitPoints.data() + numSplits;
+    std::sort(splitPoints.data(), splitsEnd);
+    numSplits = (int)(std::unique(splitPoints.data(), splitsEnd) - splitPoints.data());
+
+    for (int i = 0; i < numSplits; ++i)
+    {
+        const int start = splitPoints[(size_t)i];
+        const int end = i + 1 < numSplits ? splitPoints[(size_t)i + 1] : numSamples;
+        renderControlTick(midiMessages, midiChannel, start, end - start);
+    }
+
+    midiBudget.endBlock(numSamples);
+    midiThru.merge(midiMessages);
+    midiClock.measureJitter(midiMessages, numSamples);
+}
+
+void ChromaConsoleControllerAudioProcessor::updateBaseValues()
+{
+    // Knob values first, then anything that replaces them. These only change per block,
+    // or when a scheduled action fires
+    const int numSlots = (int)ccConfigurations.size();
+    for (int slot = 0; slot < numSlots; ++slot)
+    {
+        baseValues[(size_t)slot] = ((quantisedSlots >> slot) & 1u) ? (float)latchedValues[(size_t)slot]
+                                                                    : knobValues[(size_t)slot];
+    }
+
+    if (morphEnabled->load() >= 0.5f)
+        morphEngine.process(morphAmount->load(), morphThreshold->load(), baseValues.data(), numSlots);
+
+    for (size_t macro = 0; macro < macroValues.size(); ++macro)
+        macroValues[macro] = macroParameters[macro]->load();
+
+    macroEngine.process(macroValues.data(), baseValues.data(), numSlots);
+}
+
+void ChromaConsoleControllerAudioProcessor::scheduleLatchedSlots()
+{
+    // A Capture or Gesture knob that moved is sent on the next grid line, not straight away
+    for (int slot = 0; slot < (int)ccConfigurations.size(); ++slot)
+    {
+        if (((quantisedSlots >> slot) & 1u) == 0)
+            continue;
+
+        const int value = juce::roundToInt(knobValues[(size_t)slot]);
+        if (std::exchange(scheduledKnobValues[(size_t)slot], value) != value)
+            actionScheduler.schedule({ ActionScheduler::setSlot, slot, value }, ActionScheduler::deviceActions, 0);
+    }
+}
+
+void ChromaConsoleControllerAudioProcessor::resetLatchedSlots()
+{
+    for (size_t slot = 0; slot < ccConfigurations.size(); ++slot)
+        latchedValues[slot] = scheduledKnobValues[slot] = juce::roundToInt(ccRawValues[slot]->load());
+}
+
+void ChromaConsoleControllerAudioProcessor::performAction(const ActionScheduler::Action& action)
+{
+    if (action.type == ActionScheduler::loadPresetNote)
+    {
+        // A preset brings its own Capture/Gesture state with it, on the same sample
+        presetManager.loadPresetFromMidiNote(action.target);
+        resetLatchedSlots();
+    }
+    else if (action.type == ActionScheduler::loadPresetProgram)
+    {
+        presetManager.loadPresetFromProgram(action.target);
+        resetLatchedSlots();
+    }
+    else if (action.type == ActionScheduler::loadPresetTrigger)
+    {
+        // The first momentary trigger remembers where to return to, a latched one stays
+        if (action.value == 0)
+            triggerReturnValues.reset();
+        else if (!triggerReturnValues)
+            triggerReturnValues = captureSnapshot();
+
+        // Momentary layers only change values, which is all the return puts back
+        presetManager.loadPresetFromProgram(action.target, action.recallMask, action.value != 0);
+        resetLatchedSlots();
+    }
+    else if (action.type == ActionScheduler::setlistStep)
+    {
+        // The setlist holds its own copies, so this never looks anything up
+        if (auto* cue = action.target == 0 ? setlistPlayer.step(action.value) : setlistPlayer.jumpTo(action.value))
+        {
+            presetManager.loadPreset(cue->preset, cue->recallMask);
+            resetLatchedSlots();
+        }
+    }
+    else if (action.type == ActionScheduler::returnFromTrigger)
+    {
+        if (triggerReturnValues)
+        {
+            applySnapshot(*triggerReturnValues);
+            triggerReturnValues.reset();
+            resetLatchedSlots();
+        }
+    }
+    else if (action.type == ActionScheduler::latencyTestPulse && juce::isPositiveAndBelow(action.target, (int)ccConfigurations.size()))
+    {
+        // Moves the knob like a sequence step, but the CC itself is latched and sent by the
+        // tick without glide, modulation or curve, which also notes the sample it went out on
+        const auto slot = (size_t)action.target;
+        latchedValues[slot] = scheduledKnobValues[slot] = action.value;
+        midiLearn.supersedePendingValue(action.target, action.value);
+        ccParameters[slot]->setValueNotifyingHost(ccParameters[slot]->convertTo0to1((float)action.value));
+
+        latencyPulseSlot = action.target;
+        latencyPulseValue = action.value;
+    }
+    else if (action.type == ActionScheduler::setSlot && juce::isPositiveAndBelow(action.target, (int)ccConfigurations.size()))
+    {
+        const auto slot = (size_t)action.target;
+        latchedValues[slot] = action.value;
 
-        // Map stepped CC values to real cc values for Module FX
-        if (config.parameterID == "cModule" || config.parameterID == "mModule" || config.parameterID == "dModule" || config.parameterID == "tModule") {
-            currentValue = rawValue * 22;
+        if (action.updateParameter)
+        {
+            // Sequences move the knob too, so it shows what was sent and isn't scheduled again
+            scheduledKnobValues[slot] = action.value;
+            midiLearn.supersedePendingValue(action.target, action.value);
+            ccParameters[slot]->setValueNotifyingHost(ccParameters[slot]->convertTo0to1((float)action.value));
         }
+    }
+
+    // Actions set parameters, which have to go out from this tick rather than next block
+    refreshKnobValues();
+    updateBaseValues();
+}
+
+void ChromaConsoleControllerAudioProcessor::readKnobValues(const juce::MidiBuffer& midiMessages)
+{
+    refreshKnobValues();
+    midiLearn.process(midiMessages, knobValues.data(), (int)ccConfigurations.size());
+}
+
+void ChromaConsoleControllerAudioProcessor::refreshKnobValues()
+{
+    // A learned value stands in for its parameter until the message thread has set it
+    for (size_t slot = 0; slot < ccConfigurations.size(); ++slot)
+    {
+        const int pending = midiLearn.getPendingValue((int)slot);
+        knobValues[slot] = pending >= 0 ? (float)pending : ccRawValues[slot]->load();
+    }
+}
+
+void ChromaConsoleControllerAudioProcessor::captureGestures(const juce::MidiBuffer& midiMessages, int midiChannel)
+{
+    const bool capturing = gestureRecorder.isCapturing();
+    const int numSlots = (int)ccConfigurations.size();
+
+    // Editor and automation moves land at the start of the block
+    for (int slot = 0; slot < numSlots; ++slot)
+    {
+        const int value = juce::roundToInt(knobValues[(size_t)slot]);
+        if (std::exchange(previousKnobValues[(size_t)slot], value) != value && capturing)
+            gestureRecorder.capture(slot, value, transport.ppq);
+    }
+
+    if (!capturing)
+        return;
+
+    // CCs played into the plugin on the device's channel keep their exact position
+    for (const auto metadata : midiMessages)
+    {
+        const auto message = metadata.getMessage();
+        if (!message.isController() || message.getChannel() != midiChannel)
+            continue;
+
+        const int slot = getSlotForCCNumber(message.getControllerNumber());
+        if (slot >= 0)
+            gestureRecorder.capture(slot, getRawValueForCC(slot, message.getControllerValue()), transport.getPpqAtSample(metadata.samplePosition));
+    }
+}
+
+void ChromaConsoleControllerAudioProcessor::renderControlTick(juce::MidiBuffer& midiMessages, int midiChannel, int startSample, int numSamples)
+{
+    const int numSlots = (int)ccConfigurations.size();
 
-        if (currentValue != prevValue) {
-            midiMessages.addEvent(juce::MidiMessage::controllerEvent(
-                midiChannel, config.ccNumber, currentValue), 0);
-            prevValue = currentValue;
+    // Quantised actions land on the first sample of their segment
+    tickStartSample = startSample;
+    actionScheduler.fireDue(startSample, [this](const ActionScheduler::Action& action) { performAction(action); });
+
+    slotValues = baseValues;
+
+    // Recorded gestures and sequenced values replace the knob values, modulation goes on top
+    const double ppq = transport.getPpqAtSample(startSample);
+
+    if (gestureRecorder.isActive())
+        gestureRecorder.process(ppq, slotValues.data());
+
+    if (stepSequencer.isActive())
+        stepSequencer.process(transport, ppq, slotValues.data());
+
+    if (lfoBank.isActive())
+        lfoBank.process(ppq, slotValues.data());
+
+    envelopeFollower.process(startSample, slotValues.data());
+
+    // Raw values become CC values through each slot's response curve.
+    // Gliding slots hand their target to the glide engine, the rest are sent as they are.
+    // Only CCs whose quantised value changed are sent
+    const float glideMs = glideTime->load();
+    const auto mode = (GlideEngine::Mode)juce::roundToInt(glideMode->load());
+    const auto glideSlots = glideEngine.getEnabledSlots();
+
+    for (int slot = 0; slot < numSlots; ++slot)
+    {
+        if (slot == latencyPulseSlot)
+        {
+            // Retried next tick if the MIDI budget holds it back. The timeline position excludes
+            // any lookahead, so the measured offset is the full delay
+            glideEngine.cancel(slot);
+            addCCIfChanged(midiMessages, midiChannel, slot, latencyPulseValue, startSample);
+
+            if (lastSentValues[(size_t)slot] == latencyPulseValue)
+            {
+                if (transport.hostPosition)
+                    latencyCompensation.markTestPulse(transport.timeInSeconds + startSample / transport.sampleRate - latencyCompensation.getLookaheadSeconds());
+
+                latencyPulseSlot = -1;
+            }
+
+            continue;
         }
+
+        const int ccValue = outputCurves.getCCValue(slot, juce::roundToInt(slotValues[(size_t)slot]));
+
+        if ((glideSlots >> slot) & 1u)
+        {
+            if (glideEngine.setTarget(slot, ccValue, lastSentValues[(size_t)slot], glideMs, mode))
+                continue;
+        }
+
+        glideEngine.cancel(slot);
+        addCCIfChanged(midiMessages, midiChannel, slot, ccValue, startSample);
     }
+
+    glideEngine.render(startSample, numSamples, [&](int slot, int ccValue, int samplePosition)
+        {
+            addCCIfChanged(midiMessages, midiChannel, slot, ccValue, samplePosition);
+        });
 }
 
 //==============================================================================
@@ -489,25 +934,19 @@ juce::AudioProcessorEditor* ChromaConsoleControllerAudioProcessor::createEditor(
 //==============================================================================
 void ChromaConsoleControllerAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // Create main state tree
-    juce::ValueTree state("PluginState");
-
-    // Save existing parameters
-    auto paramState = parameters.copyState();
-    state.appendChild(paramState, nullptr);
-
-    // Save preset manager state
-    auto presetState = presetManager.getState();
-    state.appendChild(presetState, nullptr);
-
-    // Convert to xml and save
-    auto xml = state.createXml();
-    copyXmlToBinary(*xml, destData);
+    // Compact binary chunk, see StateChunks.h
+    writeBinaryState(destData);
 }
 
 void ChromaConsoleControllerAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // Load from binary
+    // Undo doesn't reach back past a restored state
+    parameterHistory.requestReset();
+
+    if (readBinaryState(data, sizeInBytes))
+        return;
+
+    // Old projects saved the state as XML
     auto xml = getXmlFromBinary(data, sizeInBytes);
     if (!xml)
         return;
@@ -527,6 +966,427 @@ void ChromaConsoleControllerAudioProcessor::setStateInformation (const void* dat
         presetManager.setState(presetState);
 }
 
+void ChromaConsoleControllerAudioProcessor::writeBinaryState(juce::MemoryBlock& destData)
+{
+    destData.setSize(0);
+    juce::MemoryOutputStream out(destData, false);
+
+    StateChunks::writeHeader(out);
+
+    // Parameters: slot count, one byte per slot, then the MIDI channel and Update Values
+    StateChunks::writeChunk(out, StateChunks::parametersTag, [this](juce::MemoryOutputStream& chunk)
+        {
+            auto snapshot = captureSnapshot();
+            chunk.writeByte((char)ccConfigurations.size());
+            chunk.write(snapshot.values.data(), ccConfigurations.size());
+            chunk.writeByte((char)getMidiChannel());
+            chunk.writeBool(*parameters.getRawParameterValue("updateValues") >= 0.5f);
+        });
+
+    // Every other parameter (morph, glide, macros, quantise, clock) as ID and normalised value,
+    // so adding parameters never shifts what older projects load into
+    StateChunks::writeChunk(out, StateChunks::parameterValuesTag, [this](juce::MemoryOutputStream& chunk)
+        {
+            const auto& processorParameters = getParameters();
+            for (int index = 0; index < processorParameters.size(); ++index)
+            {
+                if (auto* param = getParameterStoredByID(index))
+                {
+                    chunk.writeString(param->getParameterID());
+                    chunk.writeFloat(param->getValue());
+                }
+            }
+        });
+
+    StateChunks::writeChunk(out, StateChunks::presetManagerTag, [this](juce::MemoryOutputStream& chunk)
+        {
+            presetManager.writeBinaryState(chunk);
+        });
+
+    // Editor flags are stored as properties on the parameter tree
+    StateChunks::writeChunk(out, StateChunks::editorTag, [this](juce::MemoryOutputStream& chunk)
+        {
+            auto& state = parameters.state;
+            chunk.writeBool(state.getProperty("showAdvancedSettings", false));
+            chunk.writeBool(state.getProperty("presetBrowserVisible", false));
+            chunk.writeBool(state.getProperty("autoCheckForUpdates", true));
+        });
+
+    StateChunks::writeChunk(out, StateChunks::morphTag, [this](juce::MemoryOutputStream& chunk)
+        {
+            morphEngine.writeBinaryState(chunk);
+        });
+
+    // Only the gliding slots, the Glide Time and Glide Mode parameters are in the PVAL chunk
+    StateChunks::writeChunk(out, StateChunks::glideTag, [this](juce::MemoryOutputStream& chunk)
+        {
+            chunk.writeInt((int)glideEngine.getEnabledSlots());
+        });
+
+    // Macro positions (macro1..macro8) go with the other parameters in the PVAL chunk
+    StateChunks::writeChunk(out, StateChunks::macroTag, [this](juce::MemoryOutputStream& chunk)
+        {
+            macroEngine.writeBinaryState(chunk);
+        });
+
+    StateChunks::writeChunk(out, StateChunks::curvesTag, [this](juce::MemoryOutputStream& chunk)
+        {
+            outputCurves.writeBinaryState(chunk);
+        });
+
+    StateChunks::writeChunk(out, StateChunks::lfoTag, [this](juce::MemoryOutputStream& chunk)
+        {
+            lfoBank.writeBinaryState(chunk);
+        });
+
+    StateChunks::writeChunk(out, StateChunks::sequencerTag, [this](juce::MemoryOutputStream& chunk)
+        {
+            stepSequencer.writeBinaryState(chunk);
+        });
+
+    StateChunks::writeChunk(out, StateChunks::envelopeTag, [this](juce::MemoryOutputStream& chunk)
+        {
+            envelopeFollower.writeBinaryState(chunk);
+        });
+
+    StateChunks::writeChunk(out, StateChunks::gestureTag, [this](juce::MemoryOutputStream& chunk)
+        {
+            gestureRecorder.writeBinaryState(chunk);
+        });
+
+    StateChunks::writeChunk(out, StateChunks::thruTag, [this](juce::MemoryOutputStream& chunk)
+        {
+            midiThru.writeBinaryState(chunk);
+        });
+
+    StateChunks::writeChunk(out, StateChunks::learnTag, [this](juce::MemoryOutputStream& chunk)
+        {
+            midiLearn.writeBinaryState(chunk);
+        });
+
+    StateChunks::writeChunk(out, StateChunks::setlistTag, [this](juce::MemoryOutputStream& chunk)
+        {
+            setlistPlayer.writeBinaryState(chunk);
+        });
+
+    StateChunks::writeChunk(out, StateChunks::latencyTag, [this](juce::MemoryOutputStream& chunk)
+        {
+            latencyCompensation.writeBinaryState(chunk);
+        });
+}
+
+bool ChromaConsoleControllerAudioProcessor::readBinaryState(const void* data, int sizeInBytes)
+{
+    return StateChunks::readChunks(data, sizeInBytes, [this](juce::uint32 tag, juce::MemoryInputStream& chunk)
+        {
+            if (tag == StateChunks::parametersTag)
+            {
+                // Unknown or missing slots keep their current value
+                auto snapshot = captureSnapshot();
+                const int numSlots = (juce::uint8)chunk.readByte();
+
+                for (int slot = 0; slot < numSlots && !chunk.isExhausted(); ++slot)
+                {
+                    auto value = (juce::uint8)chunk.readByte();
+                    if (slot < (int)ccConfigurations.size())
+                        snapshot.values[(size_t)slot] = value;
+                }
+
+                applySnapshot(snapshot);
+                applyMidiChannel((juce::uint8)chunk.readByte());
+
+                if (auto* updateParam = parameters.getParameter("updateValues"))
+                    updateParam->setValueNotifyingHost(chunk.readBool() ? 1.0f : 0.0f);
+            }
+            else if (tag == StateChunks::parameterValuesTag)
+            {
+                // Parameters this version doesn't have are skipped, missing ones keep their value
+                while (!chunk.isExhausted())
+                {
+                    const auto parameterID = chunk.readString();
+                    const float value = chunk.readFloat();
+
+                    if (auto* param = parameters.getParameter(parameterID))
+                    {
+                        if (getParameterStoredByID(param->getParameterIndex()) == param)
+                            param->setValueNotifyingHost(juce::jlimit(0.0f, 1.0f, value));
+                    }
+                }
+            }
+            else if (tag == StateChunks::presetManagerTag)
+            {
+                presetManager.readBinaryState(chunk);
+            }
+            else if (tag == StateChunks::editorTag)
+            {
+                auto& state = parameters.state;
+                state.setProperty("showAdvancedSettings", chunk.readBool(), nullptr);
+                state.setProperty("presetBrowserVisible", chunk.readBool(), nullptr);
+                state.setProperty("autoCheckForUpdates", chunk.readBool(), nullptr);
+            }
+            else if (tag == StateChunks::morphTag)
+            {
+                morphEngine.readBinaryState(chunk);
+            }
+            else if (tag == StateChunks::glideTag)
+            {
+                glideEngine.setEnabledSlots((juce::uint32)chunk.readInt());
+            }
+            else if (tag == StateChunks::macroTag)
+            {
+                macroEngine.readBinaryState(chunk);
+            }
+            else if (tag == StateChunks::curvesTag)
+            {
+                outputCurves.readBinaryState(chunk);
+            }
+            else if (tag == StateChunks::lfoTag)
+            {
+                lfoBank.readBinaryState(chunk);
+            }
+            else if (tag == StateChunks::sequencerTag)
+            {
+                stepSequencer.readBinaryState(chunk);
+            }
+            else if (tag == StateChunks::envelopeTag)
+            {
+                envelopeFollower.readBinaryState(chunk);
+            }
+            else if (tag == StateChunks::gestureTag)
+            {
+                gestureRecorder.readBinaryState(chunk);
+            }
+            else if (tag == StateChunks::thruTag)
+            {
+                midiThru.readBinaryState(chunk);
+            }
+            else if (tag == StateChunks::learnTag)
+            {
+                midiLearn.readBinaryState(chunk);
+            }
+            else if (tag == StateChunks::setlistTag)
+            {
+                setlistPlayer.readBinaryState(chunk);
+            }
+            else if (tag == StateChunks::latencyTag)
+            {
+                latencyCompensation.readBinaryState(chunk);
+                updateLatencyReporting();
+            }
+        });
+}
+
+juce::RangedAudioParameter* ChromaConsoleControllerAudioProcessor::getParameterStoredByID(int parameterIndex) const
+{
+    // CC slots, the MIDI channel and Update Values have fixed places in the PARM chunk
+    if (!juce::isPositiveAndBelow(parameterIndex, (int)parameterIndexToSlot.size()) || parameterIndexToSlot[(size_t)parameterIndex] >= 0)
+        return nullptr;
+
+    auto* param = dynamic_cast<juce::RangedAudioParameter*>(getParameters()[parameterIndex]);
+    if (param == nullptr || param->getParameterID() == "midiChannel" || param->getParameterID() == "updateValues")
+        return nullptr;
+
+    return param;
+}
+
+//==============================================================================
+juce::ValueTree ChromaConsoleControllerAudioProcessor::capturePluginState()
+{
+    juce::ValueTree state("PluginState");
+    state.appendChild(parameters.copyState(), nullptr);
+    state.appendChild(presetManager.getState(), nullptr);
+    state.appendChild(macroEngine.toValueTree(), nullptr);
+    state.appendChild(lfoBank.toValueTree(), nullptr);
+    state.appendChild(stepSequencer.toValueTree(), nullptr);
+    state.appendChild(envelopeFollower.toValueTree(), nullptr);
+    state.appendChild(gestureRecorder.toValueTree(), nullptr);
+    return state;
+}
+
+void ChromaConsoleControllerAudioProcessor::restorePresetSections(const PresetSections& sections)
+{
+    // Presets saved before a section existed leave the current setup alone
+    if (sections.macroTargets)
+        macroEngine.setTargets(*sections.macroTargets);
+
+    if (sections.lfos)
+        lfoBank.setLfos(*sections.lfos);
+
+    if (sections.lanes)
+        stepSequencer.setLanes(*sections.lanes);
+
+    if (sections.envelopeFollower)
+        envelopeFollower.setSettings(*sections.envelopeFollower);
+
+    if (sections.gestureTake)
+    {
+        gestureRecorder.setPlaying(sections.gesturesPlaying);
+        gestureRecorder.setTake(*sections.gestureTake);
+    }
+}
+
+PresetSections::Ptr ChromaConsoleControllerAudioProcessor::readSectionsFromState(const juce::ValueTree& pluginState)
+{
+    auto sections = new PresetSections();
+
+    auto macros = pluginState.getChildWithName("Macros");
+    if (macros.isValid())
+        sections->macroTargets = MacroEngine::readTargets(macros);
+
+    auto lfos = pluginState.getChildWithName("Lfos");
+    if (lfos.isValid())
+        sections->lfos = LfoBank::readLfos(lfos);
+
+    auto sequencer = pluginState.getChildWithName("Sequencer");
+    if (sequencer.isValid())
+        sections->lanes = StepSequencer::readLanes(sequencer);
+
+    auto follower = pluginState.getChildWithName("EnvelopeFollower");
+    if (follower.isValid())
+        sections->envelopeFollower = EnvelopeFollower::readSettings(follower);
+
+    auto gestures = pluginState.getChildWithName("Gestures");
+    if (gestures.isValid())
+    {
+        sections->gesturesPlaying = gestures.getProperty("playing", true);
+        sections->gestureTake = GestureRecorder::readTake(gestures, getSlotMaximums());
+    }
+
+    return sections;
+}
+
+ParameterSnapshot ChromaConsoleControllerAudioProcessor::captureSnapshot() const
+{
+    ParameterSnapshot snapshot;
+
+    for (size_t slot = 0; slot < ccConfigurations.size(); ++slot)
+        snapshot.values[slot] = (juce::uint8)juce::jlimit(0, 127, juce::roundToInt(ccRawValues[slot]->load()));
+
+    return snapshot;
+}
+
+void ChromaConsoleControllerAudioProcessor::applySnapshot(const ParameterSnapshot& snapshot, juce::uint32 slotMask)
+{
+    for (size_t slot = 0; slot < ccConfigurations.size(); ++slot)
+    {
+        if ((slotMask & (1u << slot)) == 0)
+            continue;
+
+        auto* param = ccParameters[slot];
+        const float value = (float)snapshot.values[slot];
+
+        // A learned CC the message thread hasn't applied yet would otherwise overwrite this
+        midiLearn.supersedePendingValue((int)slot, (int)snapshot.values[slot]);
+
+        // Only touch parameters that actually change, keeps host automation quiet
+        if (juce::roundToInt(ccRawValues[slot]->load()) != (int)snapshot.values[slot])
+            param->setValueNotifyingHost(param->convertTo0to1(value));
+    }
+}
+
+void ChromaConsoleControllerAudioProcessor::applyMidiChannel(int channel)
+{
+    if (channel < 1 || channel > 16)
+        return;
+
+    if (auto* midiChannelParam = parameters.getParameter("midiChannel"))
+        midiChannelParam->setValueNotifyingHost(midiChannelParam->convertTo0to1((float)channel));
+}
+
+int ChromaConsoleControllerAudioProcessor::getSlotForParameterID(const juce::String& parameterID)
+{
+    for (size_t slot = 0; slot < ccConfigurations.size(); ++slot)
+    {
+        if (ccConfigurations[slot].parameterID == parameterID)
+            return (int)slot;
+    }
+
+    return -1;
+}
+
+juce::uint32 ChromaConsoleControllerAudioProcessor::getQuantisedSlotMask()
+{
+    juce::uint32 mask = 0;
+
+    for (size_t slot = 0; slot < ccConfigurations.size(); ++slot)
+    {
+        const auto& id = ccConfigurations[slot].parameterID;
+        if (id == "capture" || id == "gesturePlayRec" || id == "gestureStopErase")
+            mask |= 1u << slot;
+    }
+
+    return mask;
+}
+
+int ChromaConsoleControllerAudioProcessor::getSlotForCCNumber(int ccNumber)
+{
+    for (size_t slot = 0; slot < ccConfigurations.size(); ++slot)
+    {
+        if (ccConfigurations[slot].ccNumber == ccNumber)
+            return (int)slot;
+    }
+
+    return -1;
+}
+
+int ChromaConsoleControllerAudioProcessor::getRawValueForCC(int slot, int ccValue)
+{
+    return isModuleSlot(slot) ? juce::jlimit(0, 5, juce::roundToInt((float)ccValue / 22.0f)) : ccValue;
+}
+
+bool ChromaConsoleControllerAudioProcessor::isModuleSlot(int slot)
+{
+    if (slot < 0 || slot >= (int)ccConfigurations.size())
+        return false;
+
+    const auto& id = ccConfigurations[(size_t)slot].parameterID;
+    return id == "cModule" || id == "mModule" || id == "dModule" || id == "tModule";
+}
+
+std::array<int, ParameterSnapshot::maxSlots> ChromaConsoleControllerAudioProcessor::getSlotMaximums()
+{
+    std::array<int, ParameterSnapshot::maxSlots> maximums;
+
+    for (size_t slot = 0; slot < maximums.size(); ++slot)
+        maximums[slot] = isModuleSlot((int)slot) ? 5 : 127;
+
+    return maximums;
+}
+
+bool ChromaConsoleControllerAudioProcessor::readSnapshotFromState(const juce::ValueTree& pluginState, ParameterSnapshot& snapshot, int& midiChannel)
+{
+    // Start from the defaults so presets saved before a parameter existed still load sensibly
+    for (size_t slot = 0; slot < ccConfigurations.size(); ++slot)
+        snapshot.values[slot] = (juce::uint8)ccConfigurations[slot].defaultValue;
+
+    midiChannel = 0;
+
+    auto paramState = pluginState.getChildWithName("PARAMETERS");
+    if (!paramState.isValid())
+        return false;
+
+    static const juce::Identifier idProperty("id");
+    static const juce::Identifier valueProperty("value");
+
+    for (const auto& param : paramState)
+    {
+        auto id = param.getProperty(idProperty).toString();
+        const int value = juce::roundToInt((float)param.getProperty(valueProperty));
+
+        if (id == "midiChannel")
+        {
+            midiChannel = value;
+            continue;
+        }
+
+        const int slot = getSlotForParameterID(id);
+        if (slot >= 0)
+            snapshot.values[(size_t)slot] = (juce::uint8)juce::jlimit(0, 127, value);
+    }
+
+    return true;
+}
+
 //==============================================================================
 // This creates new instances of the plugin..
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
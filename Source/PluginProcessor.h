@@ -11,6 +11,26 @@
 #include <JuceHeader.h>
 #include "PresetManager.h"
 #include "PresetMidiHandler.h"
+#include "ParameterSnapshot.h"
+#include "RecallMask.h"
+#include "MorphEngine.h"
+#include "GlideEngine.h"
+#include "MacroEngine.h"
+#include "OutputCurves.h"
+#include "LfoBank.h"
+#include "StepSequencer.h"
+#include "EnvelopeFollower.h"
+#include "GestureRecorder.h"
+#include "ActionScheduler.h"
+#include "MidiClockGenerator.h"
+#include "MidiThruFilter.h"
+#include "MidiLearnMap.h"
+#include "SetlistPlayer.h"
+#include "PresetCompare.h"
+#include "ParameterHistory.h"
+#include "LatencyCompensation.h"
+#include "TransportInfo.h"
+#include "MidiBandwidthBudget.h"
 
 //==============================================================================
 /**
@@ -22,9 +42,11 @@ struct CCControllerConfig
     juce::String parameterID;   // Unique ID for the parameter
     juce::String name;          // Display name
     float defaultValue;   // Default value (0-127)
+    bool stepped = false; // Switches between settings (modules, bypass, modes) rather than sweeping
 };
 
-class ChromaConsoleControllerAudioProcessor  : public juce::AudioProcessor
+class ChromaConsoleControllerAudioProcessor  : public juce::AudioProcessor,
+    private juce::AudioProcessorParameter::Listener
 {
 public:
     //==============================================================================
@@ -74,20 +96,145 @@ public:
     void sendCurrentSliderValues();
     void sendMidiMessage(const juce::MidiMessage& message);
 
+    // Direct preset paths, no XML text in between
+    juce::ValueTree capturePluginState();
+    void restorePresetSections(const PresetSections& sections); // Everything in a preset besides parameter values, message thread
+    ParameterSnapshot captureSnapshot() const;
+    void applySnapshot(const ParameterSnapshot& snapshot, juce::uint32 slotMask = RecallMask::everything); // Only the slots in the mask
+    void applyMidiChannel(int channel);
+    static bool readSnapshotFromState(const juce::ValueTree& pluginState, ParameterSnapshot& snapshot, int& midiChannel);
+    static PresetSections::Ptr readSectionsFromState(const juce::ValueTree& pluginState);
+    static int getSlotForParameterID(const juce::String& parameterID);
+    static bool isModuleSlot(int slot); // Module selects are 0-5 and sent as rawValue * 22
+    static std::array<int, ParameterSnapshot::maxSlots> getSlotMaximums();
+
+    // Running fingerprint of the current parameter values, equal to captureSnapshot().getHash()
+    juce::uint64 getStateHash() const noexcept { return stateHash.load(); }
+
     PresetManager& getPresetManager() { return presetManager; }
+    MorphEngine& getMorphEngine() { return morphEngine; }
+    GlideEngine& getGlideEngine() { return glideEngine; }
+    MacroEngine& getMacroEngine() { return macroEngine; }
+    OutputCurves& getOutputCurves() { return outputCurves; }
+    LfoBank& getLfoBank() { return lfoBank; }
+    StepSequencer& getStepSequencer() { return stepSequencer; }
+    EnvelopeFollower& getEnvelopeFollower() { return envelopeFollower; }
+    GestureRecorder& getGestureRecorder() { return gestureRecorder; }
+    ActionScheduler& getActionScheduler() { return actionScheduler; }
+    MidiClockGenerator& getMidiClock() { return midiClock; }
+    MidiThruFilter& getMidiThru() { return midiThru; }
+    MidiLearnMap& getMidiLearn() { return midiLearn; }
     PresetMidiHandler& getPresetMidiHandler() { return presetMidiHandler; }
+    SetlistPlayer& getSetlistPlayer() { return setlistPlayer; }
+    PresetCompare& getPresetCompare() { return presetCompare; }
+    ParameterHistory& getParameterHistory() { return parameterHistory; }
+    LatencyCompensation& getLatencyCompensation() { return latencyCompensation; }
+
+    // Message thread
+    void updateLatencyReporting(); // After the latency mode or offset changed
+    bool startLatencyTest(); // Output Level to 0, a bar later the pulse, a bar after that back
 
     bool hasCheckedForUpdates = false;
 private:
-    std::unordered_map<int, int> previousCCValues; // CC number -> last value
+    std::array<int, ParameterSnapshot::maxSlots> lastSentValues; // Last CC value sent per slot, -1 forces a resend
+    std::atomic<bool> resendRequested{ true };
 
     juce::MidiBuffer pendingMidiMessages;
     juce::CriticalSection pendingMidiMessagesLock;
 
     PresetManager presetManager;
+    ActionScheduler actionScheduler; // Before presetMidiHandler, which queues preset changes on it
+    SetlistPlayer setlistPlayer;
     PresetMidiHandler presetMidiHandler;
+    PresetCompare presetCompare;
+    ParameterHistory parameterHistory;
+    LatencyCompensation latencyCompensation;
+    MorphEngine morphEngine;
+    GlideEngine glideEngine;
+    MacroEngine macroEngine;
+    OutputCurves outputCurves;
+    LfoBank lfoBank;
+    StepSequencer stepSequencer;
+    EnvelopeFollower envelopeFollower;
+    GestureRecorder gestureRecorder;
+    MidiClockGenerator midiClock;
+    MidiThruFilter midiThru;
+    MidiLearnMap midiLearn;
+
+    TransportInfo transport; // Current block
+    MidiBandwidthBudget midiBudget;
+
+    // Modulation is evaluated at this rate inside each block
+    static constexpr double controlRateHz = 1000.0;
+    int controlInterval = 44;
+    int tickStartSample = 0; // Start of the control tick being rendered
+
+    // Sample offsets where the output stage runs within a block (ticks, step boundaries)
+    static constexpr int maxSplitPoints = 512;
+    std::array<int, maxSplitPoints> splitPoints{};
+
+    // Cached per ccConfigurations slot, avoids looking parameters up by ID
+    std::array<juce::RangedAudioParameter*, ParameterSnapshot::maxSlots> ccParameters{};
+    std::array<std::atomic<float>*, ParameterSnapshot::maxSlots> ccRawValues{};
+    std::vector<int> parameterIndexToSlot; // Processor parameter index -> slot, -1 for non-CC parameters
+
+    std::atomic<float>* morphAmount = nullptr;
+    std::atomic<float>* morphEnabled = nullptr;
+    std::atomic<float>* morphThreshold = nullptr;
+    std::atomic<float>* glideTime = nullptr;
+    std::atomic<float>* glideMode = nullptr;
+    std::atomic<float>* presetQuantise = nullptr;
+    std::atomic<float>* actionQuantise = nullptr;
+    std::atomic<float>* midiClockEnabled = nullptr;
+    std::array<std::atomic<float>*, MacroEngine::numMacros> macroParameters{};
+    std::array<float, MacroEngine::numMacros> macroValues{};
+
+    // Working values, one per slot. Raw parameter units (0-127, 0-5 for modules).
+    // baseValues hold knobs, morph and macros for the block, slotValues add modulation per tick
+    std::array<float, ParameterSnapshot::maxSlots> baseValues{};
+    std::array<float, ParameterSnapshot::maxSlots> slotValues{};
+    std::array<float, ParameterSnapshot::maxSlots> knobValues{}; // Parameters, or a learned CC that hasn't reached them yet
+    std::array<int, ParameterSnapshot::maxSlots> previousKnobValues{}; // Knob moves since the last block are recorded as gestures
+
+    // Capture and Gesture slots send latchedValues, which follow the knob on the scheduler's grid
+    const juce::uint32 quantisedSlots;
+    std::array<int, ParameterSnapshot::maxSlots> latchedValues{};
+    std::array<int, ParameterSnapshot::maxSlots> scheduledKnobValues{}; // Knob value the last scheduled change was for
+
+    std::optional<ParameterSnapshot> triggerReturnValues; // Values from before a held momentary trigger
+
+    // Latency test pulse waiting to be sent, -1 for none
+    int latencyPulseSlot = -1;
+    int latencyPulseValue = 0;
+
+    std::atomic<juce::uint64> stateHash{ 0 };
+    std::array<std::atomic<juce::uint8>, ParameterSnapshot::maxSlots> hashedValues{};
 
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    static juce::uint32 getSlotMask(bool stepped); // Slots whose config.stepped matches
+    static juce::uint32 getModuleSlotMask();
+    static juce::uint32 getQuantisedSlotMask(); // Capture and Gesture buttons
+    static int getSlotForCCNumber(int ccNumber);
+    static int getRawValueForCC(int slot, int ccValue); // Inverse of the built-in output mapping
+
+    void readKnobValues(const juce::MidiBuffer& midiMessages);
+    void refreshKnobValues(); // Parameters, or pending learned values. No MIDI
+    void captureGestures(const juce::MidiBuffer& midiMessages, int midiChannel);
+    void updateBaseValues(); // Knobs (or latched values), then morph and macros
+    void scheduleLatchedSlots();
+    void resetLatchedSlots();
+    void performAction(const ActionScheduler::Action& action);
+
+    void renderControlTick(juce::MidiBuffer& midiMessages, int midiChannel, int startSample, int numSamples);
+    void addCCIfChanged(juce::MidiBuffer& midiMessages, int midiChannel, int slot, int ccValue, int samplePosition);
+
+    void writeBinaryState(juce::MemoryBlock& destData);
+    bool readBinaryState(const void* data, int sizeInBytes);
+    juce::RangedAudioParameter* getParameterStoredByID(int parameterIndex) const; // Non-CC parameters the PVAL chunk holds, nullptr for the rest
+
+    // AudioProcessorParameter::Listener, keeps stateHash up to date
+    void parameterValueChanged(int parameterIndex, float newValue) override;
+    void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override;
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChromaConsoleControllerAudioProcessor)
 };
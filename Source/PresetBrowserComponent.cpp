@@ -10,11 +10,11 @@
 
 #include "PresetBrowserComponent.h"
 
-PresetBrowserComponent::PresetBrowserComponent(PresetManager& pm, PresetMidiHandler& mh)
-    : presetManager(pm), presetMidiHandler(mh)
+PresetBrowserComponent::PresetBrowserComponent(PresetManager& pm, PresetMidiHandler& mh, SetlistPlayer& sp, PresetCompare& pc)
+    : presetManager(pm), presetMidiHandler(mh), setlistPlayer(sp), presetCompare(pc)
 {
     // Create list box model
-    listBoxModel = std::make_unique<PresetListBoxModel>(presetManager);
+    listBoxModel = std::make_unique<PresetListBoxModel>(presetManager, presetCompare);
 
     // Setup category selector
     categorySelector.addItem("All Presets", 1);
@@ -35,15 +35,64 @@ PresetBrowserComponent::PresetBrowserComponent(PresetManager& pm, PresetMidiHand
     presetListBox.setColour(juce::ListBox::backgroundColourId, juce::Colour::fromHSL((0.0f), 0.00f, .04f, 1.0f));
     addAndMakeVisible(presetListBox);
 
-    // Set up navigation buttons
+    // Set up navigation buttons. With a setlist active they step through it instead
     previousButton.setButtonText("<");
-    previousButton.onClick = [this] { presetManager.loadPreviousPreset(); };
+    previousButton.onClick = [this]
+        {
+            if (setlistPlayer.isActive())
+                setlistPlayer.requestStep(-1);
+            else
+                presetManager.loadPreviousPreset();
+        };
     addAndMakeVisible(previousButton);
 
     nextButton.setButtonText(">");
-    nextButton.onClick = [this] { presetManager.loadNextPreset(); };
+    nextButton.onClick = [this]
+        {
+            if (setlistPlayer.isActive())
+                setlistPlayer.requestStep(1);
+            else
+                presetManager.loadNextPreset();
+        };
     addAndMakeVisible(nextButton);
 
+    setlistButton.setButtonText("Setlist");
+    setlistButton.onClick = [this] { showSetlistMenu(); };
+    addAndMakeVisible(setlistButton);
+
+    recallButton.onClick = [this] { showRecallMenu(); };
+    addAndMakeVisible(recallButton);
+
+    // A/B compare. An empty slot takes the current values, switching keeps edits
+    compareAButton.setButtonText("A");
+    compareAButton.onClick = [this] { presetCompare.switchToSlot(PresetCompare::slotA); };
+    addAndMakeVisible(compareAButton);
+
+    compareBButton.setButtonText("B");
+    compareBButton.onClick = [this] { presetCompare.switchToSlot(PresetCompare::slotB); };
+    addAndMakeVisible(compareBButton);
+
+    copySlotButton.setButtonText("Copy");
+    copySlotButton.setTooltip("Copy the current values to the other slot");
+    copySlotButton.onClick = [this] { presetCompare.copyToOtherSlot(); };
+    addAndMakeVisible(copySlotButton);
+
+    // While on, clicking a preset only auditions it. Turning it off goes back
+    auditionButton.setButtonText("Audition");
+    auditionButton.setTooltip("Click a preset to hear it, double click to load it");
+    auditionButton.setClickingTogglesState(true);
+    auditionButton.setToggleState(presetCompare.isAuditioning(), juce::dontSendNotification);
+    listBoxModel->setAuditionMode(presetCompare.isAuditioning());
+    auditionButton.onClick = [this]
+        {
+            const bool auditioning = auditionButton.getToggleState();
+            listBoxModel->setAuditionMode(auditioning);
+
+            if (!auditioning)
+                presetCompare.endAudition(false);
+        };
+    addAndMakeVisible(auditionButton);
+
     // Set up action buttons
     saveButton.setButtonText("Save");
     saveButton.onClick = [this] { showSavePresetDialog(); };
@@ -67,8 +116,8 @@ PresetBrowserComponent::PresetBrowserComponent(PresetManager& pm, PresetMidiHand
         };
     addAndMakeVisible(preserveMidiChannelButton);
 
-    // Setup current preset label
-    currentPresetLabel.setText("No Preset Loaded", juce::dontSendNotification);
+    // Setup current preset label. Opening the browser starts the catalog load if nothing has yet
+    setCurrentPresetText(presetManager.isLoading() ? "Loading Presets..." : "No Preset Loaded");
     currentPresetLabel.setJustificationType(juce::Justification::centred);
     currentPresetLabel.setFont(juce::Font(13.0f));
     addAndMakeVisible(currentPresetLabel);
@@ -114,6 +163,22 @@ void PresetBrowserComponent::resized()
     previousButton.setBounds(navArea.removeFromLeft(40));
     navArea.removeFromLeft(5);
     nextButton.setBounds(navArea.removeFromLeft(40));
+    navArea.removeFromLeft(5);
+    auto setlistWidth = (navArea.getWidth() - 5) / 2;
+    setlistButton.setBounds(navArea.removeFromLeft(setlistWidth));
+    navArea.removeFromLeft(5);
+    recallButton.setBounds(navArea);
+    bounds.removeFromTop(5);
+
+    // Compare and audition
+    auto compareArea = bounds.removeFromTop(25);
+    compareAButton.setBounds(compareArea.removeFromLeft(40));
+    compareArea.removeFromLeft(5);
+    compareBButton.setBounds(compareArea.removeFromLeft(40));
+    compareArea.removeFromLeft(5);
+    copySlotButton.setBounds(compareArea.removeFromLeft(55));
+    compareArea.removeFromLeft(5);
+    auditionButton.setBounds(compareArea);
     bounds.removeFromTop(10);
 
     // Category Selector
@@ -141,7 +206,7 @@ void PresetBrowserComponent::resized()
 
 void PresetBrowserComponent::presetLoaded(const PresetManager::Preset& preset)
 {
-    currentPresetLabel.setText(preset.name + " (" + preset.category + ")", juce::dontSendNotification);
+    setCurrentPresetText(preset.name + " (" + preset.category + ")");
     presetListBox.repaint();
 }
 
@@ -171,7 +236,7 @@ void PresetBrowserComponent::currentPresetChanged()
     auto currentPreset = presetManager.getCurrentPreset();
     if (currentPreset)
     {
-        currentPresetLabel.setText(currentPreset->name + " (" + currentPreset->category + ")", juce::dontSendNotification);
+        setCurrentPresetText(currentPreset->name + " (" + currentPreset->category + ")");
 
         // Reset category filter to show all presets
         categorySelector.setSelectedId(1, juce::sendNotification);
@@ -190,7 +255,7 @@ void PresetBrowserComponent::currentPresetChanged()
     else
     {
         // No preset loaded - reset to default state
-        currentPresetLabel.setText("No Preset Loaded", juce::dontSendNotification);
+        setCurrentPresetText("No Preset Loaded");
         presetListBox.deselectAllRows();
     }
 }
@@ -205,6 +270,64 @@ void PresetBrowserComponent::timerCallback()
     preserveMidiChannelButton.setToggleState(
         presetManager.getPreserveMidiChannel(),
         juce::dontSendNotification);
+
+    // Setlist position follows footswitch steps made on the audio thread
+    juce::String setlistText = "Setlist";
+    if (setlistPlayer.isActive())
+    {
+        const int numEntries = (int)setlistPlayer.getEntries().size();
+        setlistText = "Setlist " + (setlistPlayer.getPosition() < 0 ? juce::String("-") : juce::String(setlistPlayer.getPosition() + 1))
+            + "/" + juce::String(numEntries);
+    }
+    if (setlistButton.getButtonText() != setlistText)
+        setlistButton.setButtonText(setlistText);
+    setlistButton.setToggleState(setlistPlayer.isActive(), juce::dontSendNotification);
+
+    compareAButton.setToggleState(presetCompare.getLiveSlot() == PresetCompare::slotA, juce::dontSendNotification);
+    compareBButton.setToggleState(presetCompare.getLiveSlot() == PresetCompare::slotB, juce::dontSendNotification);
+    copySlotButton.setEnabled(presetCompare.getLiveSlot() >= 0);
+
+    // Full description in the tooltip, the button only has room for a word
+    const auto recallMask = presetManager.getRecallMask();
+    const juce::String recallText = RecallMask::coversAllSlots(recallMask) ? "Recall: All" : "Recall: Partial";
+    if (recallButton.getButtonText() != recallText)
+        recallButton.setButtonText(recallText);
+
+    const auto recallTooltip = "Preset loads change: " + RecallMask::describe(recallMask);
+    if (recallButton.getTooltip() != recallTooltip)
+        recallButton.setTooltip(recallTooltip);
+
+    // Cheap hash compare, fine to poll
+    if (presetManager.isCurrentPresetModified() != showingModified)
+        updateCurrentPresetLabel();
+}
+
+void PresetBrowserComponent::setCurrentPresetText(const juce::String& text)
+{
+    currentPresetText = text;
+    updateCurrentPresetLabel();
+}
+
+void PresetBrowserComponent::updateCurrentPresetLabel()
+{
+    showingModified = presetManager.isCurrentPresetModified();
+    currentPresetLabel.setText(showingModified ? currentPresetText + " *" : currentPresetText, juce::dontSendNotification);
+
+    // Point out identical presets elsewhere in the library
+    juce::String tooltip;
+    if (auto currentPreset = presetManager.getCurrentPreset())
+    {
+        auto duplicates = presetManager.findDuplicatesOf(*currentPreset);
+        if (!duplicates.isEmpty())
+        {
+            juce::StringArray names;
+            for (const auto& duplicate : duplicates)
+                names.add(duplicate.name + " (" + duplicate.category + ")");
+            tooltip = "Same settings as: " + names.joinIntoString(", ");
+        }
+    }
+
+    currentPresetLabel.setTooltip(showingModified ? "Modified since the preset was loaded" : tooltip);
 }
 
 void PresetBrowserComponent::updatePresetList()
@@ -293,6 +416,98 @@ void PresetBrowserComponent::showDeletePresetDialog()
         }), true);
 }
 
+void PresetBrowserComponent::showSetlistMenu()
+{
+    juce::PopupMenu menu;
+
+    const auto setlistName = setlistPlayer.getName();
+    menu.addSectionHeader(setlistName.isEmpty() ? juce::String("Untitled Setlist") : setlistName);
+    menu.addItem("Active", true, setlistPlayer.isActive(), [this] { setlistPlayer.setActive(!setlistPlayer.isActive()); });
+    menu.addSeparator();
+
+    // Entries by program number, so only presets that have one can be added
+    auto currentPreset = presetManager.getCurrentPreset();
+    const int currentProgram = currentPreset ? currentPreset->program : -1;
+    menu.addItem("Add Current Preset", currentProgram >= 0, false, [this, currentProgram] { setlistPlayer.addEntry(currentProgram); });
+
+    const auto names = setlistPlayer.getEntryNames();
+    menu.addItem("Remove Last Entry", !names.isEmpty(), false, [this] { setlistPlayer.removeLastEntry(); });
+
+    // Each entry jumps there or picks what it recalls
+    const auto entries = setlistPlayer.getEntries();
+    juce::PopupMenu entriesMenu;
+    for (int i = 0; i < names.size() && i < (int)entries.size(); ++i)
+    {
+        const auto recallMask = entries[(size_t)i].recallMask;
+
+        juce::PopupMenu entryMenu;
+        entryMenu.addItem("Jump Here", setlistPlayer.isActive(), false, [this, i] { setlistPlayer.requestJump(i); });
+        entryMenu.addSubMenu("Recall: " + RecallMask::describe(recallMask),
+            RecallMask::createMenu(recallMask, [this, i](juce::uint32 mask) { setlistPlayer.setEntryRecallMask(i, mask); }));
+
+        entriesMenu.addSubMenu(juce::String(i + 1) + ". " + names[i], entryMenu, true, nullptr, i == setlistPlayer.getPosition());
+    }
+    menu.addSubMenu("Entries", entriesMenu, !names.isEmpty());
+    menu.addSeparator();
+
+    // Footswitch controls, learned from the next matching MIDI message
+    for (bool forNext : { true, false })
+    {
+        const auto label = juce::String(forNext ? "Next" : "Previous") + " Control: "
+            + SetlistPlayer::describe(setlistPlayer.getControl(forNext));
+
+        juce::PopupMenu controlMenu;
+        controlMenu.addItem("Learn", [this, forNext] { setlistPlayer.startLearningControl(forNext); });
+        controlMenu.addItem("Clear", [this, forNext] { setlistPlayer.setControl(forNext, {}); });
+        menu.addSubMenu(label, controlMenu);
+    }
+    menu.addSeparator();
+
+    juce::PopupMenu openMenu;
+    for (const auto& file : setlistPlayer.findSetlistFiles())
+    {
+        openMenu.addItem(file.getFileNameWithoutExtension(), [this, file]
+            {
+                if (!setlistPlayer.loadFromFile(file))
+                    juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Setlist", "Could not open " + file.getFileName());
+            });
+    }
+    menu.addSubMenu("Open", openMenu, openMenu.getNumItems() > 0);
+    menu.addItem("Save As...", [this] { showSaveSetlistDialog(); });
+    menu.addItem("New", [this] { setlistPlayer.setEntries({}, {}); });
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&setlistButton));
+}
+
+void PresetBrowserComponent::showRecallMenu()
+{
+    auto menu = RecallMask::createMenu(presetManager.getRecallMask(), [this](juce::uint32 mask) { presetManager.setRecallMask(mask); });
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&recallButton));
+}
+
+void PresetBrowserComponent::showSaveSetlistDialog()
+{
+    auto* window = new juce::AlertWindow("Save Setlist", "Enter Setlist Name:", juce::AlertWindow::NoIcon);
+
+    window->addTextEditor("setlistName", setlistPlayer.getName(), "Setlist Name:");
+    window->addButton("Save", 1, juce::KeyPress(juce::KeyPress::returnKey));
+    window->addButton("Cancel", 0, juce::KeyPress(juce::KeyPress::escapeKey));
+
+    window->enterModalState(true, juce::ModalCallbackFunction::create([this, window](int result)
+        {
+            if (result != 1)
+                return;
+
+            auto setlistName = juce::File::createLegalFileName(window->getTextEditorContents("setlistName").trim());
+            if (setlistName.isEmpty())
+                return;
+
+            auto file = setlistPlayer.getSetlistDirectory().getChildFile(setlistName + SetlistPlayer::SETLIST_EXTENSION);
+            if (!setlistPlayer.saveToFile(file))
+                juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Setlist", "Could not save " + file.getFileName());
+        }), true);
+}
+
 void PresetBrowserComponent::showMidiMappingDialog()
 {
     juce::File presetFile;
@@ -314,10 +529,10 @@ void PresetBrowserComponent::showMidiMappingDialog()
     juce::Component::SafePointer<MidiLearnDialog> safeDialog(dialog);
 
     // Callbacks
-    presetMidiHandler.setMidiLearnCallback([safeDialog](int note) {
-        juce::MessageManager::callAsync([safeDialog, note]() {
+    presetMidiHandler.setMidiLearnCallback([safeDialog](int note, int channel) {
+        juce::MessageManager::callAsync([safeDialog, note, channel]() {
             if (safeDialog != nullptr)
-                safeDialog->midiNoteReceived(note);
+                safeDialog->midiNoteReceived(note, channel);
             });
         });
 
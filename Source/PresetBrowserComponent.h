@@ -14,6 +14,8 @@
 #include "PresetManager.h"
 #include "MidiLearnDialog.h"
 #include "PresetMidiHandler.h"
+#include "SetlistPlayer.h"
+#include "PresetCompare.h"
 
 /*
 UI Component for browsing and managing presets
@@ -25,7 +27,7 @@ class PresetBrowserComponent : public juce::Component,
     private juce::Timer
 {
 public:
-    PresetBrowserComponent(PresetManager& pm, PresetMidiHandler& mh);
+    PresetBrowserComponent(PresetManager& pm, PresetMidiHandler& mh, SetlistPlayer& sp, PresetCompare& pc);
     ~PresetBrowserComponent() override;
 
     void paint(juce::Graphics& g) override;
@@ -42,21 +44,37 @@ private:
     void showSavePresetDialog();
     void showDeletePresetDialog();
     void showMidiMappingDialog();
+    void showSetlistMenu();
+    void showRecallMenu();
+    void showSaveSetlistDialog();
     void updatePreserveMidiChannelButton();
+    void setCurrentPresetText(const juce::String& text);
+    void updateCurrentPresetLabel();
 
     PresetManager& presetManager;
     PresetMidiHandler& presetMidiHandler;
+    SetlistPlayer& setlistPlayer;
+    PresetCompare& presetCompare;
 
     // UI Components
     juce::ComboBox categorySelector;
     juce::ListBox presetListBox;
     juce::TextButton previousButton;
     juce::TextButton nextButton;
+    juce::TextButton setlistButton;
+    juce::TextButton recallButton;
+    juce::TextButton compareAButton;
+    juce::TextButton compareBButton;
+    juce::TextButton copySlotButton;
+    juce::TextButton auditionButton;
     juce::TextButton saveButton;
     juce::TextButton deleteButton;
     juce::TextButton midiMapButton;
     juce::TextButton preserveMidiChannelButton;
     juce::Label currentPresetLabel;
+    juce::String currentPresetText;
+    bool showingModified = false;
+    juce::TooltipWindow tooltipWindow{ this, 600 };
 
     // Preset List Model
     class PresetListBoxModel;
@@ -70,7 +88,7 @@ private:
 class PresetBrowserComponent::PresetListBoxModel : public juce::ListBoxModel
 {
 public:
-    PresetListBoxModel(PresetManager& pm) : presetManager(pm) {}
+    PresetListBoxModel(PresetManager& pm, PresetCompare& pc) : presetManager(pm), presetCompare(pc) {}
 
     int getNumRows() override
     {
@@ -93,7 +111,16 @@ public:
         g.setFont(14.0f);
 
         // Draw preset name
-        g.drawText(preset.name, 10, 0, width - 60, height, juce::Justification::centredLeft);
+        g.drawText(preset.name, 10, 0, width - 105, height, juce::Justification::centredLeft);
+
+        // Bank and program that recall it, next to the Midi indicator
+        if (preset.program >= 0)
+        {
+            g.setColour(juce::Colours::grey);
+            g.setFont(11.0f);
+            g.drawText(juce::String(preset.program / 128) + ":" + juce::String(preset.program % 128), width - 95, 0, 45, height, juce::Justification::centredRight);
+            g.setFont(14.0f);
+        }
 
         // Draw Midi indicator if mapped
         if (preset.midiNote >= 0)
@@ -103,12 +130,60 @@ public:
         }
     }
 
-    void listBoxItemClicked(int row, const juce::MouseEvent&) override
+    void listBoxItemClicked(int row, const juce::MouseEvent& e) override
     {
-        if (row >= 0 && row < filteredPresets.size())
+        if (row < 0 || row >= filteredPresets.size())
+            return;
+
+        auto presetFile = filteredPresets[row].file;
+
+        if (e.mods.isPopupMenu())
+        {
+            // Right click picks the presets the Morph parameter blends between
+            juce::PopupMenu menu;
+            menu.addItem("Set as Morph A", [this, presetFile] { presetManager.setMorphSource(MorphEngine::sourceA, presetFile); });
+            menu.addItem("Set as Morph B", [this, presetFile] { presetManager.setMorphSource(MorphEngine::sourceB, presetFile); });
+
+            // Numbers of deleted presets stay reserved, this hands one on or frees it
+            juce::PopupMenu takeMenu, releaseMenu;
+            for (const auto& reserved : presetManager.getReservedPrograms())
+            {
+                const auto name = juce::String(reserved.program / 128) + ":" + juce::String(reserved.program % 128) + " (" + reserved.presetName + ")";
+                const int program = reserved.program;
+                takeMenu.addItem(name, [this, presetFile, program] { presetManager.takeProgramNumber(presetFile, program); });
+                releaseMenu.addItem(name, [this, program] { presetManager.releaseProgramNumber(program); });
+            }
+
+            menu.addSeparator();
+            menu.addSubMenu("Take Program Number", takeMenu, takeMenu.getNumItems() > 0);
+            menu.addSubMenu("Free Program Number", releaseMenu, releaseMenu.getNumItems() > 0);
+            menu.showMenuAsync(juce::PopupMenu::Options());
+            return;
+        }
+
+        // Auditioning only sends the preset's values, a double click loads it for real
+        if (auditionMode)
         {
-            presetManager.loadPreset(filteredPresets[row].file);
+            const auto& preset = filteredPresets.getReference(row);
+            if (preset.hasSnapshot)
+                presetCompare.audition(preset.snapshot, presetManager.getRecallMask());
         }
+        else
+            presetManager.loadPreset(presetFile);
+    }
+
+    void listBoxItemDoubleClicked(int row, const juce::MouseEvent&) override
+    {
+        if (!auditionMode || row < 0 || row >= filteredPresets.size())
+            return;
+
+        presetCompare.endAudition(true);
+        presetManager.loadPreset(filteredPresets[row].file);
+    }
+
+    void setAuditionMode(bool shouldAudition)
+    {
+        auditionMode = shouldAudition;
     }
 
     void setFilteredPresets(const juce::Array<PresetManager::Preset>& presets)
@@ -123,5 +198,7 @@ public:
 
 private:
     PresetManager& presetManager;
+    PresetCompare& presetCompare;
     juce::Array<PresetManager::Preset> filteredPresets;
+    bool auditionMode = false;
 };
\ No newline at end of file
@@ -0,0 +1,925 @@
+/*
+  ==============================================================================
+
+    PresetCatalog.cpp
+    Created: 19 Oct 2026 10:12:40am
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "PresetCatalog.h"
+#include "PluginProcessor.h"
+
+int PresetCatalog::Snapshot::indexOf(const juce::File& presetFile) const
+{
+    for (int i = 0; i < presets.size(); i++)
+    {
+        if (presets.getReference(i).file == presetFile)
+            return i;
+    }
+
+    return -1;
+}
+
+juce::Array<int> PresetCatalog::Snapshot::findPresetsWithHash(juce::uint64 hash) const
+{
+    juce::Array<int> result;
+
+    auto it = std::lower_bound(hashIndex.begin(), hashIndex.end(), std::make_pair(hash, 0));
+    for (; it != hashIndex.end() && it->first == hash; ++it)
+        result.add(it->second);
+
+    return result;
+}
+
+void PresetCatalog::Snapshot::buildHashIndex()
+{
+    hashIndex.clear();
+    hashIndex.reserve((size_t)presets.size());
+
+    for (int i = 0; i < presets.size(); i++)
+    {
+        if (presets.getReference(i).hasSnapshot)
+            hashIndex.emplace_back(presets.getReference(i).hash, i);
+    }
+
+    std::sort(hashIndex.begin(), hashIndex.end());
+}
+
+void PresetCatalog::Snapshot::buildProgramTable()
+{
+    programTable.assign((size_t)maxPrograms, -1);
+    numPrograms = 0;
+
+    for (int i = 0; i < presets.size(); i++)
+    {
+        const int program = presets.getReference(i).program;
+        if (juce::isPositiveAndBelow(program, maxPrograms))
+        {
+            programTable[(size_t)program] = i;
+            numPrograms = juce::jmax(numPrograms, program + 1);
+        }
+    }
+
+    programNames = new ProgramNames();
+    for (int program = 0; program < numPrograms; ++program)
+    {
+        const int index = programTable[(size_t)program];
+        programNames->names.add(index >= 0 ? presets.getReference(index).name : juce::String());
+    }
+}
+
+int PresetCatalog::Snapshot::indexOfProgram(int program) const noexcept
+{
+    if (!juce::isPositiveAndBelow(program, (int)programTable.size()))
+        return -1;
+
+    return programTable[(size_t)program];
+}
+
+//==============================================================================
+PresetCatalog::PresetCatalog() : Thread("PresetCatalogLoader")
+{
+    // Set default preset directory (plugin data folder).
+    // Nothing touches the disk here; the loader thread creates and scans it
+    auto appData = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory);
+    directory = appData.getChildFile(JucePlugin_Manufacturer)
+        .getChildFile(JucePlugin_Name)
+        .getChildFile("Presets");
+
+    snapshot = new Snapshot();
+    snapshot->directory = directory;
+}
+
+PresetCatalog::~PresetCatalog()
+{
+    stopThread(4000);
+    cancelPendingUpdate();
+
+    // Only the last instance in the process gets here, so this is the single write on shutdown.
+    // Skip it if the mappings never finished loading, otherwise we'd overwrite them with nothing
+    if (loadState.load() == ready)
+    {
+        const juce::ScopedLock wl(writeLock);
+        saveMidiMappings();
+    }
+}
+
+void PresetCatalog::ensureLoaded()
+{
+    int expected = notLoaded;
+    if (loadState.compare_exchange_strong(expected, loading))
+        requestLoad();
+}
+
+void PresetCatalog::requestLoad()
+{
+    {
+        const juce::ScopedLock sl(loadLock);
+        ++loadGeneration;
+        reloadRequested.store(true);
+    }
+
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::background);
+    else
+        notify();
+}
+
+bool PresetCatalog::waitUntilLoaded()
+{
+    // Only used by writes, which must not run against a half-loaded mapping table.
+    // Message thread only, the audio thread never writes to the catalog
+    ensureLoaded();
+    return loadedEvent.wait(loadTimeoutMs);
+}
+
+void PresetCatalog::run()
+{
+    while (!threadShouldExit())
+    {
+        juce::uint32 generation;
+        {
+            const juce::ScopedLock sl(loadLock);
+            if (!reloadRequested.exchange(false))
+                generation = 0;
+            else
+                generation = loadGeneration;
+        }
+
+        if (generation == 0)
+        {
+            wait(-1);
+            continue;
+        }
+
+        auto dir = getDirectory();
+
+        {
+            const juce::ScopedLock wl(writeLock);
+
+            // Create directory if it doesn't exist
+            if (!dir.exists())
+                dir.createDirectory();
+
+            loadMidiMappings();
+            scanPresetsInDirectory();
+        }
+
+        {
+            // Directory changed while we were scanning, go again. Checked under the lock,
+            // so a setDirectory can't land between this check and publishing
+            const juce::ScopedLock sl(loadLock);
+            if (generation != loadGeneration)
+                continue;
+
+            loadState.store(ready);
+            loadedEvent.signal();
+        }
+
+        triggerAsyncUpdate();
+    }
+}
+
+void PresetCatalog::handleAsyncUpdate()
+{
+    notifyCatalogChanged();
+    listeners.call([](Listener& l) { l.catalogLoaded(); });
+}
+
+PresetCatalog::Snapshot::Ptr PresetCatalog::getSnapshot()
+{
+    ensureLoaded();
+
+    const juce::ScopedLock sl(snapshotLock);
+    return snapshot;
+}
+
+PresetCatalog::ProgramNames::Ptr PresetCatalog::getProgramNames()
+{
+    if (loadState.load() == ready)
+    {
+        const juce::ScopedLock sl(snapshotLock);
+        if (snapshot->programNames != nullptr)
+            return snapshot->programNames;
+    }
+
+    const juce::ScopedLock sl(programNamesLock);
+
+    if (savedProgramNames == nullptr)
+        savedProgramNames = readProgramNames(getDirectory().getChildFile(MIDI_MAPPING_FILE));
+
+    return savedProgramNames;
+}
+
+PresetCatalog::ProgramNames::Ptr PresetCatalog::readProgramNames(const juce::File& mappingFile)
+{
+    ProgramNames::Ptr programNames = new ProgramNames();
+
+    auto xml = mappingFile.existsAsFile() ? juce::XmlDocument::parse(mappingFile) : nullptr;
+    if (xml == nullptr)
+        return programNames;
+
+    for (auto* item : xml->getChildWithTagNameIterator("Program"))
+    {
+        const int program = item->getIntAttribute("number", -1);
+        if (!juce::isPositiveAndBelow(program, maxPrograms))
+            continue;
+
+        while (programNames->names.size() <= program)
+            programNames->names.add({});
+
+        programNames->names.set(program, item->getStringAttribute("name"));
+    }
+
+    return programNames;
+}
+
+//==============================================================================
+juce::File PresetCatalog::getDirectory() const
+{
+    const juce::ScopedLock sl(directoryLock);
+    return directory;
+}
+
+void PresetCatalog::setDirectory(const juce::File& newDirectory)
+{
+    if (newDirectory == getDirectory())
+    {
+        ensureLoaded();
+        return;
+    }
+
+    if (loadState.load() == ready)
+    {
+        const juce::ScopedLock wl(writeLock);
+        saveMidiMappings();
+    }
+
+    {
+        // Reload in the background, callers see the loading state until it's done
+        const juce::ScopedLock sl(loadLock);
+        {
+            const juce::ScopedLock dl(directoryLock);
+            directory = newDirectory;
+        }
+
+        {
+            const juce::ScopedLock nl(programNamesLock);
+            savedProgramNames = nullptr;
+        }
+
+        loadedEvent.reset();
+        loadState.store(loading);
+    }
+
+    requestLoad();
+}
+
+void PresetCatalog::rescan()
+{
+    if (!waitUntilLoaded())
+        return;
+
+    {
+        const juce::ScopedLock wl(writeLock);
+        scanPresetsInDirectory();
+    }
+
+    notifyCatalogChanged();
+}
+
+//==============================================================================
+bool PresetCatalog::writePreset(const juce::File& presetFile, const juce::ValueTree& presetState)
+{
+    if (!waitUntilLoaded())
+        return false;
+
+    {
+        const juce::ScopedLock wl(writeLock);
+
+        auto xml = presetState.createXml();
+        if (xml == nullptr || !xml->writeToFile(presetFile, {}))
+            return false;
+
+        scanPresetsInDirectory();
+    }
+
+    notifyCatalogChanged();
+    return true;
+}
+
+bool PresetCatalog::deletePreset(const juce::File& presetFile)
+{
+    if (!presetFile.existsAsFile())
+        return false;
+
+    if (!waitUntilLoaded())
+        return false;
+
+    {
+        const juce::ScopedLock wl(writeLock);
+
+        // A preset that couldn't be deleted keeps its note
+        if (!presetFile.deleteFile())
+            return false;
+
+        removeMidiMappingsForPreset(presetFile);
+        saveMidiMappings();
+        scanPresetsInDirectory();
+    }
+
+    notifyCatalogChanged();
+    return true;
+}
+
+//==============================================================================
+void PresetCatalog::setMidiMapping(int midiNote, const juce::File& presetFile)
+{
+    if (midiNote < 0 || midiNote > 127)
+        return;
+
+    if (!waitUntilLoaded())
+        return;
+
+    {
+        const juce::ScopedLock wl(writeLock);
+
+        // A preset only keeps one note, so drop any other note it had
+        removeMidiMappingsForPreset(presetFile, midiNote);
+
+        {
+            const juce::ScopedLock sl(midiMappingLock);
+            midiNoteToPreset.set(midiNote, presetFile);
+        }
+
+        saveMidiMappings();
+        publishMidiNotes();
+    }
+
+    notifyCatalogChanged();
+}
+
+void PresetCatalog::removeMidiMapping(int midiNote)
+{
+    if (!waitUntilLoaded())
+        return;
+
+    {
+        const juce::ScopedLock wl(writeLock);
+        {
+            const juce::ScopedLock sl(midiMappingLock);
+            midiNoteToPreset.remove(midiNote);
+        }
+
+        saveMidiMappings();
+        publishMidiNotes();
+    }
+
+    notifyCatalogChanged();
+}
+
+// Caller must hold writeLock
+void PresetCatalog::removeMidiMappingsForPreset(const juce::File& presetFile, int noteToKeep)
+{
+    const juce::ScopedLock sl(midiMappingLock);
+    juce::Array<int> notesToRemove;
+
+    for (juce::HashMap<int, juce::File>::Iterator i(midiNoteToPreset); i.next();)
+    {
+        if (i.getValue() == presetFile && i.getKey() != noteToKeep)
+            notesToRemove.add(i.getKey());
+    }
+
+    for (auto note : notesToRemove)
+        midiNoteToPreset.remove(note);
+}
+
+juce::File PresetCatalog::getPresetForMidiNote(int midiNote)
+{
+    // Empty until loaded, so early triggers are simply ignored
+    ensureLoaded();
+
+    const juce::ScopedLock sl(midiMappingLock);
+    if (midiNoteToPreset.contains(midiNote))
+        return midiNoteToPreset[midiNote];
+
+    return {};
+}
+
+int PresetCatalog::getMidiNoteForPreset(const juce::File& presetFile)
+{
+    ensureLoaded();
+    return findMidiNoteForPreset(presetFile);
+}
+
+std::map<int, juce::File> PresetCatalog::getMidiMappings()
+{
+    ensureLoaded();
+
+    const juce::ScopedLock sl(midiMappingLock);
+    std::map<int, juce::File> mappings;
+
+    for (juce::HashMap<int, juce::File>::Iterator i(midiNoteToPreset); i.next();)
+        mappings[i.getKey()] = i.getValue();
+
+    return mappings;
+}
+
+//==============================================================================
+void PresetCatalog::setNoteTrigger(int channel, int midiNote, const NoteTriggerMatrix::Layer& layer)
+{
+    if (!waitUntilLoaded())
+        return;
+
+    {
+        const juce::ScopedLock wl(writeLock);
+        {
+            const juce::ScopedLock sl(midiMappingLock);
+            noteTriggers.setLayer(channel, midiNote, layer);
+        }
+
+        saveMidiMappings();
+    }
+
+    notifyCatalogChanged();
+}
+
+void PresetCatalog::clearNoteTriggersForPreset(int program)
+{
+    if (!waitUntilLoaded())
+        return;
+
+    {
+        const juce::ScopedLock wl(writeLock);
+        {
+            const juce::ScopedLock sl(midiMappingLock);
+            noteTriggers.clearPreset(program);
+        }
+
+        saveMidiMappings();
+    }
+
+    notifyCatalogChanged();
+}
+
+NoteTriggerMatrix PresetCatalog::getNoteTriggers() const
+{
+    const juce::ScopedLock sl(midiMappingLock);
+    return noteTriggers;
+}
+
+//==============================================================================
+std::vector<PresetCatalog::ReservedProgram> PresetCatalog::getReservedPrograms()
+{
+    auto current = getSnapshot();
+    std::vector<ReservedProgram> reserved;
+
+    const juce::ScopedLock sl(midiMappingLock);
+
+    for (juce::HashMap<juce::String, ProgramEntry>::Iterator i(presetToProgram); i.next();)
+    {
+        if (current->indexOfProgram(i.getValue().program) < 0)
+            reserved.push_back({ i.getValue().program, juce::File(i.getKey()).getFileNameWithoutExtension() });
+    }
+
+    std::sort(reserved.begin(), reserved.end(), [](const auto& a, const auto& b) { return a.program < b.program; });
+    return reserved;
+}
+
+bool PresetCatalog::takeProgramNumber(const juce::File& presetFile, int program)
+{
+    if (!waitUntilLoaded())
+        return false;
+
+    {
+        const juce::ScopedLock wl(writeLock);
+
+        // Only numbers no preset in the library holds
+        if (getSnapshot()->indexOfProgram(program) >= 0)
+            return false;
+
+        {
+            const juce::ScopedLock sl(midiMappingLock);
+
+            const auto path = presetFile.getFullPathName();
+            if (!presetToProgram.contains(path))
+                return false;
+
+            juce::String reservedPath;
+            for (juce::HashMap<juce::String, ProgramEntry>::Iterator i(presetToProgram); i.next();)
+            {
+                if (i.getValue().program == program)
+                    reservedPath = i.getKey();
+            }
+
+            if (reservedPath.isEmpty())
+                return false;
+
+            // The preset's old number is given up, its triggers go with it. Triggers
+            // on the reserved number now recall this preset, which is the point
+            auto entry = presetToProgram[path];
+            noteTriggers.clearPreset(entry.program);
+
+            presetToProgram.remove(reservedPath);
+            entry.program = program;
+            presetToProgram.set(path, entry);
+        }
+
+        saveMidiMappings();
+        scanPresetsInDirectory();
+    }
+
+    notifyCatalogChanged();
+    return true;
+}
+
+void PresetCatalog::releaseProgramNumber(int program)
+{
+    if (!waitUntilLoaded())
+        return;
+
+    {
+        const juce::ScopedLock wl(writeLock);
+
+        if (getSnapshot()->indexOfProgram(program) >= 0)
+            return;
+
+        {
+            const juce::ScopedLock sl(midiMappingLock);
+
+            juce::String reservedPath;
+            for (juce::HashMap<juce::String, ProgramEntry>::Iterator i(presetToProgram); i.next();)
+            {
+                if (i.getValue().program == program)
+                    reservedPath = i.getKey();
+            }
+
+            if (reservedPath.isEmpty())
+                return;
+
+            presetToProgram.remove(reservedPath);
+            noteTriggers.clearPreset(program);
+        }
+
+        saveMidiMappings();
+    }
+
+    notifyCatalogChanged();
+}
+
+int PresetCatalog::findMidiNoteForPreset(const juce::File& presetFile) const
+{
+    const juce::ScopedLock sl(midiMappingLock);
+
+    for (juce::HashMap<int, juce::File>::Iterator i(midiNoteToPreset); i.next();)
+    {
+        if (i.getValue() == presetFile)
+            return i.getKey();
+    }
+
+    return -1;
+}
+
+//==============================================================================
+void PresetCatalog::addListener(Listener* listener)
+{
+    listeners.add(listener);
+}
+
+void PresetCatalog::removeListener(Listener* listener)
+{
+    listeners.remove(listener);
+}
+
+void PresetCatalog::notifyCatalogChanged()
+{
+    listeners.call([](Listener& l) { l.catalogChanged(); });
+}
+
+//==============================================================================
+// Caller must hold writeLock
+void PresetCatalog::scanPresetsInDirectory()
+{
+    auto dir = getDirectory();
+
+    Snapshot::Ptr next = new Snapshot();
+    next->directory = dir;
+
+    if (dir.exists())
+    {
+        // Scan for preset files recursively
+        juce::Array<juce::File> presetFiles;
+        dir.findChildFiles(presetFiles,
+            juce::File::findFiles,
+            true,
+            juce::String("*") + PRESET_EXTENSION);
+
+        for (const auto& file : presetFiles)
+        {
+            // Files that don't parse are left out of the library
+            auto preset = readPresetFile(file, dir);
+            if (preset)
+            {
+                // Check for Midi Mapping
+                preset->midiNote = findMidiNoteForPreset(file);
+                next->presets.add(*preset);
+            }
+        }
+
+        // Sort by Category then Name using a comparator struct
+        struct PresetComparator
+        {
+            static int compareElements(const Preset& a, const Preset& b)
+            {
+                int categoryCompare = a.category.compareIgnoreCase(b.category);
+                if (categoryCompare != 0)
+                    return categoryCompare;
+                return a.name.compareIgnoreCase(b.name);
+            }
+        };
+
+        PresetComparator comparator;
+        next->presets.sort(comparator);
+        next->buildHashIndex();
+
+        if (assignProgramNumbers(next->presets))
+            saveMidiMappings();
+
+        next->buildProgramTable();
+    }
+
+    const juce::ScopedLock sl(snapshotLock);
+    snapshot = next;
+}
+
+// Caller must hold writeLock. Mapping edits only touch the note badges,
+// so republish the existing list instead of reading every file again.
+void PresetCatalog::publishMidiNotes()
+{
+    Snapshot::Ptr current;
+    {
+        const juce::ScopedLock sl(snapshotLock);
+        current = snapshot;
+    }
+
+    Snapshot::Ptr next = new Snapshot();
+    next->directory = current->directory;
+    next->presets = current->presets;
+
+    for (auto& preset : next->presets)
+        preset.midiNote = findMidiNoteForPreset(preset.file);
+
+    next->hashIndex = current->hashIndex;
+    next->programTable = current->programTable;
+    next->numPrograms = current->numPrograms;
+    next->programNames = current->programNames;
+
+    const juce::ScopedLock sl(snapshotLock);
+    snapshot = next;
+}
+
+// Caller must hold writeLock. Returns true if anything in the mapping file changed
+bool PresetCatalog::assignProgramNumbers(juce::Array<Preset>& presets)
+{
+    const juce::ScopedLock sl(midiMappingLock);
+
+    // Every number in the table stays taken, also for presets that are gone, so
+    // deleting a preset never hands its Program Changes to another one
+    juce::HashMap<juce::String, ProgramEntry> kept;
+    std::vector<bool> used((size_t)maxPrograms, false);
+    bool changed = false;
+
+    for (juce::HashMap<juce::String, ProgramEntry>::Iterator i(presetToProgram); i.next();)
+    {
+        const int program = i.getValue().program;
+        if (juce::isPositiveAndBelow(program, maxPrograms) && !used[(size_t)program])
+        {
+            used[(size_t)program] = true;
+            kept.set(i.getKey(), i.getValue());
+        }
+        else
+        {
+            changed = true;
+        }
+    }
+
+    juce::HashMap<juce::String, bool> present;
+
+    for (auto& preset : presets)
+    {
+        const auto path = preset.file.getFullPathName();
+        present.set(path, true);
+
+        if (!kept.contains(path))
+            continue;
+
+        auto entry = kept[path];
+        preset.program = entry.program;
+
+        if (entry.hash != preset.hash || entry.name != preset.name)
+        {
+            entry.hash = preset.hash;
+            entry.name = preset.name;
+            kept.set(path, entry);
+            changed = true;
+        }
+    }
+
+    // Triggers only go when their number was released
+    changed = noteTriggers.removeUnless([&used](int program) { return juce::isPositiveAndBelow(program, maxPrograms) && used[(size_t)program]; })
+        || changed;
+
+    // A new file with the content of a missing one is that preset renamed or moved
+    std::vector<std::pair<juce::String, ProgramEntry>> missing;
+    for (juce::HashMap<juce::String, ProgramEntry>::Iterator i(kept); i.next();)
+    {
+        if (!present.contains(i.getKey()))
+            missing.emplace_back(i.getKey(), i.getValue());
+    }
+
+    for (auto& preset : presets)
+    {
+        if (preset.program >= 0 || !preset.hasSnapshot)
+            continue;
+
+        auto match = std::find_if(missing.begin(), missing.end(), [&preset](const auto& entry) { return entry.second.hash != 0 && entry.second.hash == preset.hash; });
+        if (match == missing.end())
+            continue;
+
+        preset.program = match->second.program;
+        kept.remove(match->first);
+        kept.set(preset.file.getFullPathName(), { preset.program, preset.hash, preset.name });
+        missing.erase(match);
+        changed = true;
+    }
+
+    // Other new presets fill the lowest free numbers, in list order
+    int nextFree = 0;
+
+    for (auto& preset : presets)
+    {
+        if (preset.program >= 0)
+            continue;
+
+        while (nextFree < maxPrograms && used[(size_t)nextFree])
+            ++nextFree;
+
+        if (nextFree >= maxPrograms)
+            break;
+
+        used[(size_t)nextFree] = true;
+        preset.program = nextFree;
+        kept.set(preset.file.getFullPathName(), { nextFree, preset.hash, preset.name });
+        changed = true;
+    }
+
+    presetToProgram.swapWith(kept);
+    return changed;
+}
+
+std::optional<PresetCatalog::Preset> PresetCatalog::readPresetFile(const juce::File& file, const juce::File& rootDirectory)
+{
+    auto xml = juce::XmlDocument::parse(file);
+    if (xml == nullptr)
+        return std::nullopt;
+
+    auto state = juce::ValueTree::fromXml(*xml);
+    if (!state.isValid())
+        return std::nullopt;
+
+    Preset preset;
+    preset.file = file;
+
+    preset.name = state.getProperty("name", file.getFileNameWithoutExtension()).toString();
+    preset.category = state.getProperty("category", "").toString();
+    preset.state = state;
+
+    // If category is empty try to get it from the parent folder
+    if (preset.category.isEmpty())
+    {
+        auto parentDir = file.getParentDirectory();
+        if (parentDir != rootDirectory)
+            preset.category = parentDir.getFileName(); // ?? feels weird
+    }
+
+    // Decode the parameter values once here
+    auto pluginState = state.getChildWithName("PluginState");
+
+    if (!pluginState.isValid() && state.hasProperty("stateData"))
+    {
+        // Older presets stored the processor's binary state as base64
+        juce::MemoryBlock stateData;
+        stateData.fromBase64Encoding(state.getProperty("stateData").toString());
+
+        if (auto xml = juce::AudioProcessor::getXmlFromBinary(stateData.getData(), (int)stateData.getSize()))
+            pluginState = juce::ValueTree::fromXml(*xml);
+    }
+
+    preset.hasSnapshot = ChromaConsoleControllerAudioProcessor::readSnapshotFromState(pluginState, preset.snapshot, preset.midiChannel);
+    preset.hash = preset.snapshot.getHash();
+    preset.sections = ChromaConsoleControllerAudioProcessor::readSectionsFromState(pluginState);
+
+    return preset;
+}
+
+// Caller must hold writeLock
+void PresetCatalog::saveMidiMappings()
+{
+    juce::ValueTree mappings("MidiMappings");
+    {
+        const juce::ScopedLock sl(midiMappingLock);
+
+        for (juce::HashMap<int, juce::File>::Iterator i(midiNoteToPreset); i.next();)
+        {
+            juce::ValueTree item("Mapping");
+            item.setProperty("note", i.getKey(), nullptr);
+            item.setProperty("preset", i.getValue().getFullPathName(), nullptr);
+            mappings.appendChild(item, nullptr);
+        }
+
+        for (juce::HashMap<juce::String, ProgramEntry>::Iterator i(presetToProgram); i.next();)
+        {
+            juce::ValueTree item("Program");
+            item.setProperty("number", i.getValue().program, nullptr);
+            item.setProperty("preset", i.getKey(), nullptr);
+            item.setProperty("hash", juce::String::toHexString((juce::int64)i.getValue().hash), nullptr);
+            item.setProperty("name", i.getValue().name, nullptr);
+            mappings.appendChild(item, nullptr);
+        }
+
+        juce::MemoryOutputStream triggerData;
+        noteTriggers.write(triggerData);
+
+        juce::ValueTree triggers("Triggers");
+        triggers.setProperty("data", triggerData.getMemoryBlock().toBase64Encoding(), nullptr);
+        mappings.appendChild(triggers, nullptr);
+    }
+
+    auto xml = mappings.createXml();
+    if (xml)
+    {
+        auto mappingFile = getDirectory().getChildFile(MIDI_MAPPING_FILE);
+        xml->writeTo(mappingFile);
+    }
+}
+
+// Caller must hold writeLock
+void PresetCatalog::loadMidiMappings()
+{
+    const juce::ScopedLock sl(midiMappingLock);
+
+    midiNoteToPreset.clear();
+    presetToProgram.clear();
+    noteTriggers.clearAll();
+
+    auto mappingFile = getDirectory().getChildFile(MIDI_MAPPING_FILE);
+    if (!mappingFile.existsAsFile())
+        return;
+
+    auto xml = juce::XmlDocument::parse(mappingFile);
+    if (!xml)
+        return;
+
+    auto mappings = juce::ValueTree::fromXml(*xml);
+    if (!mappings.isValid())
+        return;
+
+    for (int i = 0; i < mappings.getNumChildren(); i++)
+    {
+        auto item = mappings.getChild(i);
+
+        if (item.hasType("Program"))
+        {
+            ProgramEntry entry;
+            entry.program = item.getProperty("number", -1);
+            entry.hash = (juce::uint64)item.getProperty("hash").toString().getHexValue64();
+            entry.name = item.getProperty("name").toString();
+            presetToProgram.set(item.getProperty("preset").toString(), entry);
+            continue;
+        }
+
+        if (item.hasType("Triggers"))
+        {
+            juce::MemoryBlock triggerData;
+            if (triggerData.fromBase64Encoding(item.getProperty("data").toString()))
+            {
+                juce::MemoryInputStream in(triggerData, false);
+                noteTriggers.read(in);
+            }
+
+            continue;
+        }
+
+        int note = item.getProperty("note", -1);
+        auto presetPath = item.getProperty("preset").toString();
+
+        if (note >= 0 && note <= 127 && presetPath.isNotEmpty())
+        {
+            juce::File presetFile(presetPath);
+            if (presetFile.existsAsFile())
+                midiNoteToPreset.set(note, presetFile);
+        }
+    }
+}
@@ -0,0 +1,225 @@
+/*
+  ==============================================================================
+
+    PresetCatalog.h
+    Created: 19 Oct 2026 10:12:40am
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PresetSections.h"
+#include "ParameterSnapshot.h"
+#include "NoteTriggerMatrix.h"
+
+/*
+Process-wide preset library shared by every plugin instance.
+Hold it through a juce::SharedResourcePointer<PresetCatalog> so the directory
+is scanned once and midi_mappings.xml has a single writer.
+Each preset also keeps a program number (bank * 128 + program) for Program
+Change recall. New presets take the lowest free number when first scanned,
+so adding presets never renumbers the existing ones. The numbers of presets
+that disappear stay reserved until the user hands them on or frees them, and
+a file renamed or moved outside the plugin is recognised by its content and
+keeps its number. The preset list is
+published as immutable snapshots; per-instance state (the current preset)
+lives in PresetManager.
+
+Construction does no file I/O. The first call that needs the library starts
+loading it on a background thread; until that finishes callers get an empty
+snapshot and isLoading() returns true.
+*/
+
+class PresetCatalog : private juce::Thread,
+    private juce::AsyncUpdater
+{
+public:
+    struct Preset
+    {
+        juce::String name;
+        juce::String category;
+        juce::File file;
+        juce::ValueTree state;
+        int midiNote = -1; // -1 means no MIDI mapping
+        int program = -1;  // Stable bank * 128 + program number, -1 until scanned
+
+        // Parameter values decoded at scan time, so loading never re-parses the file
+        ParameterSnapshot snapshot;
+        int midiChannel = 0; // 0 if the preset didn't store one
+        bool hasSnapshot = false;
+        juce::uint64 hash = 0; // snapshot.getHash(), doubles as a content key for finding duplicates
+        PresetSections::Ptr sections; // Macros, LFOs and the rest, also decoded at scan time
+    };
+
+    // Host program names, index is the program number, empty where none is assigned
+    struct ProgramNames : public juce::ReferenceCountedObject
+    {
+        using Ptr = juce::ReferenceCountedObjectPtr<ProgramNames>;
+        juce::StringArray names;
+    };
+
+    // View of the library. Never modified after publishing,
+    // so it can be read without holding any lock.
+    struct Snapshot : public juce::ReferenceCountedObject
+    {
+        using Ptr = juce::ReferenceCountedObjectPtr<Snapshot>;
+
+        juce::File directory;
+        juce::Array<Preset> presets; // Sorted by category then name
+
+        int indexOf(const juce::File& presetFile) const;
+
+        // Indices of every preset with identical parameter values
+        juce::Array<int> findPresetsWithHash(juce::uint64 hash) const;
+
+        // (hash, index) pairs sorted by hash, built once when the snapshot is published
+        std::vector<std::pair<juce::uint64, int>> hashIndex;
+        void buildHashIndex();
+
+        // Program number -> preset index, -1 where nothing is assigned. One load per lookup
+        std::vector<int> programTable;
+        int numPrograms = 0; // Highest program number in use + 1
+        ProgramNames::Ptr programNames;
+        void buildProgramTable();
+        int indexOfProgram(int program) const noexcept;
+    };
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+        virtual void catalogChanged() = 0;
+        virtual void catalogLoaded() {} // Called on the message thread once loading finishes
+    };
+
+    //=========================
+    PresetCatalog();
+    ~PresetCatalog() override;
+
+    // Starts the background load if it hasn't started yet. Never blocks
+    void ensureLoaded();
+    bool isLoading() const { return loadState.load() != ready; }
+
+    Snapshot::Ptr getSnapshot();
+
+    // For the host's program list. Until the library has loaded the names come from the
+    // mapping file, which is small, and the full load isn't started. Hosts ask for these
+    // while scanning plugins and VST3 hosts take the count once, straight after creation
+    ProgramNames::Ptr getProgramNames();
+
+    //=========================
+    // Directory
+    juce::File getDirectory() const;
+    void setDirectory(const juce::File& directory);
+    void rescan();
+
+    //=========================
+    // Preset files. All writes go through the catalog
+    bool writePreset(const juce::File& presetFile, const juce::ValueTree& presetState);
+    bool deletePreset(const juce::File& presetFile);
+
+    //=========================
+    // MIDI note mappings (note -> preset file)
+    void setMidiMapping(int midiNote, const juce::File& presetFile);
+    void removeMidiMapping(int midiNote);
+    juce::File getPresetForMidiNote(int midiNote);
+    int getMidiNoteForPreset(const juce::File& presetFile);
+    std::map<int, juce::File> getMidiMappings(); // Copy, the table changes under its lock
+
+    static constexpr int maxPrograms = 128 * 128; // 128 banks of 128 programs
+
+    //=========================
+    // Program numbers of presets that are gone stay reserved, so a controller set up
+    // for one never recalls a different preset. Only the user hands them on or frees them
+    struct ReservedProgram
+    {
+        int program = -1;
+        juce::String presetName; // File name of the preset that had it
+    };
+
+    std::vector<ReservedProgram> getReservedPrograms();
+    bool takeProgramNumber(const juce::File& presetFile, int program); // Moves the preset to a reserved number
+    void releaseProgramNumber(int program); // Frees a reserved number for the next new preset
+
+    //=========================
+    // Channel-specific note triggers, pointing at presets by program number
+    void setNoteTrigger(int channel, int midiNote, const NoteTriggerMatrix::Layer& layer);
+    void clearNoteTriggersForPreset(int program);
+    NoteTriggerMatrix getNoteTriggers() const;
+
+    // Parses and decodes a single preset file, nullopt if it isn't a readable preset
+    static std::optional<Preset> readPresetFile(const juce::File& file, const juce::File& rootDirectory);
+
+    //=========================
+    void addListener(Listener* listener);
+    void removeListener(Listener* listener);
+
+    static constexpr const char* PRESET_EXTENSION = ".ccpreset";
+    static constexpr const char* MIDI_MAPPING_FILE = "midi_mappings.xml";
+
+private:
+    enum LoadState
+    {
+        notLoaded = 0,
+        loading,
+        ready
+    };
+
+    void run() override;
+    void handleAsyncUpdate() override;
+    void requestLoad();
+    bool waitUntilLoaded();
+
+    void scanPresetsInDirectory();
+    void publishMidiNotes();
+    bool assignProgramNumbers(juce::Array<Preset>& presets);
+    void removeMidiMappingsForPreset(const juce::File& presetFile, int noteToKeep = -1);
+    int findMidiNoteForPreset(const juce::File& presetFile) const;
+    void saveMidiMappings();
+    void loadMidiMappings();
+    void notifyCatalogChanged();
+
+    // Serialises every write (scan, mapping file) so instances never race each other
+    juce::CriticalSection writeLock;
+
+    mutable juce::CriticalSection directoryLock;
+    juce::File directory;
+
+    mutable juce::CriticalSection snapshotLock;
+    Snapshot::Ptr snapshot;
+
+    // Writes give up rather than hang if a load never finishes (e.g. an unreachable network folder)
+    static constexpr int loadTimeoutMs = 10000;
+
+    // loadLock orders load requests against publishing the result. A scan is only
+    // published if no load was requested after it began (the generation is unchanged)
+    juce::CriticalSection loadLock;
+    std::atomic<int> loadState{ notLoaded };
+    std::atomic<bool> reloadRequested{ false };
+    juce::uint32 loadGeneration = 0;
+    juce::WaitableEvent loadedEvent{ true }; // Manual reset, stays signalled once loaded
+
+    mutable juce::CriticalSection midiMappingLock;
+    juce::HashMap<int, juce::File> midiNoteToPreset; // Midi Note -> Preset File
+    struct ProgramEntry
+    {
+        int program = -1;
+        juce::uint64 hash = 0; // Content when last scanned, recognises the file after a rename
+        juce::String name;     // Preset name, so the host's program list can be read without a scan
+    };
+
+    juce::HashMap<juce::String, ProgramEntry> presetToProgram; // Preset path -> program number, kept for missing presets
+    NoteTriggerMatrix noteTriggers;
+
+    juce::CriticalSection programNamesLock;
+    ProgramNames::Ptr savedProgramNames; // From the mapping file, only used until loaded
+    static ProgramNames::Ptr readProgramNames(const juce::File& mappingFile);
+
+    // Instances can be created and destroyed on different threads
+    juce::ListenerList<Listener, juce::Array<Listener*, juce::CriticalSection>> listeners;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetCatalog)
+};
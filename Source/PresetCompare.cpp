@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    PresetCompare.cpp
+    Created: 22 Oct 2026 10:37:18am
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "PresetCompare.h"
+#include "PluginProcessor.h"
+
+PresetCompare::PresetCompare(ChromaConsoleControllerAudioProcessor& p) : processor(p)
+{
+}
+
+//==============================================================================
+void PresetCompare::switchToSlot(int slot)
+{
+    if (!juce::isPositiveAndBelow(slot, (int)numSlots) || slot == liveSlot)
+        return;
+
+    const auto current = getCurrentValues();
+
+    // Edits made since switching to the live slot stay with it
+    if (liveSlot >= 0)
+        slots[(size_t)liveSlot] = current;
+
+    liveSlot = slot;
+
+    if (!slotUsed[(size_t)slot])
+    {
+        slots[(size_t)slot] = current;
+        slotUsed[(size_t)slot] = true;
+        return;
+    }
+
+    publish(slots[(size_t)slot]);
+}
+
+void PresetCompare::copyToOtherSlot()
+{
+    if (liveSlot < 0)
+        return;
+
+    const auto other = (size_t)(liveSlot == slotA ? slotB : slotA);
+    slots[other] = getCurrentValues();
+    slotUsed[other] = true;
+}
+
+bool PresetCompare::hasSlot(int slot) const
+{
+    return juce::isPositiveAndBelow(slot, (int)numSlots) && slotUsed[(size_t)slot];
+}
+
+//==============================================================================
+void PresetCompare::audition(const ParameterSnapshot& values, juce::uint32 recallMask)
+{
+    // The first audition remembers where to return to, later ones replace each other
+    if (!auditionReturn)
+        auditionReturn = getCurrentValues();
+
+    auto target = *auditionReturn;
+    for (int slot = 0; slot < ParameterSnapshot::maxSlots; ++slot)
+    {
+        if ((recallMask >> slot) & 1u)
+            target.values[(size_t)slot] = values.values[(size_t)slot];
+    }
+
+    publish(target);
+}
+
+void PresetCompare::endAudition(bool keep)
+{
+    if (!auditionReturn)
+        return;
+
+    if (!keep)
+        publish(*auditionReturn);
+
+    auditionReturn.reset();
+}
+
+//==============================================================================
+ParameterSnapshot PresetCompare::getCurrentValues() const
+{
+    // Values the audio thread hasn't applied yet are already the current ones
+    if (hasPendingValues.load())
+    {
+        const juce::SpinLock::ScopedLockType lock(pendingLock);
+        if (hasPendingValues.load())
+            return pendingValues;
+    }
+
+    return processor.captureSnapshot();
+}
+
+void PresetCompare::publish(const ParameterSnapshot& values)
+{
+    const juce::SpinLock::ScopedLockType lock(pendingLock);
+    pendingValues = values;
+    hasPendingValues.store(true);
+}
+
+const ParameterSnapshot* PresetCompare::takePendingValues() noexcept
+{
+    if (!hasPendingValues.load())
+        return nullptr;
+
+    // Busy means the message thread is mid-write, try again next block
+    const juce::SpinLock::ScopedTryLockType lock(pendingLock);
+    if (!lock.isLocked())
+        return nullptr;
+
+    takenValues = pendingValues;
+    hasPendingValues.store(false);
+    return &takenValues;
+}
@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    PresetCompare.h
+    Created: 22 Oct 2026 10:37:18am
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterSnapshot.h"
+
+class ChromaConsoleControllerAudioProcessor;
+
+/*
+A/B compare slots and non-destructive preset audition.
+
+Both slots and the audition return point are ParameterSnapshots, 32 bytes
+each, kept in memory on the message thread. Switching or auditioning never
+touches a file or a ValueTree: the message thread hands the target values
+to the audio thread in one swap, and the processor applies them at the
+start of its next block. Only parameters that differ change, so only their
+CCs are sent.
+
+Switching away from a slot keeps the edits made on it. Selecting an empty
+slot fills it with the current values. Cancelling an audition returns to
+exactly the values from before the first auditioned preset.
+*/
+
+class PresetCompare
+{
+public:
+    enum Slot
+    {
+        slotA = 0,
+        slotB,
+        numSlots
+    };
+
+    explicit PresetCompare(ChromaConsoleControllerAudioProcessor& processor);
+
+    //=========================
+    // Message thread
+    void switchToSlot(int slot);
+    void copyToOtherSlot(); // Current values into the slot that isn't live
+    int getLiveSlot() const { return liveSlot; } // -1 before either slot is used
+    bool hasSlot(int slot) const;
+
+    // Masked slots come from the preset, the rest stay as they are (see RecallMask)
+    void audition(const ParameterSnapshot& values, juce::uint32 recallMask);
+    void endAudition(bool keep); // keep false returns to the values from before the audition
+    bool isAuditioning() const { return auditionReturn.has_value(); }
+
+    //=========================
+    // Audio thread
+    // Values to apply at the start of this block, or nullptr if nothing changed
+    const ParameterSnapshot* takePendingValues() noexcept;
+
+private:
+    ParameterSnapshot getCurrentValues() const;
+    void publish(const ParameterSnapshot& values);
+
+    ChromaConsoleControllerAudioProcessor& processor;
+
+    std::array<ParameterSnapshot, numSlots> slots;
+    std::array<bool, numSlots> slotUsed{};
+    int liveSlot = -1;
+    std::optional<ParameterSnapshot> auditionReturn;
+
+    juce::SpinLock pendingLock;
+    ParameterSnapshot pendingValues;
+    std::atomic<bool> hasPendingValues{ false };
+    ParameterSnapshot takenValues; // Audio thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetCompare)
+};
@@ -11,26 +11,87 @@
 #include "PresetManager.h"
 #include "PluginProcessor.h"
 
-PresetManager::PresetManager(juce::AudioProcessor& p) : processor(p)
+PresetManager::PresetManager(juce::AudioProcessor& p) : processor(p),
+    pendingRecallTable(std::make_unique<RecallTable>()),
+    activeRecallTable(std::make_unique<RecallTable>())
 {
-    // Set default preset directory (plugin data folder)
-    auto appData = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory);
-    presetDirectory = appData.getChildFile(JucePlugin_Manufacturer)
-        .getChildFile(JucePlugin_Name)
-        .getChildFile("Presets");
+    // The catalog scans the directory and loads MIDI mappings once per process
+    catalog->addListener(this);
 
-   // Create directory if it doesn't exist
-    if (!presetDirectory.exists())
-        presetDirectory.createDirectory();
-
-    // Load initial preset list and MIDI mappings
-    loadMidiMappings();
-    scanPresetsInDirectory();
+    // Another instance may have loaded the library already. Otherwise the table
+    // follows once it has, construction doesn't start the load
+    if (!catalog->isLoading())
+        rebuildRecallTable();
 }
 
 PresetManager::~PresetManager()
 {
-    saveMidiMappings();
+    // MIDI mappings are written by the catalog, not by each instance
+    cancelPendingUpdate();
+    catalog->removeListener(this);
+}
+
+ChromaConsoleControllerAudioProcessor& PresetManager::getChromaProcessor() const
+{
+    return dynamic_cast<ChromaConsoleControllerAudioProcessor&>(processor);
+}
+
+void PresetManager::catalogChanged()
+{
+    // The current preset may have been overwritten, possibly by another instance
+    rebuildRecallTable();
+    refreshCurrentPresetHash();
+    notifyPresetListChanged();
+    notifyHostProgramsChanged();
+}
+
+void PresetManager::catalogLoaded()
+{
+    {
+        const juce::ScopedLock sl(presetLock);
+
+        if (pendingPresetIndex >= 0 && currentPresetFile == juce::File())
+        {
+            auto snapshot = catalog->getSnapshot();
+            if (pendingPresetIndex < snapshot->presets.size())
+                currentPresetFile = snapshot->presets.getReference(pendingPresetIndex).file;
+        }
+
+        pendingPresetIndex = -1;
+    }
+
+    refreshCurrentPresetHash();
+    notifyCurrentPresetChanged();
+}
+
+void PresetManager::handleAsyncUpdate()
+{
+    // A Program Change or note came in before anything else needed the library
+    if (libraryRequested.load())
+        catalog->ensureLoaded();
+
+    const int program = pendingLoadedProgram.exchange(noPendingLoad);
+    if (program == noPendingLoad)
+        return;
+
+    auto snapshot = catalog->getSnapshot();
+    const int index = snapshot->indexOfProgram(program);
+    if (index < 0)
+        return;
+
+    // The sections are taken from the catalog here rather than handed over, so the audio
+    // thread never holds (and never drops) a reference to them
+    const auto& preset = snapshot->presets.getReference(index);
+    if (preset.sections != nullptr)
+        getChromaProcessor().restorePresetSections(*preset.sections);
+
+    {
+        const juce::ScopedLock sl(presetLock);
+        currentPresetFile = preset.file;
+    }
+
+    notifyPresetLoaded(preset);
+    notifyCurrentPresetChanged();
 }
 
 bool PresetManager::savePreset(const juce::String& presetName, const juce::String& category)
@@ -73,40 +134,20 @@ bool PresetManager::savePreset(const juce::String& presetName, const juce::Strin
 
 bool PresetManager::writePresetToFile(const juce::File& presetFile, const juce::String& presetName, const juce::String& category)
 {
-    juce::MemoryBlock stateData;
-    processor.getStateInformation(stateData);
-
     juce::ValueTree presetState("PresetState");
     presetState.setProperty("name", presetName, nullptr);
     presetState.setProperty("category", category, nullptr);
     presetState.setProperty("version", JucePlugin_VersionString, nullptr);
     presetState.setProperty("timestamp", juce::Time::getCurrentTime().toISO8601(true), nullptr);
 
-    auto stateTree = juce::ValueTree::fromXml(stateData.toString());
-    if (!stateTree.isValid())
-        presetState.setProperty("stateData", stateData.toBase64Encoding(), nullptr);
-    else
-        presetState.appendChild(stateTree, nullptr);
+    // Capture the processor state as a ValueTree directly, no binary or text round-trip
+    presetState.appendChild(getChromaProcessor().capturePluginState(), nullptr);
 
-    auto xml = presetState.createXml();
-    if (xml == nullptr || !xml->writeToFile(presetFile, {}))
+    // Catalog writes the file, rescans and notifies every instance's list
+    if (!catalog->writePreset(presetFile, presetState))
         return false;
 
-    scanPresetsInDirectory();
-
-    // Update preset list
-    {
-        const juce::ScopedLock sl(presetLock);
-        
-        for (int i = 0; i < presets.size(); i++)
-        {
-            if (presets[i].file == presetFile)
-            {
-                currentPresetIndex = i;
-                break;
-            }
-        }
-    }
+    setCurrentPreset(presetFile, getChromaProcessor().getStateHash());
 
     Preset savedPreset;
     savedPreset.name = presetName;
@@ -115,7 +156,6 @@ bool PresetManager::writePresetToFile(const juce::File& presetFile, const juce::
     savedPreset.state = presetState;
 
     notifyPresetSaved(savedPreset);
-    notifyPresetListChanged();
 
     return true;
 }
@@ -133,111 +173,127 @@ void PresetManager::setPreserveMidiChannel(bool shouldPreserve)
 
 bool PresetManager::loadPreset(const juce::File& presetFile)
 {
-    if (!presetFile.existsAsFile())
-        return false;
-
-    // Parse Preset File
-    auto xml = juce::XmlDocument::parse(presetFile);
-    if (xml == nullptr)
+    auto preset = findPreset(presetFile);
+    if (!preset)
         return false;
 
-    auto presetState = juce::ValueTree::fromXml(*xml);
-    if (!presetState.isValid())
-        return false;
+    applyPreset(*preset);
+    return true;
+}
 
-    // Extract State Data
-    juce::MemoryBlock stateData;
+void PresetManager::applyPreset(const Preset& preset, juce::uint32 presetRecallMask, bool momentary)
+{
+    if (!applyPresetValues(preset.snapshot, preset.midiChannel, presetRecallMask, momentary))
+        return;
 
-    if (presetState.hasProperty("stateData"))
+    if (juce::MessageManager::existsAndIsCurrentThread())
     {
-        // Load from base64
-        auto base64 = presetState.getProperty("stateData").toString();
-        stateData.fromBase64Encoding(base64);
-    } 
-    else 
-    {
-        // Try to extract from child ValueTree
-        for (int i = 0; i < presetState.getNumChildren(); i++)
-        {
-            auto child = presetState.getChild(i);
-            auto childXml = child.createXml();
-            if (childXml)
-            {
-                auto xmlString = childXml->toString();
-                stateData.append(xmlString.toRawUTF8(), xmlString.getNumBytesAsUTF8());
-                break;
-            }
-        }
-    }
+        // Supersedes a load from the audio thread that hasn't been announced yet
+        pendingLoadedProgram.store(noPendingLoad);
 
-    // Save current MIDI channel before loading preset
-    float savedMidiChannelNormalized = 0.0f;
-    bool shouldRestore = preserveMidiChannel.load();
+        if (preset.sections != nullptr)
+            getChromaProcessor().restorePresetSections(*preset.sections);
 
-    if (shouldRestore)
-    {
-        auto& chromaProcessor = dynamic_cast<ChromaConsoleControllerAudioProcessor&>(processor);
-        if (auto* midiChannelParam = chromaProcessor.parameters.getParameter("midiChannel"))
-        {
-            savedMidiChannelNormalized = midiChannelParam->getValue();
-        }
+        setCurrentPreset(preset.file, preset.hash, preset.program);
+
+        notifyPresetLoaded(preset);
+        notifyCurrentPresetChanged();
+        return;
     }
 
-    // Load Preset state
-    // This will overwrite everything including the MIDI channel
-    if (stateData.getSize() > 0)
-        processor.setStateInformation(stateData.getData(), (int)stateData.getSize());
+    announceLoadedProgram(preset.program, preset.hash);
+}
+
+void PresetManager::applyRecallEntry(const RecallEntry& entry, juce::uint32 presetRecallMask, bool momentary)
+{
+    if (applyPresetValues(entry.snapshot, entry.midiChannel, presetRecallMask, momentary))
+        announceLoadedProgram(entry.program, entry.hash);
+}
+
+bool PresetManager::applyPresetValues(const ParameterSnapshot& snapshot, int midiChannel, juce::uint32 presetRecallMask, bool momentary)
+{
+    auto& chromaProcessor = getChromaProcessor();
+
+    // Nothing to recall, e.g. a trigger's mask that the global one excludes entirely
+    const auto mask = presetRecallMask & recallMask.load();
+    if (RecallMask::coversNoSlots(mask))
+        return false;
+
+    // One undo step, even when loaded on the audio thread
+    chromaProcessor.getParameterHistory().requestCheckpoint();
+
+    // Apply parameter values straight from the snapshot, masked slots only.
+    // Unchanged parameters send no CCs, so a partial recall also sends fewer
+    chromaProcessor.applySnapshot(snapshot, mask);
+
+    // A partial recall leaves the channel, the other preset sections and the current preset
+    // alone. The current preset shows as modified and next/previous still step from it
+    if (momentary || !RecallMask::coversAllSlots(mask))
+        return false;
+
+    // The MIDI channel is only touched when preservation is disabled
+    if (!preserveMidiChannel.load())
+        chromaProcessor.applyMidiChannel(midiChannel);
+
+    return true;
+}
+
+void PresetManager::announceLoadedProgram(int program, juce::uint64 hash)
+{
+    // Off the message thread (Program Change, triggers, setlist steps) only the atomics are
+    // set here. The engines lock and allocate to take new sections, the file needs presetLock
+    // and the listeners repaint, so all of that follows on the message thread, which finds
+    // the preset again by its program number
+    currentProgram.store(program);
+    currentPresetHash.store(hash);
+    hasCurrentPresetHash.store(true);
+    pendingLoadedProgram.store(program);
+    triggerAsyncUpdate();
+}
 
-    // Restore MIDI channel if preservation enabled
-    if (shouldRestore)
+std::optional<PresetManager::Preset> PresetManager::findPreset(const juce::File& presetFile) const
+{
+    // Use the catalog's decoded copy, only read the file if it isn't in there (yet)
+    std::optional<Preset> preset;
     {
-        auto& chromaProcessor = dynamic_cast<ChromaConsoleControllerAudioProcessor&>(processor);
-        if (auto* midiChannelParam = chromaProcessor.parameters.getParameter("midiChannel"))
-        {
-            midiChannelParam->setValueNotifyingHost(savedMidiChannelNormalized);
-        }
+        auto snapshot = catalog->getSnapshot();
+        int index = snapshot->indexOf(presetFile);
+        if (index >= 0)
+            preset = snapshot->presets[index];
     }
 
+    if (!preset)
     {
-        const juce::ScopedLock sl(presetLock);
-        for (int i = 0; i < presets.size(); i++)
-        {
-            if (presets[i].file == presetFile)
-            {
-                currentPresetIndex = i;
-                break;
-            }
-        }
+        if (!presetFile.existsAsFile())
+            return std::nullopt;
+
+        preset = PresetCatalog::readPresetFile(presetFile, getPresetDirectory());
     }
 
-    // Create preset object for notification
-    Preset loadedPreset;
-    loadedPreset.name = presetState.getProperty("name", "Unknown").toString();
-    loadedPreset.category = presetState.getProperty("category", "").toString();
-    loadedPreset.file = presetFile;
-    loadedPreset.state = presetState;
+    if (!preset || !preset->hasSnapshot)
+        return std::nullopt;
 
-    notifyPresetLoaded(loadedPreset);
-    notifyCurrentPresetChanged();
+    return preset;
+}
 
+bool PresetManager::setMorphSource(MorphEngine::Source source, const juce::File& presetFile)
+{
+    auto preset = findPreset(presetFile);
+    if (!preset)
+        return false;
+
+    getChromaProcessor().getMorphEngine().setSource(source, preset->snapshot, preset->name);
     return true;
 }
 
 bool PresetManager::loadPresetByIndex(int index)
 {
-    juce::File fileToLoad;
-
-    {
-        const juce::ScopedLock sl(presetLock);
+    auto snapshot = catalog->getSnapshot();
 
-        if (index < 0 || index >= presets.size())
-            return false;
-
-        fileToLoad = presets[index].file;
-    }
+    if (index < 0 || index >= snapshot->presets.size())
+        return false;
 
-    // Load outside the lock
-    return loadPreset(fileToLoad);
+    return loadPreset(snapshot->presets.getReference(index).file);
 }
 /*
 bool PresetManager::deletePreset(const juce::File& presetFile)
@@ -276,57 +332,20 @@ bool PresetManager::deletePreset(const juce::File& presetFile)
 
 bool PresetManager::deletePreset(const juce::File& presetFile)
 {
-
-    if (!presetFile.existsAsFile())
+    // Check if we are deleting the currently loaded preset
+    bool deletedCurrentPreset = false;
     {
-        return false;
-    }
-
-    // Clear MIDI mappings
-    {
-        const juce::ScopedLock sl(midiMappingLock);
-        juce::Array<int> notesToRemove;
-
-        for (juce::HashMap<int, juce::File>::Iterator i(midiNoteToPreset); i.next();)
-        {
-            if (i.getValue() == presetFile)
-                notesToRemove.add(i.getKey());
-        }
-
-        for (auto note : notesToRemove)
-            midiNoteToPreset.remove(note);
-
-        if (!notesToRemove.isEmpty())
-        { }
+        const juce::ScopedLock sl(presetLock);
+        deletedCurrentPreset = (currentPresetFile == presetFile);
     }
 
-    saveMidiMappings();
+    // Catalog clears the MIDI mappings, deletes the file and rescans
+    bool success = catalog->deletePreset(presetFile);
 
-    bool success = presetFile.deleteFile();
-
-    if (success)
+    if (success && deletedCurrentPreset)
     {
-        // Check if we deleted the currently loaded preset
-        bool deletedCurrentPreset = false;
-        {
-            const juce::ScopedLock sl(presetLock);
-            if (currentPresetIndex >= 0 && currentPresetIndex < presets.size())
-                deletedCurrentPreset = (presets[currentPresetIndex].file == presetFile);
-        }
-        scanPresetsInDirectory();
-        
-
-        if (deletedCurrentPreset)
-        {
-            {
-                const juce::ScopedLock sl(presetLock);
-                currentPresetIndex = -1;
-            }
-        }
-
-        notifyPresetListChanged();
-        if (deletedCurrentPreset)
-			notifyCurrentPresetChanged();
+        setCurrentPreset(juce::File(), std::nullopt);
+        notifyCurrentPresetChanged();
     }
 
     return success;
@@ -334,69 +353,64 @@ bool PresetManager::deletePreset(const juce::File& presetFile)
 
 void PresetManager::loadNextPreset()
 {
-    juce::File fileToLoad;
+    auto snapshot = catalog->getSnapshot();
+    auto& presets = snapshot->presets;
 
-    {
-        const juce::ScopedLock sl(presetLock);
-
-        if (presets.isEmpty())
-            return;
-
-        int nextIndex = (currentPresetIndex + 1) % presets.size();
-        fileToLoad = presets[nextIndex].file;
-    }
+    if (presets.isEmpty())
+        return;
 
-    // Load outside the lock to avoid deadlock
-    loadPreset(fileToLoad);
+    int nextIndex = (getCurrentPresetIndex() + 1) % presets.size();
+    loadPreset(presets.getReference(nextIndex).file);
 }
 
 void PresetManager::loadPreviousPreset()
 {
-    juce::File fileToLoad;
-
-    {
-        const juce::ScopedLock sl(presetLock);
-
-        if (presets.isEmpty())
-            return;
+    auto snapshot = catalog->getSnapshot();
+    auto& presets = snapshot->presets;
 
-        int prevIndex = currentPresetIndex - 1;
-        if (prevIndex < 0)
-            prevIndex = presets.size() - 1;
+    if (presets.isEmpty())
+        return;
 
-        fileToLoad = presets[prevIndex].file;
-    }
+    int prevIndex = getCurrentPresetIndex() - 1;
+    if (prevIndex < 0)
+        prevIndex = presets.size() - 1;
 
-    loadPreset(fileToLoad);
+    loadPreset(presets.getReference(prevIndex).file);
 }
 
 int PresetManager::getCurrentPresetIndex() const
 {
-    const juce::ScopedLock sl(presetLock);
-    return currentPresetIndex;
+    juce::File file;
+    {
+        const juce::ScopedLock sl(presetLock);
+        file = currentPresetFile;
+    }
+
+    return catalog->getSnapshot()->indexOf(file);
 }
 
 std::optional<PresetManager::Preset> PresetManager::getCurrentPreset() const
 {
-    const juce::ScopedLock sl(presetLock);
-    if (currentPresetIndex >= 0 && currentPresetIndex < presets.size())
-        return presets[currentPresetIndex];
+    auto snapshot = catalog->getSnapshot();
+    int index = getCurrentPresetIndex();
+
+    if (index >= 0 && index < snapshot->presets.size())
+        return snapshot->presets[index];
 
     return std::nullopt;
 }
 
 juce::Array<PresetManager::Preset> PresetManager::getAllPresets() const
 {
-    const juce::ScopedLock sl(presetLock);
-    return presets;
+    return catalog->getSnapshot()->presets;
 }
 
 juce::Array<PresetManager::Preset> PresetManager::getPresetsByCategory(const juce::String& category) const
 {
-    const juce::ScopedLock sl(presetLock);
+    auto snapshot = catalog->getSnapshot();
 
     juce::Array<Preset> filtered;
-    for (const auto& preset : presets)
+    for (const auto& preset : snapshot->presets)
     {
         if (preset.category == category)
             filtered.add(preset);
@@ -407,10 +421,10 @@ juce::Array<PresetManager::Preset> PresetManager::getPresetsByCategory(const juc
 
 juce::StringArray PresetManager::getCategories() const
 {
-    const juce::ScopedLock sl(presetLock);
+    auto snapshot = catalog->getSnapshot();
 
     juce::StringArray categories;
-    for (const auto& preset : presets)
+    for (const auto& preset : snapshot->presets)
     {
         if (preset.category.isNotEmpty() && !categories.contains(preset.category))
             categories.add(preset.category);
@@ -422,8 +436,7 @@ juce::StringArray PresetManager::getCategories() const
 
 void PresetManager::refreshPresetList()
 {
-    scanPresetsInDirectory();
-    notifyPresetListChanged();
+    catalog->rescan();
 }
 
 //=============================================================================
@@ -435,32 +448,10 @@ bool PresetManager::setMidiNoteForPreset(const juce::File& presetFile, int midiN
     if (!presetFile.existsAsFile())
         return false;
 
-    // Check is preset already has a different note assigned. Clear it
-    {
-        const juce::ScopedLock sl(midiMappingLock);
-        juce::Array<int> notesToRemove;
-
-        for (juce::HashMap<int, juce::File>::Iterator i(midiNoteToPreset); i.next();)
-        {
-            if (i.getValue() == presetFile && i.getKey() != midiNote)
-                notesToRemove.add(i.getKey());
-        }
-
-        for (auto note : notesToRemove)
-            midiNoteToPreset.remove(note);
-    }
-
     // Check if MIDI note is already mapped to another preset
-    juce::File existingPreset;
-    {
-        const juce::ScopedLock sl(midiMappingLock);
-        if (midiNoteToPreset.contains(midiNote))
-        {
-            auto mapped = midiNoteToPreset[midiNote];
-            if (mapped != presetFile)
-                existingPreset = mapped;
-        }
-    }
+    juce::File existingPreset = catalog->getPresetForMidiNote(midiNote);
+    if (existingPreset == presetFile)
+        existingPreset = juce::File();
 
     if (existingPreset.existsAsFile())
     {
@@ -478,93 +469,234 @@ bool PresetManager::setMidiNoteForPreset(const juce::File& presetFile, int midiN
             [this, presetFile, midiNote](int result)
             {
                 if (result == 1) // Reassign
-                {
-                    {
-                        const juce::ScopedLock sl(midiMappingLock);
-                        midiNoteToPreset.set(midiNote, presetFile);
-                        
-                    }
-
-                    saveMidiMappings();
-                    scanPresetsInDirectory();
-                    notifyPresetListChanged();
-                }
+                    catalog->setMidiMapping(midiNote, presetFile);
             });
 
         return true; // dialog is pending
     }
 
     // No conflict, assign directly
+    catalog->setMidiMapping(midiNote, presetFile);
+
+    return true;
+}
+
+bool PresetManager::loadPresetFromMidiNote(int midiNote)
+{
+    // Runs on the audio thread, one lookup in the recall table's note column
+    const auto& table = getActiveRecallTable();
+    if (!juce::isPositiveAndBelow(midiNote, (int)table.noteToEntry.size()))
+        return false;
+
+    const int index = table.noteToEntry[(size_t)midiNote];
+    if (index < 0)
+        return false;
+
+    applyRecallEntry(table.entries[(size_t)index], RecallMask::everything, false);
+    return true;
+}
+
+std::optional<PresetManager::Preset> PresetManager::findPresetForProgram(int program) const
+{
+    auto snapshot = catalog->getSnapshot();
+    const int index = snapshot->indexOfProgram(program);
+
+    if (index < 0)
+        return std::nullopt;
+
+    return snapshot->presets.getReference(index);
+}
+
+bool PresetManager::loadPreset(const Preset& preset, juce::uint32 presetRecallMask)
+{
+    if (!preset.hasSnapshot)
+        return false;
+
+    applyPreset(preset, presetRecallMask);
+    return true;
+}
+
+bool PresetManager::loadPresetFromProgram(int program, juce::uint32 presetRecallMask, bool momentary)
+{
+    // Host program changes from the editor or a restored state
+    if (juce::MessageManager::existsAndIsCurrentThread())
     {
-        const juce::ScopedLock sl(midiMappingLock);
-        midiNoteToPreset.set(midiNote, presetFile);
-        
+        auto preset = findPresetForProgram(program);
+        if (!preset || !preset->hasSnapshot)
+            return false;
+
+        applyPreset(*preset, presetRecallMask, momentary);
+        return true;
     }
 
-    saveMidiMappings();
-    scanPresetsInDirectory();
-    notifyPresetListChanged();
+    // Every preset is already decoded in the recall table, so this never reads a file or locks
+    const auto& table = getActiveRecallTable();
+    if (!juce::isPositiveAndBelow(program, (int)table.programToEntry.size()))
+        return false;
 
+    const int index = table.programToEntry[(size_t)program];
+    if (index < 0)
+        return false;
+
+    applyRecallEntry(table.entries[(size_t)index], presetRecallMask, momentary);
     return true;
 }
 
-bool PresetManager::loadPresetFromMidiNote(int midiNote)
+const PresetManager::RecallTable& PresetManager::getActiveRecallTable() noexcept
 {
-    juce::File presetFile;
+    if (recallTableChanged.load())
     {
-		const juce::ScopedLock sl(midiMappingLock);
-		if (midiNoteToPreset.contains(midiNote))
-            presetFile = midiNoteToPreset[midiNote];
+        const juce::SpinLock::ScopedTryLockType lock(recallTableLock);
+        if (lock.isLocked())
+        {
+            std::swap(activeRecallTable, pendingRecallTable);
+            recallTableChanged.store(false);
+        }
     }
 
-    if (presetFile.existsAsFile())
-        return loadPreset(presetFile);
+    // Before the library has loaded the table is empty, the load starts on the message thread
+    if (activeRecallTable->entries.empty() && !libraryRequested.exchange(true))
+        triggerAsyncUpdate();
 
-    return false;
+    return *activeRecallTable;
 }
 
-int PresetManager::getMidiNoteForPreset(const juce::File& presetFile) const
+void PresetManager::rebuildRecallTable()
 {
-    const juce::ScopedLock sl(midiMappingLock);
+    auto table = std::make_unique<RecallTable>();
+    auto snapshot = catalog->getSnapshot();
+
+    table->programToEntry.assign((size_t)snapshot->numPrograms, -1);
+    table->noteToEntry.fill(-1);
+    table->entries.reserve((size_t)snapshot->presets.size());
 
-    for (juce::HashMap<int, juce::File>::Iterator i(midiNoteToPreset); i.next();)
+    for (const auto& preset : snapshot->presets)
     {
-        if (i.getValue() == presetFile)
-            return i.getKey();
+        const bool numbered = juce::isPositiveAndBelow(preset.program, snapshot->numPrograms);
+        const bool mapped = juce::isPositiveAndBelow(preset.midiNote, (int)table->noteToEntry.size());
+
+        if (!preset.hasSnapshot || !(numbered || mapped))
+            continue;
+
+        if (numbered)
+            table->programToEntry[(size_t)preset.program] = (int)table->entries.size();
+
+        if (mapped)
+            table->noteToEntry[(size_t)preset.midiNote] = (int)table->entries.size();
+
+        table->entries.push_back({ preset.snapshot, preset.midiChannel, preset.hash, preset.program });
     }
 
-    return -1;
+    {
+        const juce::SpinLock::ScopedLockType lock(recallTableLock);
+        std::swap(pendingRecallTable, table);
+        recallTableChanged.store(true);
+    }
+    // table now holds whatever was pending before and is freed here, off the audio thread
 }
 
-void PresetManager::clearMidiMapping(int midiNote)
+//=========================================================================================================
+void PresetManager::setHostProgramBank(int bank)
 {
-    {
-        const juce::ScopedLock sl(midiMappingLock);
-        midiNoteToPreset.remove(midiNote);
-        
-    }
+    hostProgramBank.store(juce::jlimit(-1, PresetCatalog::maxPrograms / 128 - 1, bank));
+    notifyHostProgramsChanged();
+}
 
-    saveMidiMappings();
-    scanPresetsInDirectory();
-    notifyPresetListChanged();
+int PresetManager::getNumHostPrograms() const
+{
+    if (hostProgramBank.load() >= 0)
+        return 128;
+
+    // Some hosts don't cope with 0 programs. Doesn't wait for (or start) the library scan
+    return juce::jmax(1, catalog->getProgramNames()->names.size());
 }
 
-const juce::HashMap<int, juce::File>& PresetManager::getMidiMappings() const
+int PresetManager::getNumProgramBanks() const
 {
-    const juce::ScopedLock sl(midiMappingLock);
-    return midiNoteToPreset;
+    return juce::jmax(1, (catalog->getSnapshot()->numPrograms + 127) / 128);
 }
-//=========================================================================================================
-void PresetManager::setPresetDirectory(const juce::File& directory)
+
+int PresetManager::getCurrentHostProgram() const
 {
-    presetDirectory = directory;
+    const int program = currentProgram.load();
+    const int bank = hostProgramBank.load();
 
-    if (!presetDirectory.exists())
-        presetDirectory.createDirectory();
+    if (bank < 0)
+        return program;
 
-    scanPresetsInDirectory();
-    loadMidiMappings();
-    notifyPresetListChanged();
+    return program / 128 == bank ? program % 128 : -1;
+}
+
+bool PresetManager::loadHostProgram(int index)
+{
+    const int bank = hostProgramBank.load();
+    return loadPresetFromProgram(bank < 0 ? index : bank * 128 + index);
+}
+
+juce::String PresetManager::getHostProgramName(int index) const
+{
+    const int bank = hostProgramBank.load();
+    auto programNames = catalog->getProgramNames();
+
+    // Shares the list's string, nothing is built per call
+    return programNames->names[bank < 0 ? index : bank * 128 + index];
+}
+
+void PresetManager::notifyHostProgramsChanged()
+{
+    // Names can change at any time. VST3 hosts fix the count when the plugin is created, so
+    // presets added past it only show up in the host's list after the plugin is reloaded
+    processor.updateHostDisplay(juce::AudioProcessorListener::ChangeDetails().withProgramChanged(true).withParameterInfoChanged(true));
+}
+
+bool PresetManager::setNoteTrigger(const juce::File& presetFile, int channel, int midiNote, int velocityLow, int velocityHigh, bool momentary,
+                                   juce::uint32 layerRecallMask)
+{
+    auto snapshot = catalog->getSnapshot();
+    const int index = snapshot->indexOf(presetFile);
+
+    if (index < 0 || snapshot->presets.getReference(index).program < 0)
+        return false;
+
+    NoteTriggerMatrix::Layer layer;
+    layer.presetId = (juce::int16)snapshot->presets.getReference(index).program;
+    layer.velocityLow = (juce::uint8)juce::jlimit(1, 127, velocityLow);
+    layer.velocityHigh = (juce::uint8)juce::jlimit(1, 127, velocityHigh);
+    layer.momentary = momentary;
+    layer.recallMask = layerRecallMask;
+
+    catalog->setNoteTrigger(channel, midiNote, layer);
+    return true;
+}
+
+void PresetManager::clearNoteTriggers(const juce::File& presetFile)
+{
+    auto snapshot = catalog->getSnapshot();
+    const int index = snapshot->indexOf(presetFile);
+
+    if (index >= 0 && snapshot->presets.getReference(index).program >= 0)
+        catalog->clearNoteTriggersForPreset(snapshot->presets.getReference(index).program);
+}
+
+int PresetManager::getMidiNoteForPreset(const juce::File& presetFile) const
+{
+    return catalog->getMidiNoteForPreset(presetFile);
+}
+
+void PresetManager::clearMidiMapping(int midiNote)
+{
+    catalog->removeMidiMapping(midiNote);
+}
+
+std::map<int, juce::File> PresetManager::getMidiMappings() const
+{
+    return catalog->getMidiMappings();
+}
+//=========================================================================================================
+void PresetManager::setPresetDirectory(const juce::File& directory)
+{
+    // The directory is process-wide; the catalog ignores it if nothing changed
+    catalog->setDirectory(directory);
 }
 
 //=========================================================================================================
@@ -583,8 +715,20 @@ juce::ValueTree PresetManager::getState() const
 {
     juce::ValueTree state("PresetManagerState");
 
-    state.setProperty("presetDirectory", presetDirectory.getFullPathName(), nullptr);
-    state.setProperty("currentPresetIndex", currentPresetIndex, nullptr);
+    state.setProperty("presetDirectory", getPresetDirectory().getFullPathName(), nullptr);
+
+    // Saving state must not start a catalog load (hosts do this right after scanning)
+    if (!catalog->isLoading())
+        state.setProperty("currentPresetIndex", getCurrentPresetIndex(), nullptr);
+
+    {
+        const juce::ScopedLock sl(presetLock);
+
+        if (catalog->isLoading())
+            state.setProperty("currentPresetIndex", pendingPresetIndex, nullptr);
+
+        state.setProperty("currentPresetFile", currentPresetFile.getFullPathName(), nullptr);
+    }
     //state.setProperty("preserveMidiChannel", preserveMidiChannel.load(), nullptr);
 
     return state;
@@ -595,176 +739,175 @@ void PresetManager::setState(const juce::ValueTree& state)
     if (!state.hasType("PresetManagerState"))
         return;
 
-    auto dir = state.getProperty("presetDirectory").toString();
-    if (dir.isNotEmpty())
-        setPresetDirectory(juce::File(dir));
-
-    currentPresetIndex = state.getProperty("currentPresetIndex", -1);
+    restoreState(state.getProperty("presetDirectory").toString(),
+        state.getProperty("currentPresetFile").toString(),
+        state.getProperty("currentPresetIndex", -1));
 
     //preserveMidiChannel.store(state.getProperty("preserveMidiChannel", true));
 }
 
-//============================================================================================================
-void PresetManager::scanPresetsInDirectory()
+void PresetManager::writeBinaryState(juce::OutputStream& out) const
 {
-    const juce::ScopedLock sl(presetLock);
+    out.writeString(getPresetDirectory().getFullPathName());
 
-    presets.clear();
+    {
+        const juce::ScopedLock sl(presetLock);
+        out.writeString(currentPresetFile.getFullPathName());
+    }
 
-    if (!presetDirectory.exists())
-        return;
+    out.writeByte((char)hostProgramBank.load());
+    out.writeInt((int)recallMask.load());
+}
+
+void PresetManager::readBinaryState(juce::InputStream& in)
+{
+    auto dir = in.readString();
+    auto file = in.readString();
+
+    // Older states end here
+    if (!in.isExhausted())
+        setHostProgramBank(in.readByte());
 
-    // Scan for preset files recursively
-    juce::Array<juce::File> presetFiles;
-    presetDirectory.findChildFiles(presetFiles,
-        juce::File::findFiles,
-        true,
-        juce::String("*") + PRESET_EXTENSION);
+    if (!in.isExhausted())
+        setRecallMask((juce::uint32)in.readInt());
 
-    for (const auto& file : presetFiles)
+    restoreState(dir, file, -1);
+}
+
+void PresetManager::restoreState(const juce::String& directory, const juce::String& presetFile, int presetIndex)
+{
+    // No rescan unless the directory actually changed
+    if (directory.isNotEmpty())
+        setPresetDirectory(juce::File(directory));
+
+    // Older states only stored the index
+    juce::File restoredFile;
+    int restoredIndex = -1;
+
+    if (presetFile.isNotEmpty())
     {
-        auto preset = loadPresetFromFile(file);
-        if (preset.isValid())
+        restoredFile = juce::File(presetFile);
+    }
+    else if (presetIndex >= 0)
+    {
+        restoredIndex = presetIndex;
+        auto snapshot = catalog->getSnapshot();
+        if (!catalog->isLoading() && restoredIndex < snapshot->presets.size())
         {
-            // Check for Midi Mapping
-            preset.midiNote = getMidiNoteForPreset(file);
-            presets.add(preset);
+            restoredFile = snapshot->presets.getReference(restoredIndex).file;
+            restoredIndex = -1;
         }
     }
 
-    // Sort by Category then Name using a comparator struct
-    struct PresetComparator
     {
-        static int compareElements(const Preset& a, const Preset& b)
-        {
-            int categoryCompare = a.category.compareIgnoreCase(b.category);
-            if (categoryCompare != 0)
-                return categoryCompare;
-            return a.name.compareIgnoreCase(b.name);
-        }
-    };
+        const juce::ScopedLock sl(presetLock);
+        pendingPresetIndex = restoredIndex;
+    }
 
-    PresetComparator comparator;
-    presets.sort(comparator);
+    setCurrentPreset(restoredFile, std::nullopt);
 }
 
-juce::File PresetManager::createPresetFile(const juce::String& presetName, const juce::String& category)
+void PresetManager::setCurrentPreset(const juce::File& file, std::optional<juce::uint64> hash, int program)
 {
-    auto categoryDir = presetDirectory;
-
-    if (category.isNotEmpty())
     {
-        categoryDir = presetDirectory.getChildFile(category);
-        categoryDir.createDirectory();
+        const juce::ScopedLock sl(presetLock);
+        currentPresetFile = file;
     }
 
-    auto safeName = presetName.replaceCharacters("/\\:*?\"<>|", "___________");
-    auto fileName = safeName + PRESET_EXTENSION;
-    return categoryDir.getChildFile(fileName);
+    currentProgram.store(program);
+
+    if (hash)
+    {
+        currentPresetHash.store(*hash);
+        hasCurrentPresetHash.store(true);
+    }
+    else
+    {
+        refreshCurrentPresetHash();
+    }
 }
 
-std::pair<juce::File, juce::String> PresetManager::getIncrementedPresetFile(const juce::String& presetName, const juce::String& category)
+void PresetManager::refreshCurrentPresetHash()
 {
-    auto categoryDir = presetDirectory;
-    if (category.isNotEmpty())
-        categoryDir = presetDirectory.getChildFile(category);
+    // Takes the stored hash from the catalog, unknown until it has loaded
+    std::optional<Preset> preset;
+    if (!catalog->isLoading())
+        preset = getCurrentPreset();
 
-    auto safeName = presetName.replaceCharacters("/\\:*?\"<>|", "___________");
-    int counter = 1;
-    juce::String incrementedName;
-    juce::File file;
+    if (preset)
+        currentProgram.store(preset->program);
 
-    do {
-        incrementedName = safeName + "_" + juce::String(counter++);
-        file = categoryDir.getChildFile(incrementedName + PRESET_EXTENSION);
-    } while (file.exists());
-
-    return { file, incrementedName };
+    if (preset && preset->hasSnapshot)
+    {
+        currentPresetHash.store(preset->hash);
+        hasCurrentPresetHash.store(true);
+    }
+    else
+    {
+        hasCurrentPresetHash.store(false);
+    }
 }
 
-PresetManager::Preset PresetManager::loadPresetFromFile(const juce::File& file)
+bool PresetManager::isCurrentPresetModified() const
 {
-    Preset preset;
-    preset.file = file;
-
-    auto xml = juce::XmlDocument::parse(file);
-    if (xml == nullptr)
-        return preset;
+    return hasCurrentPresetHash.load()
+        && currentPresetHash.load() != getChromaProcessor().getStateHash();
+}
 
-    auto state = juce::ValueTree::fromXml(*xml);
-    if (!state.isValid())
-        return preset;
+juce::Array<PresetManager::Preset> PresetManager::findDuplicatesOf(const Preset& preset) const
+{
+    juce::Array<Preset> duplicates;
 
-    preset.name = state.getProperty("name", file.getFileNameWithoutExtension()).toString();
-    preset.category = state.getProperty("category", "").toString();
-    preset.state = state;
+    if (!preset.hasSnapshot)
+        return duplicates;
 
-    // If category is empty try to get it from the parent folder
-    if (preset.category.isEmpty())
+    auto snapshot = catalog->getSnapshot();
+    for (auto index : snapshot->findPresetsWithHash(preset.hash))
     {
-        auto parentDir = file.getParentDirectory();
-        if (parentDir != presetDirectory)
-            preset.category = parentDir.getFileName(); // ?? feels weird
+        // The hash is only a key, confirm the values really match
+        auto& candidate = snapshot->presets.getReference(index);
+        if (candidate.file != preset.file && candidate.snapshot == preset.snapshot)
+            duplicates.add(candidate);
     }
 
-    return preset;
+    return duplicates;
 }
 
-void PresetManager::saveMidiMappings()
+//============================================================================================================
+juce::File PresetManager::createPresetFile(const juce::String& presetName, const juce::String& category)
 {
-    juce::ValueTree mappings("MidiMappings");
-    {
-        const juce::ScopedLock sl(midiMappingLock);
-
-        for (juce::HashMap<int, juce::File>::Iterator i(midiNoteToPreset); i.next();)
-        {
-            juce::ValueTree item("Mapping");
-            item.setProperty("note", i.getKey(), nullptr);
-            item.setProperty("preset", i.getValue().getFullPathName(), nullptr);
-            mappings.appendChild(item, nullptr);
-        }
-    }
+    auto presetDirectory = getPresetDirectory();
+    auto categoryDir = presetDirectory;
 
-    auto xml = mappings.createXml();
-    if (xml)
+    if (category.isNotEmpty())
     {
-        auto mappingFile = presetDirectory.getChildFile(MIDI_MAPPING_FILE);
-        xml->writeTo(mappingFile);
+        categoryDir = presetDirectory.getChildFile(category);
+        categoryDir.createDirectory();
     }
 
+    auto safeName = presetName.replaceCharacters("/\\:*?\"<>|", "___________");
+    auto fileName = safeName + PresetCatalog::PRESET_EXTENSION;
+    return categoryDir.getChildFile(fileName);
 }
 
-void PresetManager::loadMidiMappings()
+std::pair<juce::File, juce::String> PresetManager::getIncrementedPresetFile(const juce::String& presetName, const juce::String& category)
 {
-    const juce::ScopedLock sl(midiMappingLock);
-
-    midiNoteToPreset.clear();
-
-    auto mappingFile = presetDirectory.getChildFile(MIDI_MAPPING_FILE);
-    if (!mappingFile.existsAsFile())
-        return;
-
-    auto xml = juce::XmlDocument::parse(mappingFile);
-    if (!xml)
-        return;
+    auto presetDirectory = getPresetDirectory();
+    auto categoryDir = presetDirectory;
+    if (category.isNotEmpty())
+        categoryDir = presetDirectory.getChildFile(category);
 
-    auto mappings = juce::ValueTree::fromXml(*xml);
-    if (!mappings.isValid())
-        return;
+    auto safeName = presetName.replaceCharacters("/\\:*?\"<>|", "___________");
+    int counter = 1;
+    juce::String incrementedName;
+    juce::File file;
 
-    for (int i = 0; i < mappings.getNumChildren(); i++)
-    {
-        auto item = mappings.getChild(i);
-        int note = item.getProperty("note", -1);
-        auto presetPath = item.getProperty("preset").toString();
+    do {
+        incrementedName = safeName + "_" + juce::String(counter++);
+        file = categoryDir.getChildFile(incrementedName + PresetCatalog::PRESET_EXTENSION);
+    } while (file.exists());
 
-        if (note >= 0 && note <= 127 && presetPath.isNotEmpty())
-        {
-            juce::File presetFile(presetPath);
-            if (presetFile.existsAsFile())
-                midiNoteToPreset.set(note, presetFile);
-        }
-    }
+    return { file, incrementedName };
 }
 
 void PresetManager::notifyPresetLoaded(const Preset& preset)
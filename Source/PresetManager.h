@@ -11,20 +11,18 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "PresetCatalog.h"
+#include "MorphEngine.h"
+#include "RecallMask.h"
 
-class PresetManager : public juce::ValueTree::Listener
+class ChromaConsoleControllerAudioProcessor;
+
+class PresetManager : public juce::ValueTree::Listener,
+    private PresetCatalog::Listener,
+    private juce::AsyncUpdater
 {
 public:
-    struct Preset
-    {
-        juce::String name;
-        juce::String category;
-        juce::File file;
-        juce::ValueTree state;
-        int midiNote = -1; // -1 means no MIDI mapping
-
-        bool isValid() const { return file.existsAsFile(); }
-    };
+    using Preset = PresetCatalog::Preset;
 
     // Listener interface for preset changes
     class Listener
@@ -56,27 +54,70 @@ public:
     int getCurrentPresetIndex() const;
     std::optional<Preset> getCurrentPreset() const;
 
+    // O(1): compares the processor's running hash with the current preset's stored hash
+    bool isCurrentPresetModified() const;
+
+    // Other presets in the library with exactly the same parameter values
+    juce::Array<Preset> findDuplicatesOf(const Preset& preset) const;
+
     //================================
     // Preset Bank Management
     juce::Array<Preset> getAllPresets() const;
     juce::Array<Preset> getPresetsByCategory(const juce::String& category) const;
     juce::StringArray getCategories() const;
     void refreshPresetList();
+    bool isLoading() const { return catalog->isLoading(); } // Catalog still loading in the background
     std::pair<juce::File, juce::String> getIncrementedPresetFile(const juce::String& presetName, const juce::String& category);
 
+    //================================
+    // Host programs, numbered by the catalog's stable program numbers so the list
+    // doesn't shift as presets are added. Either the whole library or one bank of 128.
+    // Count and names come from the mapping file until the library has loaded, so
+    // host scans don't start the load and the count is right from the first call
+    void setHostProgramBank(int bank); // -1 for the whole library
+    int getHostProgramBank() const { return hostProgramBank.load(); }
+    int getNumHostPrograms() const;
+    int getNumProgramBanks() const; // Up to the last bank in use
+    int getCurrentHostProgram() const;
+    bool loadHostProgram(int index);
+    juce::String getHostProgramName(int index) const;
+
+    //================================
+    // Numbers of deleted or missing presets stay reserved until handed on or freed here
+    std::vector<PresetCatalog::ReservedProgram> getReservedPrograms() const { return catalog->getReservedPrograms(); }
+    bool takeProgramNumber(const juce::File& presetFile, int program) { return catalog->takeProgramNumber(presetFile, program); }
+    void releaseProgramNumber(int program) { catalog->releaseProgramNumber(program); }
+
+    //================================
+    // Morph sources, copies the preset's decoded values into the processor's MorphEngine
+    bool setMorphSource(MorphEngine::Source source, const juce::File& presetFile);
+
     //================================
     // Midi Mapping
     bool setMidiNoteForPreset(const juce::File& presetFile, int midiNote);
     bool loadPresetFromMidiNote(int midiNote);
+    bool loadPresetFromProgram(int program, juce::uint32 recallMask = RecallMask::everything, bool momentary = false); // bank * 128 + program, one table lookup
+    std::optional<Preset> findPresetForProgram(int program) const;
+    bool loadPreset(const Preset& preset, juce::uint32 recallMask = RecallMask::everything); // Already decoded, e.g. held by a setlist
+
+    // Channel-specific note triggers with velocity layers, on top of the note mappings above
+    bool setNoteTrigger(const juce::File& presetFile, int channel, int midiNote, int velocityLow, int velocityHigh, bool momentary,
+                        juce::uint32 layerRecallMask = RecallMask::everything);
+    void clearNoteTriggers(const juce::File& presetFile);
+    NoteTriggerMatrix getNoteTriggers() const { return catalog->getNoteTriggers(); }
     int getMidiNoteForPreset(const juce::File& presetFile) const;
     void clearMidiMapping(int midiNote);
-    const juce::HashMap<int, juce::File>& getMidiMappings() const;
+    std::map<int, juce::File> getMidiMappings() const; // Note -> preset file
     void setPreserveMidiChannel(bool shouldPreserve);
     bool getPreserveMidiChannel() const;
 
+    // Parameters any preset load may change, see RecallMask
+    void setRecallMask(juce::uint32 mask) { recallMask.store(mask); }
+    juce::uint32 getRecallMask() const { return recallMask.load(); }
+
     //============================
     // Directories
-    juce::File getPresetDirectory() const { return presetDirectory; }
+    juce::File getPresetDirectory() const { return catalog->getDirectory(); }
     void setPresetDirectory(const juce::File& directory);
 
     //==========================
@@ -89,6 +130,10 @@ public:
     juce::ValueTree getState() const;
     void setState(const juce::ValueTree& state);
 
+    // Same fields as getState/setState, for the compact plugin state chunk
+    void writeBinaryState(juce::OutputStream& out) const;
+    void readBinaryState(juce::InputStream& in);
+
 private:
     //===========================================
     // ValueTree::Listener Callbacks
@@ -98,13 +143,29 @@ private:
     void valueTreeChildOrderChanged(juce::ValueTree&, int, int) override {}
     void valueTreeParentChanged(juce::ValueTree&) override {}
 
+    //===========================================
+    // PresetCatalog::Listener Callbacks
+    void catalogChanged() override;
+    void catalogLoaded() override;
+
+    // Restores sections and announces presets loaded on the audio thread
+    void handleAsyncUpdate() override;
+
     //=============================================
     // Internal Methods
-    void scanPresetsInDirectory();
+    ChromaConsoleControllerAudioProcessor& getChromaProcessor() const;
+    std::optional<Preset> findPreset(const juce::File& presetFile) const;
+    // A momentary load (held note trigger) only lays the parameter values over the current
+    // preset. Sections, channel and the current preset stay, so the release can put it all back
+    void applyPreset(const Preset& preset, juce::uint32 presetRecallMask = RecallMask::everything, bool momentary = false);
+    // Values and channel. Returns true for a full recall, which makes it the current preset
+    bool applyPresetValues(const ParameterSnapshot& snapshot, int midiChannel, juce::uint32 presetRecallMask, bool momentary);
+    void announceLoadedProgram(int program, juce::uint64 hash); // Off the message thread
+    void restoreState(const juce::String& directory, const juce::String& presetFile, int presetIndex);
+    void setCurrentPreset(const juce::File& file, std::optional<juce::uint64> hash, int program = -1);
+    void notifyHostProgramsChanged();
+    void refreshCurrentPresetHash();
     juce::File createPresetFile(const juce::String& presetName, const juce::String& category);
-    Preset loadPresetFromFile(const juce::File& file);
-    void saveMidiMappings();
-    void loadMidiMappings();
     void notifyPresetLoaded(const Preset& preset);
     void notifyPresetSaved(const Preset& preset);
     void notifyPresetListChanged();
@@ -112,21 +173,57 @@ private:
 
     //========================================================
     juce::AudioProcessor& processor;
-    juce::File presetDirectory;
 
-    mutable juce::CriticalSection presetLock;
-    juce::Array<Preset> presets;
-    int currentPresetIndex = -1;
+    // Shared by every instance in the process
+    juce::SharedResourcePointer<PresetCatalog> catalog;
 
-    mutable juce::CriticalSection midiMappingLock;
-    juce::HashMap<int, juce::File> midiNoteToPreset; // Midi Note -> Preset File
+    // Per-instance selection, kept as a file so it survives rescans by other instances
+    mutable juce::CriticalSection presetLock;
+    juce::File currentPresetFile;
+    int pendingPresetIndex = -1; // Index from an old state, resolved once the catalog has loaded
 
     juce::ListenerList<Listener> listeners;
 
     std::atomic<bool> preserveMidiChannel{ true };
+    std::atomic<juce::uint32> recallMask{ RecallMask::everything };
+
+    std::atomic<juce::uint64> currentPresetHash{ 0 };
+    std::atomic<bool> hasCurrentPresetHash{ false };
+    std::atomic<int> currentProgram{ -1 }; // Program number of the current preset, -1 if unknown
+    std::atomic<int> hostProgramBank{ -1 };
+
+    // Decoded copy of every numbered or note mapped preset, so loads on the audio thread
+    // (Program Change, notes, triggers) never call into the catalog. Rebuilt on the message thread whenever the
+    // catalog changes and swapped in like the macro tables
+    struct RecallEntry
+    {
+        ParameterSnapshot snapshot;
+        int midiChannel = 0;
+        juce::uint64 hash = 0;
+        int program = -1;
+    };
+
+    struct RecallTable
+    {
+        std::vector<RecallEntry> entries;
+        std::vector<int> programToEntry; // Program number -> entry, -1 where nothing is assigned
+        std::array<int, 128> noteToEntry; // Mapped MIDI note -> entry, -1 for unmapped notes
+    };
+
+    void rebuildRecallTable();
+    const RecallTable& getActiveRecallTable() noexcept; // Audio thread
+    void applyRecallEntry(const RecallEntry& entry, juce::uint32 presetRecallMask, bool momentary);
+
+    juce::SpinLock recallTableLock;
+    std::unique_ptr<RecallTable> pendingRecallTable;
+    std::atomic<bool> recallTableChanged{ false };
+    std::unique_ptr<RecallTable> activeRecallTable; // Audio thread only
+    std::atomic<bool> libraryRequested{ false }; // A load came in before the library had loaded
 
-    static constexpr const char* PRESET_EXTENSION = ".ccpreset";
-    static constexpr const char* MIDI_MAPPING_FILE = "midi_mappings.xml";
+    // Program number of the last preset loaded off the message thread, its sections not
+    // restored and the load not announced yet
+    static constexpr int noPendingLoad = -2;
+    std::atomic<int> pendingLoadedProgram{ noPendingLoad };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetManager)
 };
\ No newline at end of file
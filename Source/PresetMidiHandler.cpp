@@ -10,8 +10,49 @@
 
 #include "PresetMidiHandler.h"
 
-PresetMidiHandler::PresetMidiHandler(PresetManager& pm) : presetManager(pm)
+PresetMidiHandler::PresetMidiHandler(PresetManager& pm, ActionScheduler& scheduler, SetlistPlayer& setlist)
+    : presetManager(pm), actionScheduler(scheduler), setlistPlayer(setlist),
+    pendingTriggers(std::make_unique<NoteTriggerMatrix>()),
+    activeTriggers(std::make_unique<NoteTriggerMatrix>())
 {
+    presetManager.addListener(this);
+    presetListChanged();
+}
+
+PresetMidiHandler::~PresetMidiHandler()
+{
+    cancelPendingUpdate();
+    presetManager.removeListener(this);
+}
+
+void PresetMidiHandler::presetListChanged()
+{
+    // Trigger edits come through the catalog, which notifies every instance
+    auto triggers = std::make_unique<NoteTriggerMatrix>(presetManager.getNoteTriggers());
+
+    {
+        const juce::SpinLock::ScopedLockType lock(triggerLock);
+        std::swap(pendingTriggers, triggers);
+        triggersChanged.store(true);
+    }
+}
+
+void PresetMidiHandler::handleAsyncUpdate()
+{
+    const int noteNumber = learnedNote.exchange(-1);
+    if (noteNumber < 0)
+        return;
+
+    auto currentPreset = presetManager.getCurrentPreset();
+    if (!currentPreset)
+    {
+        // Nothing to assign to yet, keep listening
+        learningMode.store(true);
+        return;
+    }
+
+    presetManager.setMidiNoteForPreset(currentPreset->file, noteNumber);
+    DBG("MIDI note " << noteNumber << " assigned to preset: " << currentPreset->name);
 }
 
 void PresetMidiHandler::processMidiMessages(juce::MidiBuffer& midiMessages, int numSamples)
@@ -19,23 +60,69 @@ void PresetMidiHandler::processMidiMessages(juce::MidiBuffer& midiMessages, int
     if (!enabled.load())
         return;
 
+    if (triggersChanged.load())
+    {
+        const juce::SpinLock::ScopedTryLockType lock(triggerLock);
+        if (lock.isLocked())
+        {
+            std::swap(activeTriggers, pendingTriggers);
+            triggersChanged.store(false);
+        }
+    }
+
     juce::MidiBuffer::Iterator i(midiMessages);
     juce::MidiMessage msg;
     int samplePosition;
 
     while (i.getNextEvent(msg, samplePosition))
     {
+        // The setlist's footswitch takes its messages before anything else sees them
+        if (setlistPlayer.learnControl(msg))
+            continue;
+
+        if (setlistPlayer.isActive())
+        {
+            if (const int delta = setlistPlayer.matchControl(msg))
+            {
+                actionScheduler.schedule({ ActionScheduler::setlistStep, 0, delta }, ActionScheduler::presetChanges, samplePosition);
+                continue;
+            }
+        }
+
         if (msg.isNoteOn())
         {
             int channel = msg.getChannel();
             int targetChannel = midiChannel.load();
 
+            if (handleTrigger(msg.getNoteNumber(), msg.getVelocity(), channel, samplePosition))
+                continue;
+
             // Check if we should process this channel
             if (targetChannel == 0 || channel == targetChannel)
-                handleNoteOn(msg.getNoteNumber(), msg.getVelocity(), channel);
+                handleNoteOn(msg.getNoteNumber(), msg.getVelocity(), channel, samplePosition);
+        }
+        else if (msg.isController() || msg.isProgramChange())
+        {
+            const int targetChannel = midiChannel.load();
+            if (targetChannel != 0 && msg.getChannel() != targetChannel)
+                continue;
+
+            if (msg.isProgramChange())
+                handleProgramChange(msg.getProgramChangeNumber(), samplePosition);
+            else if (msg.getControllerNumber() == 0)
+            {
+                // A bank select starts with the MSB and the LSB follows if the controller sends one,
+                // so an old LSB doesn't combine with a new MSB-only change
+                bankMsb.store(msg.getControllerValue());
+                bankLsb.store(0);
+            }
+            else if (msg.getControllerNumber() == 32)
+                bankLsb.store(msg.getControllerValue());
         }
         else if (msg.isNoteOff())
         {
+            releaseTrigger(msg.getNoteNumber(), msg.getChannel(), samplePosition);
+
             // Remove from active notes
             const juce::ScopedLock sl(notesLock);
             activeNotes.erase(msg.getNoteNumber());
@@ -66,24 +153,38 @@ void PresetMidiHandler::setVelocityThreshold(int threshold)
     velocityThreshold.store(juce::jlimit(0, 127, threshold));
 }
 
+int PresetMidiHandler::getBank() const
+{
+    // 14-bit banks past 127 can't be addressed, so a lone MSB is read as the bank itself
+    const int msb = bankMsb.load();
+    const int lsb = bankLsb.load();
+
+    if (msb == 0)
+        return lsb;
+
+    return lsb == 0 ? msb : -1;
+}
+
 void PresetMidiHandler::setLearningMode(bool shouldLearn)
 {
     learningMode.store(shouldLearn);
 }
 
-void PresetMidiHandler::setMidiLearnCallback(std::function <void(int)> callback)
+void PresetMidiHandler::setMidiLearnCallback(std::function <void(int, int)> callback)
 {
     const juce::ScopedLock sl(callBackLock);
     midiLearnCallback = callback;
+    learnCallbackActive.store(midiLearnCallback != nullptr);
 }
 
 void PresetMidiHandler::clearMidiLearnCallback()
 {
     const juce::ScopedLock sl(callBackLock);
     midiLearnCallback = nullptr;
+    learnCallbackActive.store(false);
 }
 
-void PresetMidiHandler::handleNoteOn(int noteNumber, int velocity, int channel)
+void PresetMidiHandler::handleNoteOn(int noteNumber, int velocity, int channel, int samplePosition)
 {
     // Check velocity threshold
     if (velocity < velocityThreshold.load())
@@ -102,34 +203,87 @@ void PresetMidiHandler::handleNoteOn(int noteNumber, int velocity, int channel)
         const juce::ScopedLock sl(callBackLock);
         if (midiLearnCallback)
         {
-            midiLearnCallback(noteNumber);
+            midiLearnCallback(noteNumber, channel);
             return; // Don't process any further when learning for UI
         }
     }
 
-    if (learningMode.load())
+    if (learningMode.exchange(false))
     {
-        auto currentPreset = presetManager.getCurrentPreset();
-        if (currentPreset)
-        {
-            juce::File presetFile = currentPreset->file;
-            juce::String presetName = currentPreset->name;
-            
-            presetManager.setMidiNoteForPreset(presetFile, noteNumber);
+        // Auto disable learning mode after one note, the assignment itself
+        // saves the mapping file and may ask about a clash, so it can't happen here
+        learnedNote.store(noteNumber);
+        triggerAsyncUpdate();
+        return;
+    }
 
-            // Auto disable learning mode after assignment
-            learningMode.store(false);
+    // Normal mode: Load preset mapped to this note, on the next beat or bar if quantised
+    if (!actionScheduler.schedule({ ActionScheduler::loadPresetNote, noteNumber }, ActionScheduler::presetChanges, samplePosition))
+    {
+        DBG("Preset change queue full, dropped MIDI note: " << noteNumber);
+    }
+}
 
-            DBG("MIDI note " << noteNumber << "assigned to preset: " << presetName);
-        }
+void PresetMidiHandler::handleProgramChange(int program, int samplePosition)
+{
+    if (!programChangeEnabled.load())
+        return;
+
+    const int bank = getBank();
+    if (bank < 0)
         return;
+
+    // Resolved through the catalog's program table when the change fires
+    const int programNumber = bank * 128 + program;
+
+    if (!actionScheduler.schedule({ ActionScheduler::loadPresetProgram, programNumber }, ActionScheduler::presetChanges, samplePosition))
+    {
+        DBG("Preset change queue full, dropped program change: " << programNumber);
+    }
+}
+
+bool PresetMidiHandler::handleTrigger(int noteNumber, int velocity, int channel, int samplePosition)
+{
+    // While learning, every note goes to the learn path
+    if (learnCallbackActive.load() || learningMode.load())
+        return false;
+
+    const auto* layer = activeTriggers->find(channel, noteNumber, velocity);
+    if (layer == nullptr)
+        return false;
+
+    if (layer->momentary)
+    {
+        auto& held = heldMomentary[(size_t)((channel - 1) * NoteTriggerMatrix::numNotes + noteNumber)];
+        if (!held)
+        {
+            held = true;
+            ++numHeldMomentary;
+        }
     }
 
-    // Normal mode: Load preset mapped to this note
-    bool loaded = presetManager.loadPresetFromMidiNote(noteNumber);
+    ActionScheduler::Action action{ ActionScheduler::loadPresetTrigger, layer->presetId, layer->momentary ? 1 : 0 };
+    action.recallMask = layer->recallMask;
 
-    if (loaded)
+    if (!actionScheduler.schedule(action, ActionScheduler::presetChanges, samplePosition))
     {
-        DBG("Loaded preset from MIDI note: " << noteNumber);
+        DBG("Preset change queue full, dropped trigger: " << channel << "/" << noteNumber);
     }
+
+    return true;
+}
+
+void PresetMidiHandler::releaseTrigger(int noteNumber, int channel, int samplePosition)
+{
+    if (!juce::isPositiveAndBelow(channel - 1, NoteTriggerMatrix::numChannels))
+        return;
+
+    auto& held = heldMomentary[(size_t)((channel - 1) * NoteTriggerMatrix::numNotes + noteNumber)];
+    if (!held)
+        return;
+
+    held = false;
+
+    if (--numHeldMomentary == 0)
+        actionScheduler.schedule({ ActionScheduler::returnFromTrigger, 0 }, ActionScheduler::presetChanges, samplePosition);
 }
\ No newline at end of file
@@ -12,16 +12,23 @@
 
 #include <JuceHeader.h>
 #include "PresetManager.h"
+#include "ActionScheduler.h"
+#include "SetlistPlayer.h"
 
 /*
-Midi Handler for triggering preset loading via MIDI notes
+Midi Handler for triggering preset loading via MIDI notes, or Program Change
+with Bank Select for libraries past 128 presets.
+Channel note triggers (see NoteTriggerMatrix) are checked first and work on any
+channel; the plain note mappings follow the channel setting below.
+Preset changes are queued on the ActionScheduler so they can wait for the next beat or bar.
 */
 
-class PresetMidiHandler
+class PresetMidiHandler : private PresetManager::Listener,
+    private juce::AsyncUpdater
 {
 public:
-    PresetMidiHandler(PresetManager& pm);
-    ~PresetMidiHandler() = default;
+    PresetMidiHandler(PresetManager& pm, ActionScheduler& scheduler, SetlistPlayer& setlist);
+    ~PresetMidiHandler() override;
 
     // Process incoming MIDI Messages
     // Call this from your AudioProcessor::processBlock()
@@ -39,6 +46,12 @@ public:
     void setVelocityThreshold(int threshold);
     int getVelocityThreshold() const { return velocityThreshold.load(); };
 
+    // Program Change recall. The bank comes from CC 32, or from CC 0 for
+    // controllers that only send the MSB. Banks past 127 are ignored
+    void setProgramChangeEnabled(bool shouldBeEnabled) { programChangeEnabled.store(shouldBeEnabled); }
+    bool isProgramChangeEnabled() const { return programChangeEnabled.load(); }
+    int getBank() const;
+
     // Enable/Disable learning mode
     // When enabled, next MIDI note will be assigned to current preset
     void setLearningMode(bool shouldLearn);
@@ -46,18 +59,35 @@ public:
 
     // Set callback for MIDI note learning (called by audio thread)
     // Use MessageManager::callAsync inside the callback for UI updates
-    void setMidiLearnCallback(std::function<void(int midiNote)> callback);
+    void setMidiLearnCallback(std::function<void(int midiNote, int channel)> callback);
     void clearMidiLearnCallback();
 
 private:
-    void handleNoteOn(int noteNumber, int velocity, int channel);
+    void handleNoteOn(int noteNumber, int velocity, int channel, int samplePosition);
+    void handleProgramChange(int program, int samplePosition);
+    bool handleTrigger(int noteNumber, int velocity, int channel, int samplePosition);
+    void releaseTrigger(int noteNumber, int channel, int samplePosition);
+
+    // PresetManager::Listener, picks up trigger edits from any instance
+    void presetListChanged() override;
+
+    // Assigns a learned note on the message thread, mapping edits write to disk
+    void handleAsyncUpdate() override;
 
     PresetManager& presetManager;
+    ActionScheduler& actionScheduler;
+    SetlistPlayer& setlistPlayer;
 
     std::atomic<bool> enabled{ true };
     std::atomic<int> midiChannel{ 0 }; // 0 = all channels
     std::atomic<int> velocityThreshold{ 1 };
     std::atomic<bool> learningMode{ false };
+    std::atomic<int> learnedNote{ -1 }; // Waiting for handleAsyncUpdate
+    std::atomic<bool> programChangeEnabled{ true };
+
+    // Last Bank Select received, kept until the next one like the device would
+    std::atomic<int> bankMsb{ 0 };
+    std::atomic<int> bankLsb{ 0 };
 
     // Thread-safe set for tracking currently pressed notes
     juce::CriticalSection notesLock;
@@ -65,7 +95,18 @@ private:
 
     // MIDI learn callback
     juce::CriticalSection callBackLock;
-    std::function<void(int)> midiLearnCallback;
+    std::function<void(int, int)> midiLearnCallback;
+    std::atomic<bool> learnCallbackActive{ false };
+
+    // Copy of the catalog's triggers, swapped in like the macro tables
+    juce::SpinLock triggerLock;
+    std::unique_ptr<NoteTriggerMatrix> pendingTriggers;
+    std::atomic<bool> triggersChanged{ false };
+    std::unique_ptr<NoteTriggerMatrix> activeTriggers; // Audio thread only
+
+    // Momentary triggers currently held, the return is sent when the last one is released
+    std::array<bool, NoteTriggerMatrix::numChannels * NoteTriggerMatrix::numNotes> heldMomentary{};
+    int numHeldMomentary = 0;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetMidiHandler)
 };
\ No newline at end of file
@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    PresetSections.h
+    Created: 23 Oct 2026 11:06:42am
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MacroEngine.h"
+#include "LfoBank.h"
+#include "StepSequencer.h"
+#include "EnvelopeFollower.h"
+#include "GestureRecorder.h"
+
+/*
+Everything a preset holds besides parameter values, decoded once when the
+preset is scanned. Loading only hands these to the engines, so it never
+parses XML or base64 again. Sections a preset was saved without are left
+empty and keep the current setup when it loads.
+Never modified after decoding, shared between copies of the preset.
+*/
+
+struct PresetSections : public juce::ReferenceCountedObject
+{
+    using Ptr = juce::ReferenceCountedObjectPtr<PresetSections>;
+
+    std::optional<std::vector<MacroEngine::Target>> macroTargets;
+    std::optional<LfoBank::Lfos> lfos;
+    std::optional<StepSequencer::Lanes> lanes;
+    std::optional<EnvelopeFollower::Settings> envelopeFollower;
+    std::optional<GestureRecorder::Take> gestureTake;
+    bool gesturesPlaying = true;
+};
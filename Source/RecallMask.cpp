@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    RecallMask.cpp
+    Created: 21 Oct 2026 8:12:40pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "RecallMask.h"
+#include "PluginProcessor.h"
+
+namespace RecallMask
+{
+    static juce::uint32 getMaskFor(std::initializer_list<const char*> parameterIDs)
+    {
+        juce::uint32 mask = 0;
+
+        for (auto* id : parameterIDs)
+        {
+            const int slot = ChromaConsoleControllerAudioProcessor::getSlotForParameterID(id);
+            if (slot >= 0)
+                mask |= 1u << slot;
+        }
+
+        return mask;
+    }
+
+    static juce::uint32 getAllSlots()
+    {
+        const auto numSlots = ChromaConsoleControllerAudioProcessor::ccConfigurations.size();
+        return numSlots >= 32 ? everything : (1u << numSlots) - 1;
+    }
+
+    const std::vector<Group>& getGroups()
+    {
+        static const std::vector<Group> groups = {
+            { "Character", getMaskFor({ "cModule", "tilt", "cAmount", "sensitivity", "cVol" }) },
+            { "Movement", getMaskFor({ "mModule", "rate", "mAmount", "mDrift", "mVol" }) },
+            { "Diffusion", getMaskFor({ "dModule", "time", "dAmount", "dDrift", "dVol" }) },
+            { "Texture", getMaskFor({ "tModule", "tAmount", "tVol", "filterMode" }) },
+            { "Mix & Level", getMaskFor({ "mix", "level" }) },
+            { "Bypass", getMaskFor({ "bypass1", "bypass2" }) },
+            { "Capture & Gesture", getMaskFor({ "capture", "captureRouting", "gesturePlayRec", "gestureStopErase" }) },
+            { "Calibration", getMaskFor({ "calibrationLevel" }) }
+        };
+
+        return groups;
+    }
+
+    bool coversAllSlots(juce::uint32 mask)
+    {
+        return (mask & getAllSlots()) == getAllSlots();
+    }
+
+    bool coversNoSlots(juce::uint32 mask)
+    {
+        return (mask & getAllSlots()) == 0;
+    }
+
+    juce::String describe(juce::uint32 mask)
+    {
+        mask &= getAllSlots();
+
+        if (mask == getAllSlots())
+            return "All";
+
+        if (mask == 0)
+            return "Nothing";
+
+        // Whole groups by name, anything else as a count
+        juce::StringArray names;
+        juce::uint32 named = 0;
+
+        for (const auto& group : getGroups())
+        {
+            if ((mask & group.mask) == group.mask)
+            {
+                names.add(group.name);
+                named |= group.mask;
+            }
+        }
+
+        const int others = juce::countNumberOfBits(mask & ~named);
+        if (others > 0)
+            names.add(juce::String(others) + (others == 1 ? " Parameter" : " Parameters"));
+
+        return names.joinIntoString(" + ");
+    }
+
+    juce::PopupMenu createMenu(juce::uint32 mask, std::function<void(juce::uint32)> onChange)
+    {
+        const auto allSlots = getAllSlots();
+        mask &= allSlots;
+
+        juce::PopupMenu menu;
+        menu.addItem("Everything", true, mask == allSlots, [onChange] { onChange(everything); });
+        menu.addSeparator();
+
+        const auto& configs = ChromaConsoleControllerAudioProcessor::ccConfigurations;
+
+        for (const auto& group : getGroups())
+        {
+            const bool wholeGroup = (mask & group.mask) == group.mask;
+
+            juce::PopupMenu groupMenu;
+            groupMenu.addItem("Whole Group", true, wholeGroup, [onChange, mask, group, wholeGroup]
+                {
+                    onChange(wholeGroup ? mask & ~group.mask : mask | group.mask);
+                });
+            groupMenu.addSeparator();
+
+            for (size_t slot = 0; slot < configs.size(); ++slot)
+            {
+                const auto bit = 1u << slot;
+                if ((group.mask & bit) == 0)
+                    continue;
+
+                groupMenu.addItem(configs[slot].name, true, (mask & bit) != 0, [onChange, mask, bit]
+                    {
+                        onChange(mask ^ bit);
+                    });
+            }
+
+            menu.addSubMenu(group.name, groupMenu, true, nullptr, (mask & group.mask) != 0);
+        }
+
+        return menu;
+    }
+}
@@ -0,0 +1,46 @@
+/*
+  ==============================================================================
+
+    RecallMask.h
+    Created: 21 Oct 2026 8:12:40pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+Partial preset recall. A mask has one bit per ccConfigurations slot, set for
+the parameters a preset load may change; everything else keeps its value and
+so sends no CC.
+
+Masks can be set globally (PresetManager), per note trigger and per setlist
+entry. A load uses its own mask ANDed with the global one, so the global mask
+works as a guard (e.g. never touch Bypass or Calibration) and the others
+narrow it further. Macros, LFOs and the other preset sections are only
+restored by a load that reaches every slot, and only such a load changes
+the current preset.
+*/
+
+namespace RecallMask
+{
+    static constexpr juce::uint32 everything = 0xffffffff;
+
+    struct Group
+    {
+        juce::String name;
+        juce::uint32 mask = 0;
+    };
+
+    // The four columns of the pedal, then the switches a partial recall usually leaves alone
+    const std::vector<Group>& getGroups();
+
+    bool coversAllSlots(juce::uint32 mask);
+    bool coversNoSlots(juce::uint32 mask);
+    juce::String describe(juce::uint32 mask);
+
+    // Group toggles plus a submenu of single parameters per group. onChange gets the new mask
+    juce::PopupMenu createMenu(juce::uint32 mask, std::function<void(juce::uint32)> onChange);
+}
@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.h
+    Created: 19 Oct 2026 9:20:48pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+Maps 0-1 to 0-1 with an output range, an optional flip, and either a power
+curve or a list of custom points. Never evaluated on the audio thread:
+compile() bakes it into a lookup table that is.
+*/
+
+struct ResponseCurve
+{
+    float minimum = 0.0f;  // Output range, as a fraction of the target's range
+    float maximum = 1.0f;
+    bool inverted = false;
+    float exponent = 1.0f; // 1 is linear, above 1 starts slow, below 1 starts fast
+    juce::Array<juce::Point<float>> points; // Custom shape, sorted by x. Overrides the exponent when set
+
+    bool isIdentity() const
+    {
+        return minimum == 0.0f && maximum == 1.0f && !inverted && exponent == 1.0f && points.isEmpty();
+    }
+
+    float apply(float x) const
+    {
+        x = juce::jlimit(0.0f, 1.0f, x);
+
+        if (inverted)
+            x = 1.0f - x;
+
+        float y = x;
+
+        if (!points.isEmpty())
+        {
+            // Piecewise linear between the points, flat beyond the ends
+            y = points.getFirst().y;
+            for (int i = 1; i < points.size(); ++i)
+            {
+                auto a = points.getReference(i - 1);
+                auto b = points.getReference(i);
+
+                if (x <= b.x)
+                {
+                    y = b.x > a.x ? juce::jmap(x, a.x, b.x, a.y, b.y) : b.y;
+                    break;
+                }
+
+                y = b.y;
+            }
+        }
+        else if (exponent != 1.0f)
+        {
+            y = std::pow(x, exponent);
+        }
+
+        return minimum + (maximum - minimum) * juce::jlimit(0.0f, 1.0f, y);
+    }
+
+    // lut[i] = apply(i / inputMax) scaled to 0-outputMax. Inputs past inputMax hold the last value
+    void compile(juce::uint8* lut, int numEntries, int inputMax, int outputMax) const
+    {
+        for (int i = 0; i < numEntries; ++i)
+        {
+            const float x = inputMax > 0 ? (float)juce::jmin(i, inputMax) / (float)inputMax : 0.0f;
+            lut[i] = (juce::uint8)juce::jlimit(0, outputMax, juce::roundToInt(apply(x) * (float)outputMax));
+        }
+    }
+
+    //=========================
+    // Presets store curves as properties, the plugin state as bytes
+    void writeToValueTree(juce::ValueTree& tree) const
+    {
+        tree.setProperty("min", minimum, nullptr);
+        tree.setProperty("max", maximum, nullptr);
+        tree.setProperty("invert", inverted, nullptr);
+        tree.setProperty("exponent", exponent, nullptr);
+
+        juce::StringArray pointText;
+        for (auto& p : points)
+            pointText.add(juce::String(p.x, 4) + "," + juce::String(p.y, 4));
+
+        if (!pointText.isEmpty())
+            tree.setProperty("points", pointText.joinIntoString(";"), nullptr);
+    }
+
+    static ResponseCurve fromValueTree(const juce::ValueTree& tree)
+    {
+        ResponseCurve curve;
+        curve.minimum = tree.getProperty("min", 0.0f);
+        curve.maximum = tree.getProperty("max", 1.0f);
+        curve.inverted = tree.getProperty("invert", false);
+        curve.exponent = tree.getProperty("exponent", 1.0f);
+
+        for (auto& pointText : juce::StringArray::fromTokens(tree.getProperty("points").toString(), ";", ""))
+        {
+            auto xy = juce::StringArray::fromTokens(pointText, ",", "");
+            if (xy.size() == 2)
+                curve.points.add({ xy[0].getFloatValue(), xy[1].getFloatValue() });
+        }
+
+        return curve;
+    }
+
+    void write(juce::OutputStream& out) const
+    {
+        out.writeFloat(minimum);
+        out.writeFloat(maximum);
+        out.writeBool(inverted);
+        out.writeFloat(exponent);
+        out.writeCompressedInt(points.size());
+
+        for (auto& p : points)
+        {
+            out.writeFloat(p.x);
+            out.writeFloat(p.y);
+        }
+    }
+
+    static ResponseCurve read(juce::InputStream& in)
+    {
+        ResponseCurve curve;
+        curve.minimum = in.readFloat();
+        curve.maximum = in.readFloat();
+        curve.inverted = in.readBool();
+        curve.exponent = in.readFloat();
+
+        const int numPoints = juce::jlimit(0, 128, in.readCompressedInt());
+        for (int i = 0; i < numPoints && !in.isExhausted(); ++i)
+        {
+            auto x = in.readFloat();
+            auto y = in.readFloat();
+            curve.points.add({ x, y });
+        }
+
+        return curve;
+    }
+};
@@ -0,0 +1,400 @@
+/*
+  ==============================================================================
+
+    SetlistPlayer.cpp
+    Created: 21 Oct 2026 5:26:51pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "SetlistPlayer.h"
+
+SetlistPlayer::SetlistPlayer(PresetManager& pm) : presetManager(pm),
+    pendingTable(std::make_unique<Table>()),
+    activeTable(std::make_unique<Table>())
+{
+    presetManager.addListener(this);
+}
+
+SetlistPlayer::~SetlistPlayer()
+{
+    presetManager.removeListener(this);
+}
+
+//==============================================================================
+juce::String SetlistPlayer::getName() const
+{
+    const juce::ScopedLock sl(entryLock);
+    return name;
+}
+
+std::vector<SetlistPlayer::Entry> SetlistPlayer::getEntries() const
+{
+    const juce::ScopedLock sl(entryLock);
+    return entries;
+}
+
+juce::StringArray SetlistPlayer::getEntryNames() const
+{
+    juce::StringArray names;
+
+    for (const auto& entry : getEntries())
+    {
+        auto preset = presetManager.findPresetForProgram(entry.program);
+        names.add(preset ? preset->name : "(Missing " + juce::String(entry.program / 128) + ":" + juce::String(entry.program % 128) + ")");
+    }
+
+    return names;
+}
+
+void SetlistPlayer::setEntries(const juce::String& newName, const std::vector<Entry>& newEntries)
+{
+    {
+        const juce::ScopedLock sl(entryLock);
+        name = newName;
+        entries.assign(newEntries.begin(), newEntries.begin() + juce::jmin((int)newEntries.size(), maxEntries));
+    }
+
+    position.store(-1);
+    rebuildTable();
+}
+
+void SetlistPlayer::addEntry(int program, juce::uint32 recallMask)
+{
+    {
+        const juce::ScopedLock sl(entryLock);
+        if ((int)entries.size() >= maxEntries)
+            return;
+
+        entries.push_back({ program, recallMask });
+    }
+
+    rebuildTable();
+}
+
+void SetlistPlayer::setEntryRecallMask(int index, juce::uint32 recallMask)
+{
+    {
+        const juce::ScopedLock sl(entryLock);
+        if (!juce::isPositiveAndBelow(index, (int)entries.size()))
+            return;
+
+        entries[(size_t)index].recallMask = recallMask;
+    }
+
+    rebuildTable();
+}
+
+void SetlistPlayer::removeLastEntry()
+{
+    {
+        const juce::ScopedLock sl(entryLock);
+        if (entries.empty())
+            return;
+
+        entries.pop_back();
+    }
+
+    rebuildTable();
+}
+
+//==============================================================================
+juce::File SetlistPlayer::getSetlistDirectory() const
+{
+    return presetManager.getPresetDirectory().getChildFile("Setlists");
+}
+
+juce::Array<juce::File> SetlistPlayer::findSetlistFiles() const
+{
+    juce::Array<juce::File> files;
+    getSetlistDirectory().findChildFiles(files, juce::File::findFiles, false, juce::String("*") + SETLIST_EXTENSION);
+    files.sort();
+    return files;
+}
+
+bool SetlistPlayer::saveToFile(const juce::File& file)
+{
+    juce::ValueTree setlist("Setlist");
+    setlist.setProperty("name", file.getFileNameWithoutExtension(), nullptr);
+
+    // Names are only for reading the file by hand, entries load by program number
+    const auto names = getEntryNames();
+    const auto setlistEntries = getEntries();
+
+    for (size_t i = 0; i < setlistEntries.size(); ++i)
+    {
+        juce::ValueTree entry("Entry");
+        entry.setProperty("program", setlistEntries[i].program, nullptr);
+        entry.setProperty("name", names[(int)i], nullptr);
+
+        if (setlistEntries[i].recallMask != RecallMask::everything)
+            entry.setProperty("recall", juce::String::toHexString((int)setlistEntries[i].recallMask), nullptr);
+
+        setlist.appendChild(entry, nullptr);
+    }
+
+    file.getParentDirectory().createDirectory();
+
+    auto xml = setlist.createXml();
+    if (xml == nullptr || !xml->writeTo(file))
+        return false;
+
+    const juce::ScopedLock sl(entryLock);
+    name = file.getFileNameWithoutExtension();
+    return true;
+}
+
+bool SetlistPlayer::loadFromFile(const juce::File& file)
+{
+    auto xml = juce::XmlDocument::parse(file);
+    if (xml == nullptr)
+        return false;
+
+    auto setlist = juce::ValueTree::fromXml(*xml);
+    if (!setlist.hasType("Setlist"))
+        return false;
+
+    std::vector<Entry> setlistEntries;
+    for (int i = 0; i < setlist.getNumChildren(); ++i)
+    {
+        auto child = setlist.getChild(i);
+        const int program = child.getProperty("program", -1);
+        if (!juce::isPositiveAndBelow(program, PresetCatalog::maxPrograms))
+            continue;
+
+        Entry entry{ program };
+        if (child.hasProperty("recall"))
+            entry.recallMask = (juce::uint32)child.getProperty("recall").toString().getHexValue32();
+
+        setlistEntries.push_back(entry);
+    }
+
+    setEntries(setlist.getProperty("name", file.getFileNameWithoutExtension()).toString(), setlistEntries);
+    return true;
+}
+
+//==============================================================================
+void SetlistPlayer::setActive(bool shouldBeActive)
+{
+    active.store(shouldBeActive);
+    position.store(-1);
+    rebuildTable();
+}
+
+void SetlistPlayer::presetListChanged()
+{
+    // Entries point at program numbers, pick up edited or renamed presets
+    if (isActive())
+        rebuildTable();
+}
+
+void SetlistPlayer::rebuildTable()
+{
+    auto table = std::make_unique<Table>();
+
+    // Only an active setlist holds copies of its presets
+    if (isActive())
+    {
+        for (const auto& entry : getEntries())
+        {
+            auto preset = presetManager.findPresetForProgram(entry.program);
+            table->cues.push_back({ preset ? *preset : PresetManager::Preset(), entry.recallMask });
+        }
+    }
+
+    {
+        const juce::SpinLock::ScopedLockType lock(tableLock);
+        std::swap(pendingTable, table);
+        tableChanged.store(true);
+    }
+}
+
+//==============================================================================
+void SetlistPlayer::setControl(bool forNext, const Control& control) noexcept
+{
+    (forNext ? nextControl : previousControl).store(pack(control));
+}
+
+SetlistPlayer::Control SetlistPlayer::getControl(bool forNext) const noexcept
+{
+    return unpack((forNext ? nextControl : previousControl).load());
+}
+
+juce::String SetlistPlayer::describe(const Control& control)
+{
+    switch (control.type)
+    {
+        case noteControl:          return "Note " + juce::String(control.number) + ", Ch " + juce::String(control.channel);
+        case ccControl:            return "CC " + juce::String(control.number) + ", Ch " + juce::String(control.channel);
+        case programChangeControl: return "Program Change, Ch " + juce::String(control.channel);
+        default:                   return "None";
+    }
+}
+
+//==============================================================================
+void SetlistPlayer::writeBinaryState(juce::OutputStream& out) const
+{
+    out.writeBool(isActive());
+    out.writeString(getName());
+
+    const auto setlistEntries = getEntries();
+    out.writeCompressedInt((int)setlistEntries.size());
+    for (const auto& entry : setlistEntries)
+        out.writeCompressedInt(entry.program);
+
+    out.writeCompressedInt(position.load() + 1);
+    out.writeInt(nextControl.load());
+    out.writeInt(previousControl.load());
+
+    for (const auto& entry : setlistEntries)
+        out.writeInt((int)entry.recallMask);
+}
+
+void SetlistPlayer::readBinaryState(juce::InputStream& in)
+{
+    const bool wasActive = in.readBool();
+    const auto setlistName = in.readString();
+
+    std::vector<Entry> setlistEntries((size_t)juce::jlimit(0, maxEntries, in.readCompressedInt()));
+    for (auto& entry : setlistEntries)
+        entry.program = in.readCompressedInt();
+
+    const int savedPosition = in.readCompressedInt() - 1;
+    nextControl.store(in.readInt());
+    previousControl.store(in.readInt());
+
+    // Older states have no recall masks
+    for (auto& entry : setlistEntries)
+    {
+        if (in.isExhausted())
+            break;
+
+        entry.recallMask = (juce::uint32)in.readInt();
+    }
+
+    active.store(wasActive);
+    setEntries(setlistName, setlistEntries);
+    position.store(juce::jlimit(-1, (int)setlistEntries.size() - 1, savedPosition));
+}
+
+//==============================================================================
+bool SetlistPlayer::learnControl(const juce::MidiMessage& message) noexcept
+{
+    const int learning = learningControl.load();
+    if (learning == 0)
+        return false;
+
+    Control control;
+    control.channel = message.getChannel();
+
+    if (message.isNoteOn())
+    {
+        control.type = noteControl;
+        control.number = message.getNoteNumber();
+    }
+    else if (message.isController() && message.getControllerValue() >= 64)
+    {
+        control.type = ccControl;
+        control.number = message.getControllerNumber();
+    }
+    else if (message.isProgramChange())
+    {
+        control.type = programChangeControl;
+    }
+    else
+    {
+        return false;
+    }
+
+    setControl(learning == 1, control);
+    learningControl.store(0);
+    return true;
+}
+
+int SetlistPlayer::matchControl(const juce::MidiMessage& message) noexcept
+{
+    for (int i = 0; i < 2; ++i)
+    {
+        const auto control = unpack((i == 0 ? nextControl : previousControl).load());
+        if (control.type == noControl || message.getChannel() != control.channel)
+            continue;
+
+        bool matches = false;
+
+        if (control.type == noteControl)
+        {
+            matches = message.isNoteOn() && message.getNoteNumber() == control.number;
+        }
+        else if (control.type == ccControl && message.isController() && message.getControllerNumber() == control.number)
+        {
+            // Footswitches send 127 then 0, only the press steps
+            const int value = message.getControllerValue();
+            matches = value >= 64 && lastControlValues[(size_t)i] < 64;
+            lastControlValues[(size_t)i] = value;
+        }
+        else if (control.type == programChangeControl)
+        {
+            matches = message.isProgramChange();
+        }
+
+        if (matches)
+            return i == 0 ? 1 : -1;
+    }
+
+    return 0;
+}
+
+bool SetlistPlayer::takeRequest(int& target, int& value) noexcept
+{
+    const int jump = requestedJump.exchange(-1);
+    if (jump >= 0)
+    {
+        requestedStep.store(0);
+        target = 1;
+        value = jump;
+        return true;
+    }
+
+    const int delta = requestedStep.exchange(0);
+    if (delta == 0)
+        return false;
+
+    target = 0;
+    value = delta;
+    return true;
+}
+
+void SetlistPlayer::updateActiveTable() noexcept
+{
+    if (!tableChanged.load())
+        return;
+
+    const juce::SpinLock::ScopedTryLockType lock(tableLock);
+    if (lock.isLocked())
+    {
+        std::swap(activeTable, pendingTable);
+        tableChanged.store(false);
+    }
+}
+
+const SetlistPlayer::Cue* SetlistPlayer::step(int delta) noexcept
+{
+    updateActiveTable();
+    return jumpTo(position.load() + delta);
+}
+
+const SetlistPlayer::Cue* SetlistPlayer::jumpTo(int index) noexcept
+{
+    updateActiveTable();
+
+    // Stops at either end rather than wrapping, a show doesn't start over by accident
+    const int numEntries = (int)activeTable->cues.size();
+    if (!isActive() || !juce::isPositiveAndBelow(index, numEntries))
+        return nullptr;
+
+    position.store(index);
+
+    const auto& cue = activeTable->cues[(size_t)index];
+    return cue.preset.hasSnapshot ? &cue : nullptr;
+}
@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+    SetlistPlayer.h
+    Created: 21 Oct 2026 5:26:51pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PresetManager.h"
+
+/*
+Setlists: an ordered list of presets, repeats allowed, stepped through with
+one footswitch during a show. Entries are stored as catalog program numbers
+and saved as .ccsetlist files in the Setlists folder next to the presets.
+
+While a setlist is active, every entry's decoded preset is copied into a
+table that is swapped to the audio thread like the macro tables. Stepping
+is then an index change on that table, with no catalog lookup, lock or file
+read. The table is rebuilt whenever the library changes.
+
+Next and previous can each be learned to a note, a CC (on its rising edge
+past 64) or any Program Change. Each entry can have its own recall mask.
+*/
+
+class SetlistPlayer : private PresetManager::Listener
+{
+public:
+    enum ControlType
+    {
+        noControl = 0,
+        noteControl,
+        ccControl,
+        programChangeControl
+    };
+
+    struct Control
+    {
+        int type = noControl;
+        int number = 0;  // Note or CC number
+        int channel = 0; // 1-16
+    };
+
+    struct Entry
+    {
+        int program = -1;
+        juce::uint32 recallMask = RecallMask::everything;
+    };
+
+    // An entry as the audio thread sees it, with its preset copied in
+    struct Cue
+    {
+        PresetManager::Preset preset;
+        juce::uint32 recallMask = RecallMask::everything;
+    };
+
+    static constexpr const char* SETLIST_EXTENSION = ".ccsetlist";
+    static constexpr int maxEntries = 512;
+
+    explicit SetlistPlayer(PresetManager& presetManager);
+    ~SetlistPlayer() override;
+
+    //=========================
+    // Message thread
+    juce::String getName() const;
+    std::vector<Entry> getEntries() const;
+    juce::StringArray getEntryNames() const;
+    void setEntries(const juce::String& name, const std::vector<Entry>& newEntries);
+    void addEntry(int program, juce::uint32 recallMask = RecallMask::everything);
+    void setEntryRecallMask(int index, juce::uint32 recallMask);
+    void removeLastEntry();
+
+    juce::File getSetlistDirectory() const;
+    juce::Array<juce::File> findSetlistFiles() const;
+    bool saveToFile(const juce::File& file);
+    bool loadFromFile(const juce::File& file);
+
+    void setActive(bool shouldBeActive);
+    bool isActive() const noexcept { return active.load(); }
+    int getPosition() const noexcept { return position.load(); } // -1 before the first entry
+
+    // Stepping from the editor, picked up by the processor at the next block
+    void requestStep(int delta) noexcept { requestedStep.fetch_add(delta); }
+    void requestJump(int index) noexcept { requestedJump.store(index); }
+
+    void setControl(bool forNext, const Control& control) noexcept;
+    Control getControl(bool forNext) const noexcept;
+    void startLearningControl(bool forNext) noexcept { learningControl.store(forNext ? 1 : 2); }
+    bool isLearningControl() const noexcept { return learningControl.load() != 0; }
+    static juce::String describe(const Control& control);
+
+    void writeBinaryState(juce::OutputStream& out) const;
+    void readBinaryState(juce::InputStream& in);
+
+    //=========================
+    // Audio thread
+    // Takes the message as the learned control if learning. Returns true if it did
+    bool learnControl(const juce::MidiMessage& message) noexcept;
+
+    // +1 for the next control, -1 for previous, 0 for anything else
+    int matchControl(const juce::MidiMessage& message) noexcept;
+
+    // Editor requests since the last call, as a step (target 0) or jump (target 1) action value
+    bool takeRequest(int& target, int& value) noexcept;
+
+    // Moves through the preloaded list. Returns the entry to load, or nullptr at either end
+    const Cue* step(int delta) noexcept;
+    const Cue* jumpTo(int index) noexcept;
+
+private:
+    struct Table
+    {
+        std::vector<Cue> cues;
+    };
+
+    void presetListChanged() override;
+    void rebuildTable();
+    void updateActiveTable() noexcept;
+
+    static int pack(const Control& control) noexcept { return (control.type << 16) | (control.channel << 8) | control.number; }
+    static Control unpack(int packed) noexcept { return { packed >> 16, packed & 0x7f, (packed >> 8) & 0x1f }; }
+
+    PresetManager& presetManager;
+
+    mutable juce::CriticalSection entryLock;
+    juce::String name;
+    std::vector<Entry> entries;
+
+    juce::SpinLock tableLock;
+    std::unique_ptr<Table> pendingTable;
+    std::atomic<bool> tableChanged{ false };
+    std::unique_ptr<Table> activeTable; // Audio thread only
+
+    std::atomic<bool> active{ false };
+    std::atomic<int> position{ -1 };
+    std::atomic<int> requestedStep{ 0 };
+    std::atomic<int> requestedJump{ -1 };
+
+    std::atomic<int> nextControl{ 0 };
+    std::atomic<int> previousControl{ 0 };
+    std::atomic<int> learningControl{ 0 }; // 1 next, 2 previous
+    std::array<int, 2> lastControlValues{}; // CC values for the rising edge, audio thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SetlistPlayer)
+};
@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    StateChunks.h
+    Created: 19 Oct 2026 4:05:52pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+Compact binary plugin state.
+
+    magic (4 bytes) | version (2 bytes) | chunk | chunk | ...
+
+Each chunk is a 4 character tag, a 32-bit payload size and the payload.
+Readers skip chunks they don't know, so new sections can be added without
+breaking older projects. Anything that doesn't start with the magic is
+treated as the old XML state.
+*/
+
+namespace StateChunks
+{
+    static constexpr juce::uint32 makeTag(char a, char b, char c, char d)
+    {
+        return (juce::uint32)(juce::uint8)a | ((juce::uint32)(juce::uint8)b << 8)
+            | ((juce::uint32)(juce::uint8)c << 16) | ((juce::uint32)(juce::uint8)d << 24);
+    }
+
+    static constexpr juce::uint32 magic = makeTag('C', 'C', 'S', 'T');
+    static constexpr int version = 1;
+
+    static constexpr juce::uint32 parametersTag = makeTag('P', 'A', 'R', 'M');
+    static constexpr juce::uint32 parameterValuesTag = makeTag('P', 'V', 'A', 'L');
+    static constexpr juce::uint32 presetManagerTag = makeTag('P', 'M', 'G', 'R');
+    static constexpr juce::uint32 editorTag = makeTag('U', 'I', 'F', 'L');
+    static constexpr juce::uint32 morphTag = makeTag('M', 'R', 'P', 'H');
+    static constexpr juce::uint32 glideTag = makeTag('G', 'L', 'I', 'D');
+    static constexpr juce::uint32 macroTag = makeTag('M', 'A', 'C', 'R');
+    static constexpr juce::uint32 curvesTag = makeTag('C', 'U', 'R', 'V');
+    static constexpr juce::uint32 lfoTag = makeTag('L', 'F', 'O', 'S');
+    static constexpr juce::uint32 sequencerTag = makeTag('S', 'E', 'Q', 'L');
+    static constexpr juce::uint32 envelopeTag = makeTag('E', 'N', 'V', 'F');
+    static constexpr juce::uint32 gestureTag = makeTag('G', 'E', 'S', 'T');
+    static constexpr juce::uint32 thruTag = makeTag('T', 'H', 'R', 'U');
+    static constexpr juce::uint32 learnTag = makeTag('L', 'E', 'R', 'N');
+    static constexpr juce::uint32 setlistTag = makeTag('S', 'E', 'T', 'L');
+    static constexpr juce::uint32 latencyTag = makeTag('L', 'A', 'T', 'C');
+
+    static inline void writeHeader(juce::OutputStream& out)
+    {
+        out.writeInt((int)magic);
+        out.writeShort((short)version);
+    }
+
+    static inline bool hasHeader(const void* data, int sizeInBytes)
+    {
+        return sizeInBytes >= 6
+            && juce::ByteOrder::littleEndianInt(data) == magic;
+    }
+
+    // Writes tag + size placeholder, runs the writer, then patches the size in
+    template <typename WriterFunction>
+    static inline void writeChunk(juce::MemoryOutputStream& out, juce::uint32 tag, WriterFunction&& writer)
+    {
+        out.writeInt((int)tag);
+        auto sizePosition = out.getPosition();
+        out.writeInt(0);
+
+        writer(out);
+
+        auto endPosition = out.getPosition();
+        out.setPosition(sizePosition);
+        out.writeInt((int)(endPosition - sizePosition - 4));
+        out.setPosition(endPosition);
+    }
+
+    // Calls reader(tag, chunkStream) for every chunk. Returns false for a bad header
+    template <typename ReaderFunction>
+    static inline bool readChunks(const void* data, int sizeInBytes, ReaderFunction&& reader)
+    {
+        if (!hasHeader(data, sizeInBytes))
+            return false;
+
+        juce::MemoryInputStream in(data, (size_t)sizeInBytes, false);
+        in.readInt();
+
+        if (in.readShort() > version)
+            return false; // Written by a newer version we can't read safely
+
+        while (in.getNumBytesRemaining() >= 8)
+        {
+            auto tag = (juce::uint32)in.readInt();
+            auto size = in.readInt();
+
+            if (size < 0 || size > in.getNumBytesRemaining())
+                break;
+
+            auto* chunkData = static_cast<const char*>(data) + in.getPosition();
+            juce::MemoryInputStream chunk(chunkData, (size_t)size, false);
+            reader(tag, chunk);
+
+            in.skipNextBytes(size);
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,325 @@
+/*
+  ==============================================================================
+
+    StepSequencer.cpp
+    Created: 20 Oct 2026 1:26:50pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#include "StepSequencer.h"
+
+StepSequencer::StepSequencer(const std::array<int, ParameterSnapshot::maxSlots>& maximums) : slotMaximums(maximums)
+{
+}
+
+StepSequencer::Lane StepSequencer::getLane(int index) const
+{
+    if (!juce::isPositiveAndBelow(index, numLanes))
+        return {};
+
+    const juce::ScopedLock sl(laneLock);
+    return lanes[(size_t)index];
+}
+
+void StepSequencer::setLane(int index, const Lane& newLane)
+{
+    if (!juce::isPositiveAndBelow(index, numLanes))
+        return;
+
+    {
+        const juce::ScopedLock sl(laneLock);
+        auto& lane = lanes[(size_t)index];
+        lane = newLane;
+        lane.numSteps = juce::jlimit(1, maxSteps, lane.numSteps);
+        lane.stepBeats = juce::jmax(1.0f / 64.0f, lane.stepBeats);
+        lane.enabled = lane.enabled && juce::isPositiveAndBelow(lane.slot, ParameterSnapshot::maxSlots);
+    }
+
+    publish();
+}
+
+int StepSequencer::findLaneForSlot(int slot) const
+{
+    const juce::ScopedLock sl(laneLock);
+
+    for (int i = 0; i < numLanes; ++i)
+    {
+        if (lanes[(size_t)i].enabled && lanes[(size_t)i].slot == slot)
+            return i;
+    }
+
+    return -1;
+}
+
+int StepSequencer::setLaneForSlot(int slot, const Lane& newLane)
+{
+    int index = findLaneForSlot(slot);
+
+    if (index < 0)
+    {
+        const juce::ScopedLock sl(laneLock);
+
+        for (int i = 0; i < numLanes && index < 0; ++i)
+        {
+            if (!lanes[(size_t)i].enabled)
+                index = i;
+        }
+    }
+
+    if (index >= 0)
+    {
+        auto lane = newLane;
+        lane.slot = slot;
+        lane.enabled = true;
+        setLane(index, lane);
+    }
+
+    return index;
+}
+
+void StepSequencer::clearSlot(int slot)
+{
+    {
+        const juce::ScopedLock sl(laneLock);
+
+        for (auto& lane : lanes)
+        {
+            if (lane.slot == slot)
+                lane = {};
+        }
+    }
+
+    publish();
+}
+
+StepSequencer::CompiledLane StepSequencer::compile(const Lane& lane)
+{
+    CompiledLane compiled;
+    compiled.lane = lane;
+
+    // Each skipped step points back at the last step that isn't skipped, wrapping around
+    for (int step = 0; step < lane.numSteps; ++step)
+    {
+        compiled.source[(size_t)step] = -1;
+
+        for (int back = 0; back < lane.numSteps; ++back)
+        {
+            const int candidate = (step - back + lane.numSteps) % lane.numSteps;
+            if ((lane.flags[(size_t)candidate] & stepSkip) == 0)
+            {
+                compiled.source[(size_t)step] = (juce::int8)candidate;
+                break;
+            }
+        }
+    }
+
+    return compiled;
+}
+
+void StepSequencer::publish()
+{
+    std::array<CompiledLane, numLanes> compiled;
+    {
+        const juce::ScopedLock sl(laneLock);
+        for (size_t i = 0; i < lanes.size(); ++i)
+            compiled[i] = compile(lanes[i]);
+    }
+
+    const juce::SpinLock::ScopedLockType lock(pendingLock);
+    pendingLanes = compiled;
+    lanesChanged.store(true);
+}
+
+void StepSequencer::update() noexcept
+{
+    if (!lanesChanged.load())
+        return;
+
+    const juce::SpinLock::ScopedTryLockType lock(pendingLock);
+    if (!lock.isLocked())
+        return;
+
+    activeLanes = pendingLanes;
+    lanesChanged.store(false);
+
+    activeCount = 0;
+    hasGlideSteps = false;
+
+    for (auto& compiled : activeLanes)
+    {
+        if (!compiled.lane.enabled)
+            continue;
+
+        ++activeCount;
+        for (int step = 0; step < compiled.lane.numSteps; ++step)
+            hasGlideSteps = hasGlideSteps || (compiled.lane.flags[(size_t)step] & stepGlide) != 0;
+    }
+}
+
+int StepSequencer::addStepBoundaries(const TransportInfo& transport, int* splitPoints, int numSplits, int maxSplits) const noexcept
+{
+    if (!transport.isPlaying)
+        return numSplits;
+
+    for (auto& compiled : activeLanes)
+    {
+        if (!compiled.lane.enabled)
+            continue;
+
+        const double stepBeats = compiled.lane.stepBeats;
+        double boundary = std::ceil(transport.ppq / stepBeats) * stepBeats;
+
+        for (int sample = transport.getSampleForPpq(boundary); sample >= 0 && numSplits < maxSplits;
+             boundary += stepBeats, sample = transport.getSampleForPpq(boundary))
+        {
+            splitPoints[numSplits++] = sample;
+        }
+    }
+
+    return numSplits;
+}
+
+void StepSequencer::process(const TransportInfo& transport, double ppq, float* values) const noexcept
+{
+    if (!transport.isPlaying)
+        return;
+
+    for (auto& compiled : activeLanes)
+    {
+        const auto& lane = compiled.lane;
+        if (!lane.enabled)
+            continue;
+
+        // Small offset so a boundary computed from a sample position lands on the new step
+        const double position = ppq / lane.stepBeats + 1.0e-6;
+        const double stepStart = std::floor(position);
+        const int step = (int)(((juce::int64)stepStart % lane.numSteps + lane.numSteps) % lane.numSteps);
+
+        const int source = compiled.source[(size_t)step];
+        if (source < 0)
+            continue;
+
+        float value = (float)lane.values[(size_t)source];
+
+        if (lane.flags[(size_t)step] & stepGlide)
+        {
+            const int next = compiled.source[(size_t)((step + 1) % lane.numSteps)];
+            if (next >= 0)
+                value += ((float)lane.values[(size_t)next] - value) * (float)(position - stepStart);
+        }
+
+        values[lane.slot] = juce::jlimit(0.0f, (float)slotMaximums[(size_t)lane.slot], value);
+    }
+}
+
+//==============================================================================
+juce::ValueTree StepSequencer::toValueTree() const
+{
+    juce::ValueTree tree("Sequencer");
+    const juce::ScopedLock sl(laneLock);
+
+    for (int i = 0; i < numLanes; ++i)
+    {
+        const auto& lane = lanes[(size_t)i];
+        if (!lane.enabled)
+            continue;
+
+        // Step values and flags as base64 bytes, a 64 step lane is under 200 characters
+        juce::ValueTree child("Lane");
+        child.setProperty("index", i, nullptr);
+        child.setProperty("slot", lane.slot, nullptr);
+        child.setProperty("stepBeats", lane.stepBeats, nullptr);
+        child.setProperty("values", juce::MemoryBlock(lane.values.data(), (size_t)lane.numSteps).toBase64Encoding(), nullptr);
+        child.setProperty("flags", juce::MemoryBlock(lane.flags.data(), (size_t)lane.numSteps).toBase64Encoding(), nullptr);
+        tree.appendChild(child, nullptr);
+    }
+
+    return tree;
+}
+
+void StepSequencer::setLanes(const Lanes& newLanes)
+{
+    {
+        const juce::ScopedLock sl(laneLock);
+        lanes = newLanes;
+    }
+
+    publish();
+}
+
+void StepSequencer::fromValueTree(const juce::ValueTree& tree)
+{
+    setLanes(readLanes(tree));
+}
+
+StepSequencer::Lanes StepSequencer::readLanes(const juce::ValueTree& tree)
+{
+    Lanes newLanes;
+
+    for (const auto& child : tree)
+    {
+        const int index = child.getProperty("index", -1);
+        if (!juce::isPositiveAndBelow(index, numLanes))
+            continue;
+
+        auto& lane = newLanes[(size_t)index];
+        lane.slot = child.getProperty("slot", -1);
+        lane.enabled = juce::isPositiveAndBelow(lane.slot, ParameterSnapshot::maxSlots);
+        lane.stepBeats = juce::jmax(1.0f / 64.0f, (float)child.getProperty("stepBeats", 0.25f));
+
+        juce::MemoryBlock values, flags;
+        values.fromBase64Encoding(child.getProperty("values").toString());
+        flags.fromBase64Encoding(child.getProperty("flags").toString());
+
+        lane.numSteps = juce::jlimit(1, maxSteps, (int)values.getSize());
+        std::memcpy(lane.values.data(), values.getData(), juce::jmin(values.getSize(), (size_t)maxSteps));
+        std::memcpy(lane.flags.data(), flags.getData(), juce::jmin(flags.getSize(), (size_t)maxSteps));
+    }
+
+    return newLanes;
+}
+
+void StepSequencer::writeBinaryState(juce::OutputStream& out) const
+{
+    const juce::ScopedLock sl(laneLock);
+
+    for (const auto& lane : lanes)
+    {
+        out.writeBool(lane.enabled);
+        if (!lane.enabled)
+            continue;
+
+        out.writeByte((char)lane.slot);
+        out.writeByte((char)lane.numSteps);
+        out.writeFloat(lane.stepBeats);
+        out.write(lane.values.data(), (size_t)lane.numSteps);
+        out.write(lane.flags.data(), (size_t)lane.numSteps);
+    }
+}
+
+void StepSequencer::readBinaryState(juce::InputStream& in)
+{
+    std::array<Lane, numLanes> newLanes;
+
+    for (auto& lane : newLanes)
+    {
+        if (in.isExhausted() || !in.readBool())
+            continue;
+
+        lane.slot = in.readByte();
+        lane.numSteps = juce::jlimit(1, maxSteps, (int)(juce::uint8)in.readByte());
+        lane.stepBeats = juce::jmax(1.0f / 64.0f, in.readFloat());
+        in.read(lane.values.data(), lane.numSteps);
+        in.read(lane.flags.data(), lane.numSteps);
+        lane.enabled = juce::isPositiveAndBelow(lane.slot, ParameterSnapshot::maxSlots);
+    }
+
+    {
+        const juce::ScopedLock sl(laneLock);
+        lanes = newLanes;
+    }
+
+    publish();
+}
@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    StepSequencer.h
+    Created: 20 Oct 2026 1:26:50pm
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterSnapshot.h"
+#include "TransportInfo.h"
+
+/*
+Step sequencer lanes, each driving one CC slot while the host is playing.
+
+The current step is worked out from the host's PPQ position every time, so
+loops, locates and tempo changes need no special handling. The processor
+splits its block at every step boundary, which puts each new value on the
+exact sample the step starts.
+
+Steps can be skipped (the previous value holds) or glide to the next step.
+All storage is fixed size; the audio thread never allocates.
+*/
+
+class StepSequencer
+{
+public:
+    static constexpr int numLanes = 8;
+    static constexpr int maxSteps = 64;
+
+    enum StepFlags
+    {
+        stepSkip = 1,  // Hold the previous step's value
+        stepGlide = 2  // Slide to the next step's value over the step
+    };
+
+    struct Lane
+    {
+        bool enabled = false;
+        int slot = -1;
+        int numSteps = 16;
+        float stepBeats = 0.25f; // Step length in quarter notes, 0.25 is a 16th
+        std::array<juce::uint8, maxSteps> values{}; // Raw slot values
+        std::array<juce::uint8, maxSteps> flags{};
+    };
+
+    // slotMaximums: top of each slot's raw range (127, or 5 for the module selects)
+    explicit StepSequencer(const std::array<int, ParameterSnapshot::maxSlots>& slotMaximums);
+
+    //=========================
+    // Message thread
+    Lane getLane(int index) const;
+    void setLane(int index, const Lane& lane);
+
+    int findLaneForSlot(int slot) const;
+    int setLaneForSlot(int slot, const Lane& lane); // Reuses or claims a lane, -1 if all are taken
+    void clearSlot(int slot);
+
+    // Every lane at once, e.g. from a preset
+    using Lanes = std::array<Lane, numLanes>;
+    void setLanes(const Lanes& newLanes);
+
+    juce::ValueTree toValueTree() const;
+    void fromValueTree(const juce::ValueTree& tree);
+    static Lanes readLanes(const juce::ValueTree& tree); // Decodes without applying, for presets
+    void writeBinaryState(juce::OutputStream& out) const;
+    void readBinaryState(juce::InputStream& in);
+
+    //=========================
+    // Audio thread
+    void update() noexcept; // Picks up edited lanes, call once per block
+    bool isActive() const noexcept { return activeCount > 0; }
+    bool needsControlRate() const noexcept { return hasGlideSteps; } // Glide steps move between boundaries
+
+    // Appends the sample offset of every step boundary in this block, returns the new count
+    int addStepBoundaries(const TransportInfo& transport, int* splitPoints, int numSplits, int maxSplits) const noexcept;
+
+    // Overwrites each lane's slot with its step value at ppq. Does nothing while stopped
+    void process(const TransportInfo& transport, double ppq, float* values) const noexcept;
+
+private:
+    // Lane plus what the audio thread needs precomputed
+    struct CompiledLane
+    {
+        Lane lane;
+        std::array<juce::int8, maxSteps> source{}; // Step whose value is used, following skips. -1 if every step skips
+    };
+
+    static CompiledLane compile(const Lane& lane);
+    void publish();
+
+    const std::array<int, ParameterSnapshot::maxSlots> slotMaximums;
+
+    mutable juce::CriticalSection laneLock;
+    std::array<Lane, numLanes> lanes;
+
+    juce::SpinLock pendingLock;
+    std::array<CompiledLane, numLanes> pendingLanes;
+    std::atomic<bool> lanesChanged{ false };
+
+    // Audio thread copy
+    std::array<CompiledLane, numLanes> activeLanes;
+    int activeCount = 0;
+    bool hasGlideSteps = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StepSequencer)
+};
@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    TransportInfo.h
+    Created: 20 Oct 2026 9:12:37am
+    Author:  tjbac
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+Host transport for one block, read once from the AudioPlayHead.
+Everything tempo synced works in quarter notes (PPQ) and uses
+getPpqAtSample() to find positions inside the block.
+
+When the host is stopped or doesn't report a position, the processor keeps a
+free running position instead, so synced modulation still moves.
+
+A lookahead moves a playing host position later by a fixed time, so whatever
+follows the transport fires that much early (see LatencyCompensation). While
+the host loops, a position pushed past the loop end wraps back to its start.
+*/
+
+struct TransportInfo
+{
+    double ppq = 0.0;            // Position at the first sample of the block
+    double bpm = 120.0;
+    double ppqPerSample = 0.0;
+    double sampleRate = 44100.0;
+    double barStartPpq = 0.0;    // Start of the bar containing ppq
+    double timeInSeconds = 0.0;  // Host timeline position of the first sample, when playing
+    int timeSigNumerator = 4;
+    int timeSigDenominator = 4;
+    int numSamples = 0;
+    bool isPlaying = false;
+    bool isLooping = false;
+    bool hostPosition = false;   // ppq came from the host, not the free running clock
+    bool jumped = false;         // Position isn't where the previous block left off (loop, locate, start)
+
+    double getPpqAtSample(int sample) const noexcept { return ppq + ppqPerSample * sample; }
+    double getEndPpq() const noexcept { return getPpqAtSample(numSamples); }
+    double getQuarterNotesPerBar() const noexcept { return timeSigNumerator * 4.0 / timeSigDenominator; }
+
+    // First sample in this block at or after targetPpq, or -1 if it isn't reached in this block
+    int getSampleForPpq(double targetPpq) const noexcept
+    {
+        if (ppqPerSample <= 0.0 || targetPpq < ppq - 1.0e-9)
+            return -1;
+
+        const auto sample = juce::jmax(0, (int)std::ceil((targetPpq - ppq) / ppqPerSample - 1.0e-6));
+        return sample < numSamples ? sample : -1;
+    }
+
+    // Reads the playhead. previous is last block's info, used for the free running
+    // clock and to spot jumps. lookaheadSeconds only applies while the host plays
+    static TransportInfo fromPlayHead(juce::AudioPlayHead* playHead, double sampleRate, int numSamples, const TransportInfo& previous,
+                                      double lookaheadSeconds = 0.0)
+    {
+        TransportInfo info;
+        info.sampleRate = sampleRate;
+        info.numSamples = numSamples;
+        info.bpm = previous.bpm;
+        info.timeSigNumerator = previous.timeSigNumerator;
+        info.timeSigDenominator = previous.timeSigDenominator;
+
+        std::optional<juce::AudioPlayHead::PositionInfo> position;
+        if (playHead != nullptr)
+            position = playHead->getPosition();
+
+        if (position)
+        {
+            if (auto bpm = position->getBpm(); bpm && *bpm > 0.0)
+                info.bpm = *bpm;
+
+            if (auto timeSig = position->getTimeSignature(); timeSig && timeSig->numerator > 0 && timeSig->denominator > 0)
+            {
+                info.timeSigNumerator = timeSig->numerator;
+                info.timeSigDenominator = timeSig->denominator;
+            }
+
+            info.isPlaying = position->getIsPlaying();
+            info.isLooping = position->getIsLooping();
+        }
+
+        info.ppqPerSample = info.bpm / (60.0 * sampleRate);
+
+        auto hostPpq = position ? position->getPpqPosition() : std::nullopt;
+
+        if (info.isPlaying && hostPpq)
+        {
+            info.ppq = *hostPpq + lookaheadSeconds * info.bpm / 60.0;
+            info.hostPosition = true;
+
+            if (auto seconds = position->getTimeInSeconds())
+                info.timeInSeconds = *seconds + lookaheadSeconds;
+
+            // The host will be back at the loop start by the time the lookahead is up
+            if (auto loop = position->getLoopPoints(); info.isLooping && loop && loop->ppqEnd > loop->ppqStart
+                && *hostPpq >= loop->ppqStart && *hostPpq < loop->ppqEnd && info.ppq >= loop->ppqEnd)
+            {
+                const double wrapped = loop->ppqStart + std::fmod(info.ppq - loop->ppqStart, loop->ppqEnd - loop->ppqStart);
+                info.timeInSeconds -= (info.ppq - wrapped) * 60.0 / info.bpm;
+                info.ppq = wrapped;
+            }
+
+            if (auto barStart = position->getPpqPositionOfLastBarStart())
+            {
+                // The lookahead can reach into a later bar, or back into an earlier one after a wrap
+                const double bars = std::floor((info.ppq - *barStart) / info.getQuarterNotesPerBar());
+                info.barStartPpq = *barStart + bars * info.getQuarterNotesPerBar();
+            }
+            else
+            {
+                info.barStartPpq = std::floor(info.ppq / info.getQuarterNotesPerBar()) * info.getQuarterNotesPerBar();
+            }
+
+            // More than a sample away from where we expected means a loop, locate or restart
+            info.jumped = !previous.isPlaying || std::abs(info.ppq - previous.getEndPpq()) > info.ppqPerSample * 2.0;
+        }
+        else
+        {
+            // Stopped: keep counting from wherever the last block ended
+            info.ppq = previous.getEndPpq();
+            info.barStartPpq = std::floor(info.ppq / info.getQuarterNotesPerBar()) * info.getQuarterNotesPerBar();
+            info.jumped = previous.isPlaying;
+        }
+
+        return info;
+    }
+};